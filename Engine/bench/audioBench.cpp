@@ -0,0 +1,697 @@
+// Headless benchmarks of the audio engine. Runs SoundManager on SDL's dummy (or disk)
+// audio driver with no window and prints one JSON document to stdout:
+//
+//   gameengine_bench [--driver dummy|disk] [--recording path] [--events N]
+//
+// Mixing throughput is measured on a Mixer directly, the same code the audio callback
+// runs, because the callback itself is paced by the device in real time. Scenarios that
+// check correctness too (spsc_stress) make the exit code 1 when they fail.
+#include <SDL3/SDL.h>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "../src/audio/audioStream.hpp"
+#include "../src/audio/config.hpp"
+#include "../src/audio/keySounds.hpp"
+#include "../src/audio/mixer.hpp"
+#include "../src/audio/mixWorkers.hpp"
+#include "../src/audio/recording.hpp"
+#include "../src/audio/soundManager.hpp"
+#include "../src/audio/spscQueue.hpp"
+#include "../src/audio/wavWriter.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+// Defined by main.cpp in the game
+int currentDelay = DEFAULT_DELAY_MS;
+
+#define BENCH_NOTE_ON_BURSTS 100          // UI note-ons are sent in bursts the callback can drain
+#define BENCH_NOTE_ON_BURST (COMMAND_QUEUE_CAPACITY / 2)
+#define BENCH_DRAIN_MS 50                 // Time the dummy device gets to drain a burst
+#define BENCH_MIXER_NOTE_ONS 1000000
+#define BENCH_POLYPHONY_FRAMES (MIX_BLOCK_FRAMES * 192) // ~1 s per voice count
+#define BENCH_SCALING_VOICES 2048       // Voices in the multi-core mixing scenarios
+#define BENCH_STORM_FRAMES (AUDIO_SAMPLE_RATE * 10)
+#define BENCH_PLAYBACK_MAX_MS 10000       // Real-time playback is cut off after this long
+#define BENCH_RECORDING_EVENTS 1000000    // Events in the generated save/load recording
+#define BENCH_SAMPLE_FILES 24             // Generated instrument: one stereo 44.1 kHz WAV per zone
+#define BENCH_SAMPLE_SECONDS 4
+#define BENCH_SAMPLE_KEYS 4               // Keys per zone
+#define BENCH_STREAM_SECONDS 20           // Generated stereo 44.1 kHz WAV streamed from disk
+#define BENCH_STREAM_BURST_FRAMES (AUDIO_SAMPLE_RATE / 10) // Mixed between pauses, well inside the read-ahead
+#define BENCH_SPSC_ITEMS 4000000          // Sequence numbers pushed through the stress-tested ring
+#define BENCH_SPSC_CAPACITY 64            // Small, so the producer overruns the consumer now and then
+
+// Every allocation in the process, counted so scenarios can show what they allocate
+static std::atomic<Uint64> allocationCount(0);
+
+// Scenarios that also check correctness count failures here; any makes the exit code 1
+static int checkFailures = 0;
+
+void* operator new(size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
+
+// One line of the report; fields below zero are left out
+struct BenchResult {
+    std::string name;
+    Uint64 events = 0;
+    double nsPerEvent = -1.0;
+    double nsPerSample = -1.0;      // Per output frame (all channels), or per decoded frame
+    double nsPerSampleVoice = -1.0; // Per output sample per playing voice
+    Uint64 allocations = 0;
+    long peakRssKb = 0;
+    Uint64 overflows = 0;           // Pushes a full queue refused, where a scenario reports them
+};
+
+static long getPeakRssKb() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return static_cast<long>(counters.PeakWorkingSetSize / 1024);
+    }
+    return 0;
+#else
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return static_cast<long>(usage.ru_maxrss / 1024); // Bytes on macOS
+#else
+    return static_cast<long>(usage.ru_maxrss);
+#endif
+#endif
+}
+
+// Times a scenario and counts its allocations
+struct BenchTimer {
+    Uint64 startNS = 0;
+    Uint64 elapsedNS = 0;
+    Uint64 startAllocations = allocationCount.load();
+    
+    void start() { startNS = SDL_GetTicksNS(); }
+    void stop() { elapsedNS += SDL_GetTicksNS() - startNS; }
+    
+    BenchResult result(const std::string& name, Uint64 events) const {
+        BenchResult r;
+        r.name = name;
+        r.events = events;
+        r.nsPerEvent = events > 0 ? static_cast<double>(elapsedNS) / events : -1.0;
+        r.allocations = allocationCount.load() - startAllocations;
+        r.peakRssKb = getPeakRssKb();
+        return r;
+    }
+};
+
+static const Sound& getTemplate(const SoundManager& soundManager, SoundHandle sound) {
+    return *soundManager.getSounds()[sound];
+}
+
+// playSound from the UI thread: building and queueing the command
+static BenchResult benchNoteOnUi(SoundManager& soundManager, const KeySounds& keySounds) {
+    BenchTimer timer;
+    Uint64 events = 0;
+    for (int burst = 0; burst < BENCH_NOTE_ON_BURSTS; burst++) {
+        timer.start();
+        for (int i = 0; i < BENCH_NOTE_ON_BURST; i++) {
+            soundManager.playSound(keySounds.drums[i % 8]);
+        }
+        timer.stop();
+        events += BENCH_NOTE_ON_BURST;
+        
+        SDL_Delay(BENCH_DRAIN_MS);
+        soundManager.update();
+    }
+    
+    BenchResult result = timer.result("note_on_ui", events);
+    if (soundManager.getDroppedCommandCount() > 0) {
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "note_on_ui dropped %llu commands",
+                    static_cast<unsigned long long>(soundManager.getDroppedCommandCount()));
+    }
+    return result;
+}
+
+// Applying NoteOn on the audio side, including voice stealing once the pool is full
+static BenchResult benchNoteOnMixer(const SoundManager& soundManager, const KeySounds& keySounds) {
+    std::vector<AudioCommand> commands;
+    for (SoundHandle note : keySounds.notes) {
+        commands.push_back(SoundManager::noteOnCommand(getTemplate(soundManager, note), AUDIO_FRAME_NOW, false,
+                                                       Articulation::Sustain, 1.0f));
+    }
+    
+    const SpeakerLayout& layout = soundManager.getSpeakerLayout();
+    Mixer mixer(VOICE_POOL_CAPACITY, (DEFAULT_DELAY_MS * AUDIO_SAMPLE_RATE) / 1000, layout);
+    std::vector<float> block(static_cast<size_t>(MIX_BLOCK_FRAMES) * layout.channels);
+    BenchTimer timer;
+    for (int done = 0; done < BENCH_MIXER_NOTE_ONS; done += MIX_BLOCK_FRAMES) {
+        timer.start();
+        for (int i = 0; i < MIX_BLOCK_FRAMES; i++) {
+            mixer.apply(commands[(done + i) % commands.size()]);
+        }
+        timer.stop();
+        mixer.mix(block.data(), MIX_BLOCK_FRAMES);
+    }
+    return timer.result("note_on_mixer", BENCH_MIXER_NOTE_ONS / MIX_BLOCK_FRAMES * MIX_BLOCK_FRAMES);
+}
+
+// Mixing N sustained voices spread around the listener, panned into a speaker layout
+static BenchResult benchPolyphony(const SoundManager& soundManager, const KeySounds& keySounds, int voices,
+                                  const SpeakerLayout& layout, const std::string& name) {
+    AudioCommand command = SoundManager::noteOnCommand(getTemplate(soundManager, keySounds.notes[0]),
+                                                       AUDIO_FRAME_NOW, true, Articulation::Sustain, 1.0f);
+    Mixer mixer(voices, (DEFAULT_DELAY_MS * AUDIO_SAMPLE_RATE) / 1000, layout);
+    for (int i = 0; i < voices; i++) {
+        command.soundId = i;
+        command.frequency = 50.0 + i * 0.37;
+        command.azimuth = (i * 37) % 360 - 180.0f;
+        mixer.apply(command);
+    }
+    
+    std::vector<float> block(static_cast<size_t>(MIX_BLOCK_FRAMES) * layout.channels);
+    BenchTimer timer;
+    timer.start();
+    for (int done = 0; done < BENCH_POLYPHONY_FRAMES; done += MIX_BLOCK_FRAMES) {
+        mixer.mix(block.data(), MIX_BLOCK_FRAMES);
+    }
+    timer.stop();
+    
+    BenchResult result = timer.result(name, static_cast<Uint64>(voices));
+    result.nsPerEvent = -1.0;
+    result.nsPerSampleVoice = static_cast<double>(timer.elapsedNS) / (static_cast<double>(BENCH_POLYPHONY_FRAMES) * voices);
+    return result;
+}
+
+// Mixing many sustained voices on the caller plus threads - 1 mix workers
+static BenchResult benchPolyphonyThreads(const SoundManager& soundManager, const KeySounds& keySounds, int threads,
+                                         bool deterministic) {
+    const int voices = BENCH_SCALING_VOICES;
+    AudioCommand command = SoundManager::noteOnCommand(getTemplate(soundManager, keySounds.notes[0]),
+                                                       AUDIO_FRAME_NOW, true, Articulation::Sustain, 1.0f);
+    const std::string name = "polyphony_" + std::to_string(voices) + "_threads_" + std::to_string(threads) +
+                             (deterministic ? "_deterministic" : "");
+    const SpeakerLayout& layout = soundManager.getSpeakerLayout();
+    MixWorkers workers(threads - 1, voices / MIX_BATCH_VOICES + 1, layout.channels * MIX_BLOCK_FRAMES, deterministic);
+    workers.start();
+    Mixer mixer(voices, (DEFAULT_DELAY_MS * AUDIO_SAMPLE_RATE) / 1000, layout);
+    mixer.setWorkers(&workers);
+    for (int i = 0; i < voices; i++) {
+        command.soundId = i;
+        command.frequency = 50.0 + i * 0.37;
+        command.azimuth = (i * 37) % 360 - 180.0f;
+        mixer.apply(command);
+    }
+    
+    std::vector<float> block(static_cast<size_t>(MIX_BLOCK_FRAMES) * layout.channels);
+    BenchTimer timer;
+    timer.start();
+    for (int done = 0; done < BENCH_POLYPHONY_FRAMES; done += MIX_BLOCK_FRAMES) {
+        mixer.mix(block.data(), MIX_BLOCK_FRAMES);
+    }
+    timer.stop();
+    
+    BenchResult result = timer.result(name, static_cast<Uint64>(voices));
+    result.nsPerEvent = -1.0;
+    result.nsPerSampleVoice = static_cast<double>(timer.elapsedNS) / (static_cast<double>(BENCH_POLYPHONY_FRAMES) * voices);
+    return result;
+}
+
+// Mixing a long WAV streamed from its memory mapping, paced so the streaming thread keeps up
+static BenchResult benchStream(SoundManager& soundManager) {
+    const int sampleRate = 44100;
+    const std::string path = "bench_stream.wav";
+    BenchResult result;
+    result.name = "stream_wav";
+    
+    WavWriter wav;
+    if (!wav.open(path, WavFormat::Pcm16, 2, sampleRate)) {
+        return result;
+    }
+    std::vector<float> second(static_cast<size_t>(sampleRate) * 2);
+    for (int s = 0; s < BENCH_STREAM_SECONDS; s++) {
+        for (int i = 0; i < sampleRate; i++) {
+            const double t = s + static_cast<double>(i) / sampleRate;
+            second[i * 2] = static_cast<float>(0.5 * std::sin(2.0 * M_PI * 220.0 * t));
+            second[i * 2 + 1] = static_cast<float>(0.5 * std::sin(2.0 * M_PI * 330.0 * t));
+        }
+        wav.write(second.data(), sampleRate);
+    }
+    wav.close();
+    
+    // Its own streamer, so the file is unmapped before it's deleted
+    Uint64 underruns = 0;
+    {
+        AudioStream stream;
+        AudioStreamer streamer;
+        if (stream.open(path) && streamer.add(&stream)) {
+            const SpeakerLayout& layout = soundManager.getSpeakerLayout();
+            Mixer mixer(1, (DEFAULT_DELAY_MS * AUDIO_SAMPLE_RATE) / 1000, layout);
+            AudioCommand command = {};
+            command.type = AudioCommandType::StreamPlay;
+            command.frame = AUDIO_FRAME_NOW;
+            command.gain = 1.0f;
+            command.stream = &stream;
+            mixer.apply(command);
+            
+            std::vector<float> block(static_cast<size_t>(MIX_BLOCK_FRAMES) * layout.channels);
+            BenchTimer timer;
+            Uint64 frames = 0;
+            while (!mixer.isSilent()) {
+                timer.start();
+                for (int done = 0; done < BENCH_STREAM_BURST_FRAMES && !mixer.isSilent(); done += MIX_BLOCK_FRAMES) {
+                    mixer.mix(block.data(), MIX_BLOCK_FRAMES);
+                    frames += MIX_BLOCK_FRAMES;
+                }
+                timer.stop();
+                SDL_Delay(STREAM_SERVICE_MS * 2);
+            }
+            
+            result = timer.result("stream_wav", frames / MIX_BLOCK_FRAMES);
+            result.nsPerSample = static_cast<double>(timer.elapsedNS) / frames;
+            underruns = stream.getUnderrunCount();
+        }
+    }
+    SDL_RemovePath(path.c_str());
+    
+    if (underruns > 0) {
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "stream_wav: %llu blocks waited on the disk",
+                    static_cast<unsigned long long>(underruns));
+    }
+    return result;
+}
+
+// Decoding a generated sampler instrument (per file), then mixing 256 voices playing it
+static void benchSampler(SoundManager& soundManager, const KeySounds& keySounds, std::vector<BenchResult>& results) {
+    const int sampleRate = 44100;
+    const int frames = sampleRate * BENCH_SAMPLE_SECONDS;
+    const std::string instrumentPath = "bench_instrument.txt";
+    std::vector<std::string> files;
+    std::vector<float> samples(static_cast<size_t>(frames) * 2);
+    std::string instrumentFile;
+    for (int zone = 0; zone < BENCH_SAMPLE_FILES; zone++) {
+        const int lowKey = 24 + zone * BENCH_SAMPLE_KEYS;
+        const int rootKey = lowKey + BENCH_SAMPLE_KEYS / 2;
+        const double frequency = SamplerInstrument::keyToFrequency(rootKey);
+        for (int i = 0; i < frames; i++) {
+            const double t = static_cast<double>(i) / sampleRate;
+            const float value = static_cast<float>(0.5 * std::exp(-t) * (std::sin(2.0 * M_PI * frequency * t) +
+                                                                         0.3 * std::sin(4.0 * M_PI * frequency * t)));
+            samples[i * 2] = value;
+            samples[i * 2 + 1] = value;
+        }
+        
+        const std::string file = "bench_sample_" + std::to_string(zone) + ".wav";
+        WavWriter wav;
+        if (wav.open(file, WavFormat::Pcm16, 2, sampleRate)) {
+            wav.write(samples.data(), frames);
+            wav.close();
+        }
+        files.push_back(file);
+        instrumentFile += file + " " + std::to_string(lowKey) + " " + std::to_string(lowKey + BENCH_SAMPLE_KEYS - 1) +
+                          " " + std::to_string(rootKey) + "\n";
+    }
+    SDL_SaveFile(instrumentPath.c_str(), instrumentFile.data(), instrumentFile.size());
+    
+    BenchTimer decodeTimer;
+    decodeTimer.start();
+    const SamplerInstrument* instrument = soundManager.loadInstrument(instrumentPath);
+    decodeTimer.stop();
+    BenchResult decode = decodeTimer.result("sampler_decode", instrument ? BENCH_SAMPLE_FILES : 0);
+    const double decodedFrames = static_cast<double>(frames) * BENCH_SAMPLE_FILES;
+    decode.nsPerSample = instrument ? static_cast<double>(decodeTimer.elapsedNS) / decodedFrames : -1.0;
+    results.push_back(decode);
+    
+    for (const std::string& file : files) {
+        SDL_RemovePath(file.c_str());
+    }
+    SDL_RemovePath(instrumentPath.c_str());
+    if (!instrument) {
+        return;
+    }
+    
+    // Up to an octave above the zone's root, so no voice runs out of sample during the run
+    const SoundHandle note = keySounds.notes[0];
+    soundManager.setInstrument(note, instrument);
+    AudioCommand command = SoundManager::noteOnCommand(getTemplate(soundManager, note), AUDIO_FRAME_NOW, true,
+                                                       Articulation::Sustain, 1.0f);
+    soundManager.setInstrument(note, nullptr);
+    
+    const int voices = 256;
+    const SpeakerLayout& layout = soundManager.getSpeakerLayout();
+    Mixer mixer(voices, (DEFAULT_DELAY_MS * AUDIO_SAMPLE_RATE) / 1000, layout);
+    const double rootRate = command.playbackRate;
+    for (int i = 0; i < voices; i++) {
+        command.soundId = i;
+        command.playbackRate = rootRate * std::pow(2.0, (i % 12) / 12.0 + i * 0.0001);
+        command.azimuth = (i * 37) % 360 - 180.0f;
+        mixer.apply(command);
+    }
+    
+    std::vector<float> block(static_cast<size_t>(MIX_BLOCK_FRAMES) * layout.channels);
+    BenchTimer timer;
+    timer.start();
+    for (int done = 0; done < BENCH_POLYPHONY_FRAMES; done += MIX_BLOCK_FRAMES) {
+        mixer.mix(block.data(), MIX_BLOCK_FRAMES);
+    }
+    timer.stop();
+    
+    BenchResult result = timer.result("polyphony_256_sampler", static_cast<Uint64>(voices));
+    result.nsPerEvent = -1.0;
+    result.nsPerSampleVoice = static_cast<double>(timer.elapsedNS) / (static_cast<double>(BENCH_POLYPHONY_FRAMES) * voices);
+    results.push_back(result);
+}
+
+// Every repeater retriggering at the shortest delay
+static BenchResult benchRetriggerStorm(const SoundManager& soundManager, const KeySounds& keySounds) {
+    const int interval = (MIN_DELAY_MS * AUDIO_SAMPLE_RATE) / 1000;
+    AudioCommand command = SoundManager::noteOnCommand(getTemplate(soundManager, keySounds.drums[0]),
+                                                       AUDIO_FRAME_NOW, true, Articulation::Repeat, 1.0f);
+    const SpeakerLayout& layout = soundManager.getSpeakerLayout();
+    Mixer mixer(VOICE_POOL_CAPACITY, interval, layout);
+    for (int i = 0; i < REPEATER_CAPACITY; i++) {
+        command.soundId = i;
+        command.frequency = 50.0 + i;
+        mixer.apply(command);
+    }
+    
+    std::vector<float> block(static_cast<size_t>(MIX_BLOCK_FRAMES) * layout.channels);
+    Uint64 voiceFrames = 0;
+    BenchTimer timer;
+    timer.start();
+    for (int done = 0; done < BENCH_STORM_FRAMES; done += MIX_BLOCK_FRAMES) {
+        mixer.mix(block.data(), MIX_BLOCK_FRAMES);
+        voiceFrames += static_cast<Uint64>(mixer.getPlayingCount()) * MIX_BLOCK_FRAMES;
+    }
+    timer.stop();
+    
+    const Uint64 retriggers = static_cast<Uint64>(REPEATER_CAPACITY) * (BENCH_STORM_FRAMES / interval);
+    BenchResult result = timer.result("retrigger_storm", retriggers);
+    result.nsPerSampleVoice = voiceFrames > 0 ? static_cast<double>(timer.elapsedNS) / voiceFrames : -1.0;
+    return result;
+}
+
+// Real-time playback of a recording: time spent in update() (idle calls included) per event played
+static BenchResult benchPlaybackRealtime(SoundManager& soundManager, const std::string& recording,
+                                         const std::vector<SoundEvent>& events) {
+    BenchTimer timer;
+    if (events.empty() || !soundManager.loadRecordingFromFile(recording)) {
+        return timer.result("playback_realtime", 0);
+    }
+    
+    const Uint64 duration = events.back().timestamp + PLAYBACK_LOOKAHEAD_MS;
+    const Uint64 limit = duration < BENCH_PLAYBACK_MAX_MS ? duration : BENCH_PLAYBACK_MAX_MS;
+    const Uint64 startMs = SDL_GetTicks();
+    
+    soundManager.startPlayback();
+    while (SDL_GetTicks() - startMs < limit) {
+        timer.start();
+        soundManager.update();
+        timer.stop();
+        SDL_Delay(1);
+    }
+    soundManager.stopPlayback();
+    
+    // Events are handed out PLAYBACK_LOOKAHEAD_MS early
+    Uint64 played = 0;
+    for (const SoundEvent& event : events) {
+        if (event.timestamp <= limit + PLAYBACK_LOOKAHEAD_MS) played++;
+    }
+    return timer.result("playback_realtime", played);
+}
+
+// Offline render of a recording, on one thread and on every core
+static BenchResult benchPlaybackOffline(SoundManager& soundManager, const std::string& recording,
+                                        const std::string& wavPath, int threads, const char* name) {
+    BenchTimer timer;
+    if (!soundManager.loadRecordingFromFile(recording)) {
+        return timer.result(name, 0);
+    }
+    
+    timer.start();
+    const bool rendered = soundManager.renderRecording(wavPath, WavFormat::Float32, threads);
+    timer.stop();
+    
+    SDL_PathInfo info;
+    const int channels = soundManager.getSpeakerLayout().channels;
+    const Uint64 headerSize = channels > 2 ? 80 : 58; // RIFF, (extensible) fmt and fact chunks of a float WAV
+    const Uint64 frameBytes = sizeof(float) * channels;
+    const Uint64 frames = rendered && SDL_GetPathInfo(wavPath.c_str(), &info) ? (info.size - headerSize) / frameBytes : 0;
+    SDL_RemovePath(wavPath.c_str());
+    
+    BenchResult result = timer.result(name, frames);
+    result.nsPerEvent = -1.0;
+    result.nsPerSample = frames > 0 ? static_cast<double>(timer.elapsedNS) / frames : -1.0;
+    return result;
+}
+
+// Producer side of the SPSC stress test: pushes every sequence number in turn, retrying
+// while the ring is full and counting each refused push
+struct SpscProducer {
+    SpscQueue<Uint64>* queue;
+    Uint64 refused = 0;
+};
+
+static int SDLCALL spscProducerMain(void* userdata) {
+    SpscProducer* producer = static_cast<SpscProducer*>(userdata);
+    for (Uint64 sequence = 0; sequence < BENCH_SPSC_ITEMS; sequence++) {
+        while (!producer->queue->push(sequence)) {
+            producer->refused++;
+            std::this_thread::yield(); // Let the consumer run even on one core
+        }
+    }
+    return 0;
+}
+
+// The lock-free ring between two threads: every number must come out once and in order,
+// and the ring's overflow count must match the pushes the producer saw refused
+static BenchResult benchSpscStress() {
+    SpscQueue<Uint64> queue(BENCH_SPSC_CAPACITY);
+    SpscProducer producer;
+    producer.queue = &queue;
+    
+    BenchTimer timer;
+    timer.start();
+    SDL_Thread* thread = SDL_CreateThread(spscProducerMain, "SpscProducer", &producer);
+    if (!thread) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "spsc_stress: no producer thread: %s", SDL_GetError());
+        checkFailures++;
+        return timer.result("spsc_stress", 0);
+    }
+    
+    Uint64 received = 0;
+    Uint64 wrong = 0;
+    Uint64 sequence;
+    bool producerDone = false;
+    while (received < BENCH_SPSC_ITEMS) {
+        if (!queue.pop(sequence)) {
+            if (producerDone) {
+                break; // Empty after the last push: items were lost
+            }
+            producerDone = SDL_GetThreadState(thread) == SDL_THREAD_COMPLETE;
+            std::this_thread::yield();
+            continue;
+        }
+        wrong += sequence != received;
+        received++;
+    }
+    SDL_WaitThread(thread, nullptr);
+    timer.stop();
+    
+    const Uint64 overflows = queue.getOverflowCount();
+    if (received != BENCH_SPSC_ITEMS || wrong > 0 || producer.refused != overflows) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "spsc_stress: %llu of %d received, %llu out of sequence, "
+                     "%llu pushes refused but %llu overflows counted", static_cast<unsigned long long>(received),
+                     BENCH_SPSC_ITEMS, static_cast<unsigned long long>(wrong),
+                     static_cast<unsigned long long>(producer.refused), static_cast<unsigned long long>(overflows));
+        checkFailures++;
+    }
+    
+    BenchResult result = timer.result("spsc_stress", received);
+    result.overflows = overflows;
+    return result;
+}
+
+// Load and save of a large recording through SoundManager, text and binary
+static void benchSaveLoad(SoundManager& soundManager, int eventCount, std::vector<BenchResult>& results) {
+    std::vector<std::string> names;
+    for (SoundHandle sound = 0; sound < static_cast<SoundHandle>(soundManager.getSounds().size()); sound++) {
+        names.push_back(soundManager.getSoundName(sound));
+    }
+    
+    // A long session of key presses over every sound
+    std::vector<SoundEvent> events(eventCount);
+    Uint64 timestamp = 0;
+    for (int i = 0; i < eventCount; i++) {
+        SoundEvent& event = events[i];
+        timestamp += (i * 7919u) % 150;
+        event.sound = static_cast<SoundHandle>((i / 2) % names.size());
+        event.timestamp = timestamp;
+        event.isKeyDown = (i % 2) == 0;
+        event.volume = (i % 1000) == 0 ? 0.5f : 1.0f;
+        event.delay = DEFAULT_DELAY_MS;
+        event.articulation = Articulation::Sustain;
+    }
+    
+    const std::string csvPath = "bench_recording.txt";
+    const std::string binaryPath = std::string("bench_recording") + RECORDING_EXTENSION;
+    if (!saveRecordingCsv(csvPath, events, names)) {
+        SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Could not write %s", csvPath.c_str());
+        return;
+    }
+    
+    struct Step {
+        const char* name;
+        bool save;
+        const std::string* path;
+    };
+    const Step steps[] = {
+        {"load_csv", false, &csvPath},
+        {"save_binary", true, &binaryPath},
+        {"load_binary", false, &binaryPath},
+        {"save_csv", true, &csvPath},
+    };
+    for (const Step& step : steps) {
+        BenchTimer timer;
+        timer.start();
+        const bool ok = step.save ? soundManager.saveRecordingToFile(*step.path)
+                                  : soundManager.loadRecordingFromFile(*step.path);
+        timer.stop();
+        if (!ok) {
+            SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "%s failed", step.name);
+        }
+        results.push_back(timer.result(step.name, static_cast<Uint64>(eventCount)));
+    }
+    
+    SDL_RemovePath(csvPath.c_str());
+    SDL_RemovePath(binaryPath.c_str());
+}
+
+static void printResults(const std::vector<BenchResult>& results, const char* driver) {
+    printf("{\n  \"audio_driver\": \"%s\",\n  \"sample_rate\": %d,\n  \"dsp_kernels\": \"%s\",\n  \"scenarios\": [\n",
+           driver, AUDIO_SAMPLE_RATE, getDspKernels().name);
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& r = results[i];
+        printf("    {\"name\": \"%s\", \"events\": %llu", r.name.c_str(), static_cast<unsigned long long>(r.events));
+        if (r.nsPerEvent >= 0.0) printf(", \"ns_per_event\": %.2f", r.nsPerEvent);
+        if (r.nsPerSample >= 0.0) printf(", \"ns_per_sample\": %.4f", r.nsPerSample);
+        if (r.nsPerSampleVoice >= 0.0) printf(", \"ns_per_sample_voice\": %.4f", r.nsPerSampleVoice);
+        if (r.overflows > 0) printf(", \"overflows\": %llu", static_cast<unsigned long long>(r.overflows));
+        printf(", \"allocations\": %llu, \"peak_rss_kb\": %ld}%s\n", static_cast<unsigned long long>(r.allocations),
+               r.peakRssKb, i + 1 < results.size() ? "," : "");
+    }
+    printf("  ],\n  \"peak_rss_kb\": %ld\n}\n", getPeakRssKb());
+}
+
+int main(int argc, char* argv[]) {
+    const char* driver = "dummy";
+    std::string recording = std::string(BENCH_RECORDINGS_PATH) + "1.txt";
+    int eventCount = BENCH_RECORDING_EVENTS;
+    for (int i = 1; i + 1 < argc; i++) {
+        if (SDL_strcmp(argv[i], "--driver") == 0) {
+            driver = argv[++i];
+        } else if (SDL_strcmp(argv[i], "--recording") == 0) {
+            recording = argv[++i];
+        } else if (SDL_strcmp(argv[i], "--events") == 0) {
+            eventCount = SDL_atoi(argv[++i]);
+        }
+    }
+    
+    // Only warnings reach stderr; stdout is the report
+    SDL_SetLogPriorities(SDL_LOG_PRIORITY_WARN);
+    SDL_SetHint(SDL_HINT_AUDIO_DRIVER, driver);
+    if (!SDL_Init(SDL_INIT_AUDIO)) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't initialize SDL audio: %s", SDL_GetError());
+        return -1;
+    }
+    
+    SDL_AudioSpec audioSpec;
+    SDL_zero(audioSpec);
+    audioSpec.format = SDL_AUDIO_F32;
+    audioSpec.channels = AUDIO_CHANNELS;
+    audioSpec.freq = AUDIO_SAMPLE_RATE;
+    SDL_AudioDeviceID audioDevice = SDL_OpenAudioDevice(SDL_AUDIO_DEVICE_DEFAULT_PLAYBACK, &audioSpec);
+    if (!audioDevice) {
+        SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Failed to open audio device: %s", SDL_GetError());
+        SDL_Quit();
+        return -1;
+    }
+    
+    std::vector<BenchResult> results;
+    {
+        SoundManager soundManager(audioDevice);
+        KeySounds keySounds;
+        addKeySounds(soundManager, getNoteFrequencies(), keySounds);
+        
+        std::map<std::string, SoundHandle> handles;
+        for (SoundHandle sound = 0; sound < static_cast<SoundHandle>(soundManager.getSounds().size()); sound++) {
+            handles[soundManager.getSoundName(sound)] = sound;
+        }
+        std::vector<SoundEvent> recordedEvents;
+        if (!loadRecordingCsv(recording, handles, recordedEvents)) {
+            SDL_LogWarn(SDL_LOG_CATEGORY_APPLICATION, "Could not read %s, skipping playback", recording.c_str());
+        }
+        
+        results.push_back(benchNoteOnUi(soundManager, keySounds));
+        results.push_back(benchNoteOnMixer(soundManager, keySounds));
+        for (int voices = 16; voices <= 4096; voices *= 4) {
+            results.push_back(benchPolyphony(soundManager, keySounds, voices, soundManager.getSpeakerLayout(),
+                                             "polyphony_" + std::to_string(voices)));
+        }
+        
+        // Panning cost per layout
+        for (int channels : {1, 2, 4, 6}) {
+            const SpeakerLayout& layout = getSpeakerLayout(channels);
+            results.push_back(benchPolyphony(soundManager, keySounds, 256, layout,
+                                             std::string("polyphony_256_") + layout.name));
+        }
+        
+        // 1, 2, 4... threads up to every core (at least two, to show the cost when there is only one)
+        const int cores = SDL_GetNumLogicalCPUCores() > 2 ? SDL_GetNumLogicalCPUCores() : 2;
+        std::vector<int> threadCounts;
+        for (int threads = 1; threads < cores; threads *= 2) {
+            threadCounts.push_back(threads);
+        }
+        threadCounts.push_back(cores);
+        for (int threads : threadCounts) {
+            results.push_back(benchPolyphonyThreads(soundManager, keySounds, threads, true));
+            results.push_back(benchPolyphonyThreads(soundManager, keySounds, threads, false));
+        }
+        benchSampler(soundManager, keySounds, results);
+        results.push_back(benchStream(soundManager));
+        results.push_back(benchRetriggerStorm(soundManager, keySounds));
+        results.push_back(benchPlaybackRealtime(soundManager, recording, recordedEvents));
+        results.push_back(benchPlaybackOffline(soundManager, recording, "bench_render.wav", 1, "playback_offline"));
+        results.push_back(benchPlaybackOffline(soundManager, recording, "bench_render.wav", 0,
+                                               "playback_offline_parallel"));
+        benchSaveLoad(soundManager, eventCount, results);
+    }
+    results.push_back(benchSpscStress());
+    
+    printResults(results, driver);
+    
+    SDL_CloseAudioDevice(audioDevice);
+    SDL_Quit();
+    return checkFailures > 0 ? 1 : 0;
+}
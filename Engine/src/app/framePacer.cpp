@@ -0,0 +1,75 @@
+#include "framePacer.hpp"
+#include "../audio/config.hpp"
+
+FramePacer::FramePacer(const VideoSettings& settings)
+    : maxFPS(settings.maxFPS), idleFPS(settings.idleFPS), activeIntervalNS(0) {
+    nextFrameNS = SDL_GetTicksNS();
+    lastChangeNS = nextFrameNS;
+    setRefreshRate(0.0f);
+}
+
+void FramePacer::setRefreshRate(float refreshRate) {
+    // Drawing faster than the display shows frames only burns CPU
+    float fps = static_cast<float>(maxFPS);
+    if (refreshRate > 0.0f && (fps <= 0.0f || refreshRate < fps)) {
+        fps = refreshRate;
+    }
+    activeIntervalNS = fps > 0.0f ? static_cast<Uint64>(SDL_NS_PER_SECOND / fps) : 0;
+}
+
+Sint32 FramePacer::getTimeoutMs(Uint64 nowNS) const {
+    if (nextFrameNS <= nowNS) {
+        return 0;
+    }
+    return static_cast<Sint32>((nextFrameNS - nowNS + SDL_NS_PER_MS - 1) / SDL_NS_PER_MS);
+}
+
+void FramePacer::wake(Uint64 nowNS) {
+    lastChangeNS = nowNS;
+    if (idle) {
+        idle = false;
+        nextFrameNS = nowNS;
+    }
+}
+
+bool FramePacer::beginFrame(Uint64 nowNS) {
+    // Woken by input only: keep the frame rate at the cap
+    if (nowNS < nextFrameNS) {
+        return false;
+    }
+    
+    const Uint64 interval = idle && idleFPS > 0 ? SDL_NS_PER_SECOND / idleFPS : activeIntervalNS;
+    nextFrameNS = nextFrameNS + interval > nowNS ? nextFrameNS + interval : nowNS + interval;
+    return true;
+}
+
+void FramePacer::endFrame(Uint64 nowNS, bool changed, bool soundIdle) {
+    framesLaidOut++;
+    if (idle) {
+        idleFrames++;
+    }
+    
+    if (changed || !soundIdle) {
+        lastChangeNS = nowNS;
+        idle = false;
+    } else if (nowNS - lastChangeNS >= SDL_MS_TO_NS(IDLE_AFTER_MS)) {
+        idle = true;
+    }
+}
+
+void FramePacer::countPresent(Uint64 renderTimeNS) {
+    framesPresented++;
+    renderNS += renderTimeNS;
+    if (renderTimeNS > maxRenderNS) {
+        maxRenderNS = renderTimeNS;
+    }
+}
+
+void FramePacer::logSummary() const {
+    SDL_Log("Frames: %llu laid out, %llu presented, %llu while idle", static_cast<unsigned long long>(framesLaidOut),
+            static_cast<unsigned long long>(framesPresented), static_cast<unsigned long long>(idleFrames));
+    if (framesPresented > 0) {
+        SDL_Log("  render per presented frame: avg %.2f ms, max %.2f ms",
+                renderNS / static_cast<double>(framesPresented) / SDL_NS_PER_MS, maxRenderNS / static_cast<double>(SDL_NS_PER_MS));
+    }
+}
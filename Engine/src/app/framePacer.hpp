@@ -0,0 +1,55 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include "../settings/videoSettings.hpp"
+
+// Decides when the main loop lays out and draws a frame. While anything on screen changes,
+// frames come at the lower of maxFPS and the display's refresh rate; once the scene has been
+// still for IDLE_AFTER_MS with nothing playing, the loop only checks in at idleFPS. Input
+// wakes it at once either way, since it sleeps in SDL_WaitEventTimeout. It also counts how
+// many frames were laid out and presented and what presenting them cost.
+class FramePacer {
+private:
+    int maxFPS;
+    int idleFPS;
+    Uint64 activeIntervalNS;
+    Uint64 nextFrameNS;
+    Uint64 lastChangeNS; // Last frame that differed from the one before
+    bool idle = false;
+    
+    // Per-frame counters
+    Uint64 framesLaidOut = 0;
+    Uint64 framesPresented = 0;
+    Uint64 idleFrames = 0;
+    Uint64 renderNS = 0;    // Clearing, drawing and presenting, summed over presented frames
+    Uint64 maxRenderNS = 0;
+    
+public:
+    explicit FramePacer(const VideoSettings& settings);
+    
+    // Display refresh rate in Hz (0 = unknown); frames are never paced faster than it
+    void setRefreshRate(float refreshRate);
+    
+    // How long the loop may sleep waiting for input
+    Sint32 getTimeoutMs(Uint64 nowNS) const;
+    
+    // Input arrived: leave idle, the next frame is due now
+    void wake(Uint64 nowNS);
+    
+    // Whether a frame is due; if so, schedules the one after it
+    bool beginFrame(Uint64 nowNS);
+    
+    // The frame was laid out: changed if it differs from the one on screen, soundIdle if
+    // nothing is playing that could change it without input
+    void endFrame(Uint64 nowNS, bool changed, bool soundIdle);
+    
+    // A frame was presented, taking renderTimeNS to clear, draw and present
+    void countPresent(Uint64 renderTimeNS);
+    
+    bool isIdle() const { return idle; }
+    Uint64 getFramesLaidOut() const { return framesLaidOut; }
+    Uint64 getFramesPresented() const { return framesPresented; }
+    
+    // Log the counters (at exit)
+    void logSummary() const;
+};
@@ -0,0 +1,41 @@
+#include "audioClock.hpp"
+#include "config.hpp"
+
+void AudioClock::publish(Uint64 startFrame, Uint64 nowNS, int frames) {
+    const Uint32 s = sequence.load(std::memory_order_relaxed);
+    sequence.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    
+    frame.store(startFrame, std::memory_order_relaxed);
+    ticksNS.store(nowNS, std::memory_order_relaxed);
+    callbackFrames.store(frames, std::memory_order_relaxed);
+    
+    sequence.store(s + 2, std::memory_order_release);
+}
+
+bool AudioClock::frameAt(Uint64 timestampNS, Sint64* outFrame) const {
+    Uint64 startFrame, startNS;
+    int frames;
+    Uint32 before, after;
+    
+    // Retry until we read a pair no publish was writing to
+    do {
+        before = sequence.load(std::memory_order_acquire);
+        startFrame = frame.load(std::memory_order_relaxed);
+        startNS = ticksNS.load(std::memory_order_relaxed);
+        frames = callbackFrames.load(std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = sequence.load(std::memory_order_relaxed);
+    } while ((before & 1) || before != after);
+    
+    if (startNS == 0) {
+        return false;
+    }
+    
+    // Signed: the event may predate the callback it is compared against
+    const Sint64 elapsedNS = static_cast<Sint64>(timestampNS) - static_cast<Sint64>(startNS);
+    const Sint64 elapsedFrames = elapsedNS * AUDIO_SAMPLE_RATE / static_cast<Sint64>(SDL_NS_PER_SECOND);
+    
+    *outFrame = static_cast<Sint64>(startFrame) + frames + elapsedFrames;
+    return true;
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <atomic>
+
+// Maps SDL event timestamps (SDL_GetTicksNS time base) to output sample frames.
+// The audio callback publishes which frame it starts mixing and when; readers on
+// any thread get a consistent pair through a seqlock, without taking a lock.
+class AudioClock {
+private:
+    std::atomic<Uint32> sequence{0};      // Odd while a publish is in progress
+    std::atomic<Uint64> frame{0};         // First frame mixed by the last callback
+    std::atomic<Uint64> ticksNS{0};       // When that callback started (0 = never ran)
+    std::atomic<int> callbackFrames{0};   // Frames mixed by that callback
+    
+public:
+    // Audio thread: a callback is about to mix `frames` frames starting at `startFrame`
+    void publish(Uint64 startFrame, Uint64 nowNS, int frames);
+    
+    // Frame an event at timestampNS should start on. Events land one callback
+    // period behind the clock, so one that arrives before the next callback is
+    // played exactly; later ones come out late by however long they were held up.
+    // Returns false if the audio device hasn't pulled anything yet.
+    bool frameAt(Uint64 timestampNS, Sint64* outFrame) const;
+};
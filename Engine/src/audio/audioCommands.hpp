@@ -0,0 +1,57 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include "envelope.hpp"
+#include "samplePool.hpp"
+#include "wavetable.hpp"
+
+class AudioStream;
+
+// Frame value meaning "at the start of the next mixed block"
+#define AUDIO_FRAME_NOW (-1)
+
+// What the UI thread asks the audio thread to do
+enum class AudioCommandType : Uint8 {
+    NoteOn,            // Start a voice (and optionally a repeater) at frame
+    NoteOff,           // Release the held voices and repeater of soundId at frame
+    ReleaseAll,        // Release every held voice and repeater now
+    StopRepeats,       // Forget the repeater of soundId (sound removed)
+    Retune,            // New frequency (and sample) for the repeater of soundId
+    SetPosition,       // Move the voices and repeater of soundId to azimuth
+    SetRepeatInterval, // Held-key retrigger interval in frames
+    SetStealPolicy,
+    SetInterpolation,
+    StreamPlay,        // Play stream from its first frame at gain and azimuth
+    StreamStop         // Stop stream
+};
+
+// One fixed-size command. Everything the audio thread needs travels by value,
+// so it never reads a Sound template the UI thread may be editing
+struct AudioCommand {
+    AudioCommandType type;
+    bool repeat;                    // NoteOn: retrigger every repeat interval until NoteOff
+    int soundId;
+    Sint64 frame;                   // Output frame to act on, AUDIO_FRAME_NOW = next block
+    const WavetableSet* wavetable;  // NoteOn
+    const SampleData* sample;       // NoteOn, Retune: sample played instead of the wavetable, nullptr = none
+    double playbackRate;            // NoteOn, Retune: sample frames per output frame
+    double frequency;               // NoteOn, Retune
+    float gain;                     // NoteOn, already scaled by the volume at the time
+    float azimuth;                  // NoteOn, SetPosition: degrees from straight ahead, positive to the right
+    int intValue;                   // NoteOn: releaseAt, SetRepeatInterval: frames, policy/interpolation enum
+    EnvelopeParams envelope;        // NoteOn
+    AudioStream* stream;            // StreamPlay, StreamStop
+};
+
+// What the audio thread reports back about its voices
+enum class VoiceEventType : Uint8 {
+    Started,  // A note began in slot (replacing whatever was there)
+    Finished  // Slot went idle
+};
+
+struct VoiceEvent {
+    VoiceEventType type;
+    int slot;
+    int soundId;
+    double frequency;
+};
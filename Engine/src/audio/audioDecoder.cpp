@@ -0,0 +1,202 @@
+#include "audioDecoder.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+
+// The vendored single-header decoders (thirdparty/raudio/include/external) are compiled
+// here and nowhere else. All of them allocate with malloc, so one free() releases any result
+#define DR_WAV_IMPLEMENTATION
+#define DR_FLAC_IMPLEMENTATION
+#define DR_MP3_IMPLEMENTATION
+#define STB_VORBIS_IMPLEMENTATION
+#include "dr_wav.h"
+#include "dr_flac.h"
+#include "dr_mp3.h"
+#include "stb_vorbis.h"
+
+DecodedAudio::~DecodedAudio() {
+    free(samples);
+}
+
+static std::string fileExtension(const std::string& path) {
+    std::string extension = path.substr(path.find_last_of('.') + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension;
+}
+
+static bool decodeVorbis(const std::string& path, DecodedAudio& audio) {
+    int error = 0;
+    stb_vorbis* vorbis = stb_vorbis_open_filename(path.c_str(), &error, nullptr);
+    if (!vorbis) {
+        return false;
+    }
+    
+    const stb_vorbis_info info = stb_vorbis_get_info(vorbis);
+    const Uint64 frames = stb_vorbis_stream_length_in_samples(vorbis);
+    float* samples = static_cast<float*>(malloc(static_cast<size_t>(frames) * info.channels * sizeof(float)));
+    if (samples && frames > 0) {
+        audio.frames = stb_vorbis_get_samples_float_interleaved(vorbis, info.channels, samples,
+                                                                static_cast<int>(frames * info.channels));
+        audio.samples = samples;
+        audio.channels = info.channels;
+        audio.sampleRate = static_cast<int>(info.sample_rate);
+    } else {
+        free(samples);
+    }
+    stb_vorbis_close(vorbis);
+    return audio.samples != nullptr;
+}
+
+bool decodeAudioFile(const std::string& path, DecodedAudio& audio) {
+    const std::string extension = fileExtension(path);
+    
+    unsigned int channels = 0;
+    unsigned int sampleRate = 0;
+    
+    if (extension == "wav") {
+        drwav_uint64 frames = 0;
+        audio.samples = drwav_open_file_and_read_pcm_frames_f32(path.c_str(), &channels, &sampleRate, &frames, nullptr);
+        audio.frames = frames;
+    } else if (extension == "flac") {
+        drflac_uint64 frames = 0;
+        audio.samples = drflac_open_file_and_read_pcm_frames_f32(path.c_str(), &channels, &sampleRate, &frames);
+        audio.frames = frames;
+    } else if (extension == "mp3") {
+        drmp3_config config = {};
+        drmp3_uint64 frames = 0;
+        audio.samples = drmp3_open_file_and_read_f32(path.c_str(), &config, &frames);
+        audio.frames = frames;
+        channels = config.outputChannels;
+        sampleRate = config.outputSampleRate;
+    } else if (extension == "ogg") {
+        return decodeVorbis(path, audio);
+    } else {
+        SDL_Log("Unsupported audio file type: %s", path.c_str());
+        return false;
+    }
+    
+    audio.channels = static_cast<int>(channels);
+    audio.sampleRate = static_cast<int>(sampleRate);
+    return audio.samples != nullptr;
+}
+
+StreamDecoder::StreamDecoder() : format(Format::None), handle(nullptr), channels(0), sampleRate(0) {}
+
+StreamDecoder::~StreamDecoder() {
+    close();
+}
+
+bool StreamDecoder::open(const std::string& path) {
+    close();
+    const std::string extension = fileExtension(path);
+    
+    if (extension == "wav") {
+        drwav* wav = new drwav;
+        if (!drwav_init_file(wav, path.c_str(), nullptr)) {
+            delete wav;
+            return false;
+        }
+        format = Format::Wav;
+        handle = wav;
+        channels = wav->channels;
+        sampleRate = static_cast<int>(wav->sampleRate);
+    } else if (extension == "flac") {
+        drflac* flac = drflac_open_file(path.c_str());
+        if (!flac) {
+            return false;
+        }
+        format = Format::Flac;
+        handle = flac;
+        channels = flac->channels;
+        sampleRate = static_cast<int>(flac->sampleRate);
+    } else if (extension == "mp3") {
+        drmp3* mp3 = new drmp3;
+        if (!drmp3_init_file(mp3, path.c_str(), nullptr)) {
+            delete mp3;
+            return false;
+        }
+        format = Format::Mp3;
+        handle = mp3;
+        channels = static_cast<int>(mp3->channels);
+        sampleRate = static_cast<int>(mp3->sampleRate);
+    } else if (extension == "ogg") {
+        int error = 0;
+        stb_vorbis* vorbis = stb_vorbis_open_filename(path.c_str(), &error, nullptr);
+        if (!vorbis) {
+            return false;
+        }
+        const stb_vorbis_info info = stb_vorbis_get_info(vorbis);
+        format = Format::Vorbis;
+        handle = vorbis;
+        channels = info.channels;
+        sampleRate = static_cast<int>(info.sample_rate);
+    } else {
+        SDL_Log("Unsupported audio file type: %s", path.c_str());
+        return false;
+    }
+    
+    if (channels <= 0 || sampleRate <= 0) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void StreamDecoder::close() {
+    switch (format) {
+        case Format::Wav:
+            drwav_uninit(static_cast<drwav*>(handle));
+            delete static_cast<drwav*>(handle);
+            break;
+        case Format::Flac:
+            drflac_close(static_cast<drflac*>(handle));
+            break;
+        case Format::Mp3:
+            drmp3_uninit(static_cast<drmp3*>(handle));
+            delete static_cast<drmp3*>(handle);
+            break;
+        case Format::Vorbis:
+            stb_vorbis_close(static_cast<stb_vorbis*>(handle));
+            break;
+        case Format::None:
+            break;
+    }
+    format = Format::None;
+    handle = nullptr;
+    channels = 0;
+    sampleRate = 0;
+}
+
+int StreamDecoder::read(float* interleaved, int frames) {
+    switch (format) {
+        case Format::Wav:
+            return static_cast<int>(drwav_read_pcm_frames_f32(static_cast<drwav*>(handle), frames, interleaved));
+        case Format::Flac:
+            return static_cast<int>(drflac_read_pcm_frames_f32(static_cast<drflac*>(handle), frames, interleaved));
+        case Format::Mp3:
+            return static_cast<int>(drmp3_read_pcm_frames_f32(static_cast<drmp3*>(handle), frames, interleaved));
+        case Format::Vorbis:
+            return stb_vorbis_get_samples_float_interleaved(static_cast<stb_vorbis*>(handle), channels,
+                                                            interleaved, frames * channels);
+        case Format::None:
+            break;
+    }
+    return 0;
+}
+
+bool StreamDecoder::rewind() {
+    switch (format) {
+        case Format::Wav:
+            return drwav_seek_to_pcm_frame(static_cast<drwav*>(handle), 0);
+        case Format::Flac:
+            return drflac_seek_to_pcm_frame(static_cast<drflac*>(handle), 0);
+        case Format::Mp3:
+            return drmp3_seek_to_pcm_frame(static_cast<drmp3*>(handle), 0);
+        case Format::Vorbis:
+            return stb_vorbis_seek_start(static_cast<stb_vorbis*>(handle)) != 0;
+        case Format::None:
+            break;
+    }
+    return false;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <string>
+
+// Interleaved float frames decoded from an audio file, freed with the object
+struct DecodedAudio {
+    float* samples = nullptr;
+    Uint64 frames = 0;
+    int channels = 0;
+    int sampleRate = 0;
+    
+    DecodedAudio() = default;
+    ~DecodedAudio();
+    DecodedAudio(const DecodedAudio&) = delete;
+    DecodedAudio& operator=(const DecodedAudio&) = delete;
+};
+
+// Decode a whole WAV, FLAC, MP3 or Ogg Vorbis file, picked by its extension.
+// Thread safe: every call decodes on its own state
+bool decodeAudioFile(const std::string& path, DecodedAudio& audio);
+
+// Decodes a WAV, FLAC, MP3 or Ogg Vorbis file a few frames at a time, for files too long
+// to hold decoded. Only ever used by one thread at a time
+class StreamDecoder {
+private:
+    enum class Format { None, Wav, Flac, Mp3, Vorbis };
+    Format format;
+    void* handle;
+    int channels;
+    int sampleRate;
+
+public:
+    StreamDecoder();
+    ~StreamDecoder();
+    
+    StreamDecoder(const StreamDecoder&) = delete;
+    StreamDecoder& operator=(const StreamDecoder&) = delete;
+    
+    bool open(const std::string& path);
+    void close();
+    bool isOpen() const { return handle != nullptr; }
+    
+    // Decode up to `frames` interleaved frames, fewer only at the end of the file
+    int read(float* interleaved, int frames);
+    
+    // Go back to the first frame
+    bool rewind();
+    
+    int getChannels() const { return channels; }
+    int getSampleRate() const { return sampleRate; }
+};
@@ -0,0 +1,447 @@
+#include "audioStream.hpp"
+#include <cmath>
+#include "config.hpp"
+#include "dr_wav.h"
+
+// Convert `frames` little-endian samples of `bytes` bytes, `stride` bytes apart, to float
+static void convertSamples(const Uint8* in, int stride, int bytes, bool isFloat, float* out, int frames) {
+    switch (bytes) {
+        case 1:
+            for (int i = 0; i < frames; i++, in += stride) {
+                out[i] = (static_cast<int>(in[0]) - 128) * (1.0f / 128.0f);
+            }
+            break;
+        case 2:
+            for (int i = 0; i < frames; i++, in += stride) {
+                out[i] = static_cast<Sint16>(in[0] | (in[1] << 8)) * (1.0f / 32768.0f);
+            }
+            break;
+        case 3:
+            for (int i = 0; i < frames; i++, in += stride) {
+                const Sint32 value = static_cast<Sint32>((static_cast<Uint32>(in[0]) << 8) |
+                                                         (static_cast<Uint32>(in[1]) << 16) |
+                                                         (static_cast<Uint32>(in[2]) << 24)) >> 8;
+                out[i] = value * (1.0f / 8388608.0f);
+            }
+            break;
+        case 4:
+            for (int i = 0; i < frames; i++, in += stride) {
+                Uint32 bits;
+                SDL_memcpy(&bits, in, sizeof(bits));
+                bits = SDL_Swap32LE(bits);
+                if (isFloat) {
+                    SDL_memcpy(&out[i], &bits, sizeof(float));
+                } else {
+                    out[i] = static_cast<Sint32>(bits) * (1.0f / 2147483648.0f);
+                }
+            }
+            break;
+    }
+}
+
+AudioStream::AudioStream()
+    : source(StreamSource::Mapped), channels(0), fileChannels(0), sampleRate(0), increment(0), totalFrames(0),
+      kernels(getDspKernels()), pcm(nullptr), bytesPerSample(0), bytesPerFrame(0), floatSamples(false),
+      headFrames(0), readAheadFrames(0), residentStart(0), residentEnd(0), ring(STREAM_RING_CHUNKS),
+      requestedGeneration(0), decoderDone(false), producedGeneration(0), cursor(0), looping(false), playing(false),
+      underrunCount(0), chunkOffset(0), generation(0), consumed(false), ended(false), readFrame(0), windowFrames(1),
+      validFrames(1), fraction(0) {
+    chunk.count = 0;
+    chunk.last = false;
+    SDL_memset(window, 0, sizeof(window));
+    SDL_memset(gains, 0, sizeof(gains));
+    
+    // Gains carry the level, so the pan kernel multiplies by one
+    for (int i = 0; i < MIX_BLOCK_FRAMES; i++) {
+        levels[i] = 1.0f;
+    }
+}
+
+bool AudioStream::open(const std::string& filename) {
+    path = filename;
+    if (!openMapped() && !openDecoded()) {
+        SDL_Log("Failed to open stream: %s", path.c_str());
+        return false;
+    }
+    
+    if (sampleRate > AUDIO_SAMPLE_RATE * STREAM_MAX_RATE) {
+        SDL_Log("Stream %s runs at %d Hz, over %d times the output rate", path.c_str(), sampleRate, STREAM_MAX_RATE);
+        file.close();
+        decoder.close();
+        return false;
+    }
+    channels = SDL_min(fileChannels, STREAM_MAX_CHANNELS);
+    increment = static_cast<Uint32>(std::llround(static_cast<double>(sampleRate) / AUDIO_SAMPLE_RATE *
+                                                 (1 << SAMPLE_FRACTION_BITS)));
+    
+    // Nothing else services the stream yet, so the first read-ahead happens here
+    service();
+    return true;
+}
+
+bool AudioStream::openMapped() {
+    if (!file.open(path) || file.getSize() == 0) {
+        file.close();
+        return false;
+    }
+    
+    // dr_wav only parses the header here; the data chunk is never copied
+    drwav wav;
+    if (!drwav_init_memory(&wav, file.getData(), file.getSize(), nullptr)) {
+        file.close();
+        return false;
+    }
+    const int bits = wav.bitsPerSample;
+    const bool integer = wav.translatedFormatTag == DR_WAVE_FORMAT_PCM && (bits == 8 || bits == 16 || bits == 24 ||
+                                                                           bits == 32);
+    const bool isFloat = wav.translatedFormatTag == DR_WAVE_FORMAT_IEEE_FLOAT && bits == 32;
+    const Uint64 frames = wav.totalPCMFrameCount;
+    const Uint64 dataPos = wav.dataChunkDataPos;
+    const int blockAlign = wav.fmt.blockAlign;
+    fileChannels = wav.channels;
+    sampleRate = static_cast<int>(wav.sampleRate);
+    drwav_uninit(&wav);
+    
+    // Compressed WAVs (ADPCM and the like) are decoded instead
+    if ((!integer && !isFloat) || fileChannels <= 0 || sampleRate <= 0 || blockAlign != fileChannels * bits / 8 ||
+        dataPos + frames * blockAlign > file.getSize()) {
+        file.close();
+        return false;
+    }
+    
+    source = StreamSource::Mapped;
+    pcm = file.getData() + dataPos;
+    totalFrames = frames;
+    bytesPerSample = bits / 8;
+    bytesPerFrame = blockAlign;
+    floatSamples = isFloat;
+    headFrames = SDL_min(totalFrames, static_cast<Uint64>(sampleRate) * STREAM_HEAD_MS / 1000);
+    readAheadFrames = static_cast<Uint64>(sampleRate) * STREAM_READAHEAD_MS / 1000;
+    residentStart.store(headFrames, std::memory_order_relaxed);
+    residentEnd.store(headFrames, std::memory_order_relaxed);
+    return true;
+}
+
+bool AudioStream::openDecoded() {
+    if (!decoder.open(path)) {
+        return false;
+    }
+    
+    source = StreamSource::Decoded;
+    fileChannels = decoder.getChannels();
+    sampleRate = decoder.getSampleRate();
+    decodeBuffer.resize(static_cast<size_t>(STREAM_CHUNK_FRAMES) * fileChannels);
+    return true;
+}
+
+void AudioStream::start(float gain, float azimuth, const SpeakerLayout& layout) {
+    // A stream that hasn't played yet starts on what open buffered; a replay asks the
+    // streaming thread to decode from the top again and skips the chunks already queued
+    if (consumed && source == StreamSource::Decoded) {
+        generation++;
+        requestedGeneration.store(generation, std::memory_order_release);
+    }
+    chunk.count = 0;
+    chunk.last = false;
+    chunkOffset = 0;
+    consumed = false;
+    ended = false;
+    readFrame = 0;
+    cursor.store(0, std::memory_order_relaxed);
+    
+    // One silent frame before the first, for the interpolation taps
+    for (int c = 0; c < STREAM_MAX_CHANNELS; c++) {
+        window[c][0] = 0.0f;
+    }
+    windowFrames = 1;
+    validFrames = 1;
+    fraction = 0;
+    
+    // Stereo files sit either side of the azimuth, like a pair of speakers
+    if (channels == 1) {
+        layout.computeGains(azimuth, gains[0]);
+    } else {
+        layout.computeGains(azimuth - STREAM_STEREO_SPREAD, gains[0]);
+        layout.computeGains(azimuth + STREAM_STEREO_SPREAD, gains[1]);
+    }
+    for (int c = 0; c < channels; c++) {
+        for (int out = 0; out < layout.channels; out++) {
+            gains[c][out] *= gain;
+        }
+    }
+    playing.store(true, std::memory_order_relaxed);
+}
+
+void AudioStream::stop() {
+    playing.store(false, std::memory_order_relaxed);
+}
+
+int AudioStream::read(int offset, int frames) {
+    const int got = source == StreamSource::Mapped ? readMapped(offset, frames) : readDecoded(offset, frames);
+    if (got > 0) {
+        consumed = true;
+    }
+    cursor.store(readFrame, std::memory_order_relaxed);
+    return got;
+}
+
+int AudioStream::readMapped(int offset, int frames) {
+    int done = 0;
+    while (done < frames) {
+        if (readFrame >= totalFrames) {
+            if (!looping.load(std::memory_order_relaxed) || totalFrames == 0) {
+                ended = true;
+                break;
+            }
+            readFrame = 0;
+        }
+        
+        // Only pages the streaming thread has already brought in are touched
+        Uint64 limit = headFrames;
+        if (readFrame >= headFrames) {
+            const Uint64 start = residentStart.load(std::memory_order_acquire);
+            limit = readFrame >= start ? residentEnd.load(std::memory_order_acquire) : readFrame;
+        }
+        limit = SDL_min(limit, totalFrames);
+        if (limit <= readFrame) {
+            break;
+        }
+        
+        const int run = static_cast<int>(SDL_min(static_cast<Uint64>(frames - done), limit - readFrame));
+        const Uint8* frame = pcm + readFrame * bytesPerFrame;
+        for (int c = 0; c < channels; c++) {
+            convertSamples(frame + c * bytesPerSample, bytesPerFrame, bytesPerSample, floatSamples,
+                           window[c] + offset + done, run);
+        }
+        readFrame += run;
+        done += run;
+    }
+    return done;
+}
+
+int AudioStream::readDecoded(int offset, int frames) {
+    int done = 0;
+    while (done < frames) {
+        if (chunkOffset >= chunk.count) {
+            if (chunk.last) {
+                ended = true;
+                break;
+            }
+            if (!ring.pop(chunk)) {
+                chunk.count = 0;
+                break;
+            }
+            chunkOffset = 0;
+            
+            // Left over from before a restart
+            if (chunk.generation != generation) {
+                chunk.count = 0;
+                chunk.last = false;
+            }
+            continue;
+        }
+        
+        const int run = SDL_min(frames - done, chunk.count - chunkOffset);
+        for (int c = 0; c < channels; c++) {
+            SDL_memcpy(window[c] + offset + done, chunk.frames + c * STREAM_CHUNK_FRAMES + chunkOffset,
+                       run * sizeof(float));
+        }
+        chunkOffset += run;
+        readFrame += run;
+        done += run;
+    }
+    return done;
+}
+
+bool AudioStream::render(float* bus, const SpeakerLayout& layout, int frames) {
+    // File frames the block's interpolation taps reach, from the one before the position
+    const int needed = static_cast<int>((fraction + static_cast<Uint64>(increment) * (frames - 1)) >>
+                                        SAMPLE_FRACTION_BITS) + 4;
+    if (windowFrames < needed) {
+        const int wanted = needed - windowFrames;
+        const int got = ended ? 0 : read(windowFrames, wanted);
+        
+        // A replay waits for its first frames rather than play a gap
+        if (!consumed && !ended) {
+            return true;
+        }
+        
+        // Frames the disk hasn't delivered play as silence; the stream doesn't wait for them
+        if (got < wanted) {
+            if (!ended) {
+                underrunCount.fetch_add(1, std::memory_order_relaxed);
+            }
+            for (int c = 0; c < channels; c++) {
+                SDL_memset(window[c] + windowFrames + got, 0, (wanted - got) * sizeof(float));
+            }
+        }
+        validFrames = ended ? validFrames + got : needed;
+        windowFrames = needed;
+    }
+    
+    static const float steady[MAX_OUTPUT_CHANNELS] = {};
+    for (int c = 0; c < channels; c++) {
+        kernels.renderSample(window[c] + 1, fraction, increment, rendered, frames, Interpolation::Cubic);
+        kernels.panMultiplyAdd(bus, MIX_BLOCK_FRAMES, layout.channels, rendered, levels, gains[c], steady, frames);
+    }
+    
+    // Drop the frames the position moved past
+    const Uint64 position = fraction + static_cast<Uint64>(increment) * frames;
+    const int advance = static_cast<int>(position >> SAMPLE_FRACTION_BITS);
+    fraction = static_cast<Uint32>(position & SAMPLE_FRACTION_MASK);
+    windowFrames -= advance;
+    validFrames = SDL_max(validFrames - advance, 0);
+    for (int c = 0; c < channels; c++) {
+        SDL_memmove(window[c], window[c] + advance, windowFrames * sizeof(float));
+    }
+    
+    // Played out once the position is past the last frame of the file
+    if (ended && validFrames <= 1) {
+        playing.store(false, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+void AudioStream::service() {
+    if (source == StreamSource::Mapped) {
+        serviceMapped();
+    } else {
+        serviceDecoded();
+    }
+}
+
+void AudioStream::releaseFrames(Uint64 from, Uint64 to) {
+    // The page the range starts in goes too, since the frames before `from` were released
+    // already; the page the head ends in stays
+    const size_t dataOffset = static_cast<size_t>(pcm - file.getData());
+    const size_t page = MappedFile::getPageSize();
+    size_t start = dataOffset + from * bytesPerFrame;
+    start = SDL_max(start / page * page, dataOffset + headFrames * bytesPerFrame);
+    const size_t end = dataOffset + to * bytesPerFrame;
+    if (end > start) {
+        file.release(start, end - start);
+    }
+}
+
+void AudioStream::serviceMapped() {
+    const size_t dataOffset = static_cast<size_t>(pcm - file.getData());
+    const Uint64 position = SDL_min(cursor.load(std::memory_order_relaxed), totalFrames);
+    Uint64 start = residentStart.load(std::memory_order_relaxed);
+    Uint64 end = residentEnd.load(std::memory_order_relaxed);
+    
+    // Back at the head after a restart or a loop: the old window goes and a new one grows from the head
+    if (position < start && start > headFrames) {
+        residentEnd.store(headFrames, std::memory_order_release);
+        residentStart.store(headFrames, std::memory_order_release);
+        releaseFrames(start, end);
+        start = end = headFrames;
+    }
+    
+    // Everything before the position has been read; it leaves the window before its pages go
+    if (position > start) {
+        residentStart.store(position, std::memory_order_release);
+        releaseFrames(start, position);
+        start = position;
+    }
+    
+    // The head and the window are touched every time, in case the OS reclaimed some of it
+    file.prefetch(dataOffset, headFrames * bytesPerFrame);
+    const Uint64 target = SDL_min(SDL_max(position, headFrames) + readAheadFrames, totalFrames);
+    if (target > start) {
+        file.prefetch(dataOffset + start * bytesPerFrame, (target - start) * bytesPerFrame);
+    }
+    if (target > end) {
+        residentEnd.store(target, std::memory_order_release);
+    }
+}
+
+void AudioStream::serviceDecoded() {
+    const Uint32 wanted = requestedGeneration.load(std::memory_order_acquire);
+    if (wanted != producedGeneration) {
+        decoder.rewind();
+        producedGeneration = wanted;
+        decoderDone = false;
+    }
+    
+    // Decode only while there's room, so a chunk is never decoded twice
+    while (!decoderDone && !ring.isFull()) {
+        StreamChunk next;
+        next.count = 0;
+        next.generation = producedGeneration;
+        next.last = false;
+        
+        bool rewound = false;
+        while (next.count < STREAM_CHUNK_FRAMES) {
+            const int got = decoder.read(decodeBuffer.data(), STREAM_CHUNK_FRAMES - next.count);
+            for (int c = 0; c < channels; c++) {
+                float* out = next.frames + c * STREAM_CHUNK_FRAMES + next.count;
+                for (int i = 0; i < got; i++) {
+                    out[i] = decodeBuffer[static_cast<size_t>(i) * fileChannels + c];
+                }
+            }
+            next.count += got;
+            
+            if (got > 0) {
+                rewound = false;
+            } else if (!rewound && looping.load(std::memory_order_relaxed) && decoder.rewind()) {
+                rewound = true;
+            } else {
+                next.last = true;
+                break;
+            }
+        }
+        
+        ring.push(next);
+        decoderDone = next.last;
+    }
+}
+
+AudioStreamer::AudioStreamer() : lock(SDL_CreateMutex()) {}
+
+AudioStreamer::~AudioStreamer() {
+    stop();
+    SDL_DestroyMutex(lock);
+}
+
+bool AudioStreamer::add(AudioStream* stream) {
+    SDL_LockMutex(lock);
+    streams.push_back(stream);
+    SDL_UnlockMutex(lock);
+    
+    if (worker) {
+        return true;
+    }
+    running.store(true, std::memory_order_relaxed);
+    worker = SDL_CreateThread(workerMain, "AudioStreamer", this);
+    if (!worker) {
+        SDL_Log("Failed to start audio streamer: %s", SDL_GetError());
+        running.store(false, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+void AudioStreamer::stop() {
+    if (!worker) {
+        return;
+    }
+    
+    running.store(false, std::memory_order_relaxed);
+    SDL_WaitThread(worker, nullptr);
+    worker = nullptr;
+}
+
+int SDLCALL AudioStreamer::workerMain(void* userdata) {
+    AudioStreamer* streamer = static_cast<AudioStreamer*>(userdata);
+    
+    while (streamer->running.load(std::memory_order_relaxed)) {
+        SDL_LockMutex(streamer->lock);
+        for (AudioStream* stream : streamer->streams) {
+            stream->service();
+        }
+        SDL_UnlockMutex(streamer->lock);
+        SDL_Delay(STREAM_SERVICE_MS);
+    }
+    return 0;
+}
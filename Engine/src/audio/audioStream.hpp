@@ -0,0 +1,157 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <atomic>
+#include <string>
+#include <vector>
+#include "audioDecoder.hpp"
+#include "speakerLayout.hpp"
+#include "spscQueue.hpp"
+#include "dsp/dspKernels.hpp"
+#include "../platform/mappedFile.hpp"
+
+// Where a stream's frames come from
+enum class StreamSource : Uint8 {
+    Mapped, // PCM WAV read in place from a memory mapping
+    Decoded // Anything else, decoded ahead on the streaming thread
+};
+
+// Decoded frames handed from the streaming thread to the audio thread
+struct StreamChunk {
+    float frames[STREAM_MAX_CHANNELS * STREAM_CHUNK_FRAMES]; // Planar, STREAM_CHUNK_FRAMES per channel
+    int count;         // Frames used
+    Uint32 generation; // Playback the chunk was decoded for; chunks of an earlier one are skipped
+    bool last;         // The file ends after this chunk
+};
+
+// One long audio file played straight from disk, never decoded whole, so memory stays flat
+// however long the file is. A PCM WAV is memory-mapped and the audio thread converts its
+// frames in place; anything else is decoded a few blocks ahead into a lock-free ring. Either
+// way the streaming thread does all the I/O: it pages the mapping in ahead of the play
+// position and drops it behind, or keeps the ring full. The audio thread only reads what is
+// already in memory, and plays silence (counted as an underrun) rather than wait for the disk.
+// A stream plays once at a time, resampled to the output rate and panned like a voice.
+class AudioStream {
+private:
+    std::string path;
+    StreamSource source;
+    int channels;          // Channels played, 1 or 2
+    int fileChannels;
+    int sampleRate;
+    Uint32 increment;      // File frames per output frame, SAMPLE_FRACTION_BITS fixed point
+    Uint64 totalFrames;    // Length of a mapped file (0 for decoded ones, which just end)
+    const DspKernels& kernels;
+    
+    // Mapped: the data chunk, read by the audio thread between the resident bounds
+    MappedFile file;
+    const Uint8* pcm;
+    int bytesPerSample;
+    int bytesPerFrame;
+    bool floatSamples;
+    Uint64 headFrames;                 // Frames at the start that stay resident
+    Uint64 readAheadFrames;
+    std::atomic<Uint64> residentStart; // Frames past the head the streaming thread has paged in
+    std::atomic<Uint64> residentEnd;
+    
+    // Decoded: chunks from the streaming thread to the audio thread
+    SpscQueue<StreamChunk> ring;
+    std::atomic<Uint32> requestedGeneration; // Bumped by the audio thread to restart the decoder
+    
+    // Streaming thread only
+    StreamDecoder decoder;
+    std::vector<float> decodeBuffer;  // One interleaved chunk
+    bool decoderDone;                 // The last chunk of producedGeneration is queued
+    Uint32 producedGeneration;
+    
+    // Shared
+    std::atomic<Uint64> cursor;   // Next file frame the audio thread reads
+    std::atomic<bool> looping;
+    std::atomic<bool> playing;
+    std::atomic<Uint64> underrunCount;
+    
+    // Audio thread only
+    StreamChunk chunk;           // Chunk being read
+    int chunkOffset;
+    Uint32 generation;
+    bool consumed;               // Frames were read since the last (re)start
+    bool ended;                  // The file ran out
+    Uint64 readFrame;            // Local copy of cursor
+    float window[STREAM_MAX_CHANNELS][STREAM_WINDOW_FRAMES]; // File frames around the play position
+    int windowFrames;
+    int validFrames;             // Frames of window that hold audio rather than padding after the end
+    Uint32 fraction;             // Play position between window[1] and window[2], fixed point
+    float gains[STREAM_MAX_CHANNELS][MAX_OUTPUT_CHANNELS];
+    float rendered[MIX_BLOCK_FRAMES];
+    float levels[MIX_BLOCK_FRAMES];
+    
+    bool openMapped();
+    bool openDecoded();
+    
+    // Audio thread: append up to `frames` file frames to each window channel at `offset`.
+    // Returns how many were in memory
+    int read(int offset, int frames);
+    int readMapped(int offset, int frames);
+    int readDecoded(int offset, int frames);
+    
+    // Streaming thread: drop the pages of frames [from, to), short of the head
+    void releaseFrames(Uint64 from, Uint64 to);
+    void serviceMapped();
+    void serviceDecoded();
+
+public:
+    AudioStream();
+    
+    AudioStream(const AudioStream&) = delete;
+    AudioStream& operator=(const AudioStream&) = delete;
+    
+    // Open a file to stream and page in (or decode) its first moments, so playing it is instant.
+    // Fails for files that can't be read or run over STREAM_MAX_RATE times the output rate
+    bool open(const std::string& filename);
+    
+    // Audio thread: play from the first frame, at azimuth (degrees, positive to the right)
+    void start(float gain, float azimuth, const SpeakerLayout& layout);
+    void stop();
+    
+    // Audio thread: add the next block to a planar bus of layout.channels channels.
+    // Returns false (and stops) once the file has played out
+    bool render(float* bus, const SpeakerLayout& layout, int frames);
+    
+    // Streaming thread: page in or decode whatever the audio thread will need next
+    void service();
+    
+    // Any thread
+    void setLooping(bool loop) { looping.store(loop, std::memory_order_relaxed); }
+    bool isPlaying() const { return playing.load(std::memory_order_relaxed); }
+    
+    // Blocks that wanted frames the disk hadn't delivered yet
+    Uint64 getUnderrunCount() const { return underrunCount.load(std::memory_order_relaxed); }
+    
+    StreamSource getSource() const { return source; }
+    const std::string& getPath() const { return path; }
+    int getSampleRate() const { return sampleRate; }
+    int getChannels() const { return channels; }
+};
+
+// The thread that does every stream's disk reads and decoding, every STREAM_SERVICE_MS
+class AudioStreamer {
+private:
+    std::vector<AudioStream*> streams; // Guarded by lock
+    SDL_Mutex* lock;
+    SDL_Thread* worker = nullptr;
+    std::atomic<bool> running{false};
+    
+    static int SDLCALL workerMain(void* userdata);
+
+public:
+    AudioStreamer();
+    ~AudioStreamer();
+    
+    AudioStreamer(const AudioStreamer&) = delete;
+    AudioStreamer& operator=(const AudioStreamer&) = delete;
+    
+    // Service a stream until the streamer stops; starts the thread with the first one.
+    // The stream must outlive the streamer
+    bool add(AudioStream* stream);
+    
+    void stop();
+};
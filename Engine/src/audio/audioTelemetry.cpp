@@ -0,0 +1,127 @@
+#include "audioTelemetry.hpp"
+#include <algorithm>
+
+// Only the audio thread writes the counters, so a plain load and store is enough
+static void add(std::atomic<Uint64>& counter, Uint64 value) {
+    counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+}
+
+template <typename T>
+static void raiseMax(std::atomic<T>& maximum, T value) {
+    if (value > maximum.load(std::memory_order_relaxed)) {
+        maximum.store(value, std::memory_order_relaxed);
+    }
+}
+
+void AudioTelemetry::recordCallback(Uint64 startNS, Uint64 endNS, int frames, int queued, int playingVoices) {
+    const Uint64 durationNS = endNS - startNS;
+    const Uint64 deadlineNS = static_cast<Uint64>(frames) * SDL_NS_PER_SECOND / AUDIO_SAMPLE_RATE;
+    
+    // Late past what the last callback left in the stream: the device ran dry in between
+    if (lastStartNS != 0 && startNS - lastStartNS > suppliedNS + suppliedNS * AUDIO_UNDERRUN_SLACK_PERCENT / 100) {
+        add(underruns, 1);
+    }
+    lastStartNS = startNS;
+    suppliedNS = static_cast<Uint64>(queued / bytesPerFrame + frames) * SDL_NS_PER_SECOND / AUDIO_SAMPLE_RATE;
+    
+    int bucket = AUDIO_TELEMETRY_BUCKETS - 1;
+    if (durationNS <= deadlineNS) {
+        bucket = std::min(static_cast<int>(durationNS * 10 / deadlineNS), AUDIO_TELEMETRY_BUCKETS - 2);
+    } else {
+        add(deadlineMisses, 1);
+    }
+    add(durationHistogram[bucket], 1);
+    
+    add(callbacks, 1);
+    add(framesMixed, frames);
+    add(totalDurationNS, durationNS);
+    raiseMax(maxDurationNS, durationNS);
+    add(totalDeadlineNS, deadlineNS);
+    add(totalQueuedBytes, queued);
+    queuedBytes.store(queued, std::memory_order_relaxed);
+    raiseMax(maxQueuedBytes, queued);
+    add(totalVoices, playingVoices);
+    voices.store(playingVoices, std::memory_order_relaxed);
+    raiseMax(maxVoices, playingVoices);
+}
+
+AudioTelemetrySnapshot AudioTelemetry::getSnapshot() const {
+    AudioTelemetrySnapshot snapshot;
+    snapshot.callbacks = callbacks.load(std::memory_order_relaxed);
+    snapshot.framesMixed = framesMixed.load(std::memory_order_relaxed);
+    snapshot.deadlineMisses = deadlineMisses.load(std::memory_order_relaxed);
+    snapshot.underruns = underruns.load(std::memory_order_relaxed);
+    for (int i = 0; i < AUDIO_TELEMETRY_BUCKETS; i++) {
+        snapshot.durationHistogram[i] = durationHistogram[i].load(std::memory_order_relaxed);
+    }
+    snapshot.totalDurationNS = totalDurationNS.load(std::memory_order_relaxed);
+    snapshot.maxDurationNS = maxDurationNS.load(std::memory_order_relaxed);
+    snapshot.totalDeadlineNS = totalDeadlineNS.load(std::memory_order_relaxed);
+    snapshot.totalQueuedBytes = totalQueuedBytes.load(std::memory_order_relaxed);
+    snapshot.queuedBytes = queuedBytes.load(std::memory_order_relaxed);
+    snapshot.maxQueuedBytes = maxQueuedBytes.load(std::memory_order_relaxed);
+    snapshot.totalVoices = totalVoices.load(std::memory_order_relaxed);
+    snapshot.voices = voices.load(std::memory_order_relaxed);
+    snapshot.maxVoices = maxVoices.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+void AudioTelemetry::checkThresholds() {
+    const Uint64 nowNS = SDL_GetTicksNS();
+    if (reportedNS != 0 && nowNS - reportedNS < SDL_MS_TO_NS(AUDIO_TELEMETRY_REPORT_MS)) {
+        return;
+    }
+    reportedNS = nowNS;
+    
+    const AudioTelemetrySnapshot current = getSnapshot();
+    
+    if (current.underruns > reported.underruns) {
+        SDL_Log("Audio underruns: %llu in the last %d ms (%llu total)",
+                static_cast<unsigned long long>(current.underruns - reported.underruns), AUDIO_TELEMETRY_REPORT_MS,
+                static_cast<unsigned long long>(current.underruns));
+    }
+    if (current.deadlineMisses > reported.deadlineMisses) {
+        SDL_Log("Audio callbacks over their deadline: %llu in the last %d ms (%llu total)",
+                static_cast<unsigned long long>(current.deadlineMisses - reported.deadlineMisses),
+                AUDIO_TELEMETRY_REPORT_MS, static_cast<unsigned long long>(current.deadlineMisses));
+    }
+    
+    // Callbacks that made it, but with little to spare
+    Uint64 slow = 0;
+    for (int i = AUDIO_TELEMETRY_LOAD_WARN / 10; i < AUDIO_TELEMETRY_BUCKETS - 1; i++) {
+        slow += current.durationHistogram[i] - reported.durationHistogram[i];
+    }
+    if (slow > 0) {
+        SDL_Log("Audio callbacks over %d%% of their deadline: %llu in the last %d ms", AUDIO_TELEMETRY_LOAD_WARN,
+                static_cast<unsigned long long>(slow), AUDIO_TELEMETRY_REPORT_MS);
+    }
+    
+    reported = current;
+}
+
+void AudioTelemetry::logSummary() const {
+    const AudioTelemetrySnapshot s = getSnapshot();
+    if (s.callbacks == 0) {
+        SDL_Log("Audio telemetry: no callbacks ran");
+        return;
+    }
+    
+    const double callbacks = static_cast<double>(s.callbacks);
+    SDL_Log("Audio telemetry: %llu callbacks, %.1f s mixed", static_cast<unsigned long long>(s.callbacks),
+            static_cast<double>(s.framesMixed) / AUDIO_SAMPLE_RATE);
+    SDL_Log("  callback time: avg %.1f us, max %.1f us, avg deadline %.1f us (%.1f%% load)",
+            s.totalDurationNS / callbacks / 1000.0, s.maxDurationNS / 1000.0, s.totalDeadlineNS / callbacks / 1000.0,
+            100.0 * s.totalDurationNS / static_cast<double>(s.totalDeadlineNS));
+    SDL_Log("  deadline misses: %llu, underruns: %llu", static_cast<unsigned long long>(s.deadlineMisses),
+            static_cast<unsigned long long>(s.underruns));
+    SDL_Log("  queued bytes: last %d, avg %.0f, max %d", s.queuedBytes, s.totalQueuedBytes / callbacks,
+            s.maxQueuedBytes);
+    SDL_Log("  voices per callback: last %d, avg %.1f, max %d", s.voices, s.totalVoices / callbacks, s.maxVoices);
+    
+    for (int i = 0; i < AUDIO_TELEMETRY_BUCKETS - 1; i++) {
+        SDL_Log("  %3d-%3d%% of deadline: %llu", i * 10, (i + 1) * 10,
+                static_cast<unsigned long long>(s.durationHistogram[i]));
+    }
+    SDL_Log("     >100%% of deadline: %llu",
+            static_cast<unsigned long long>(s.durationHistogram[AUDIO_TELEMETRY_BUCKETS - 1]));
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <atomic>
+#include "config.hpp"
+
+// Health figures of the output path since the stream was opened
+struct AudioTelemetrySnapshot {
+    Uint64 callbacks;      // Callbacks that mixed something
+    Uint64 framesMixed;
+    Uint64 deadlineMisses; // Callbacks that took longer than the audio they mixed lasts
+    Uint64 underruns;      // Callbacks that came after the audio supplied before had run out
+    Uint64 durationHistogram[AUDIO_TELEMETRY_BUCKETS]; // Callback time / deadline, 10% per bucket, last = over
+    Uint64 totalDurationNS;
+    Uint64 maxDurationNS;
+    Uint64 totalDeadlineNS;
+    Uint64 totalQueuedBytes; // SDL_GetAudioStreamQueued at each callback start, summed
+    int queuedBytes;         // ... at the start of the last callback
+    int maxQueuedBytes;
+    Uint64 totalVoices;      // Playing voices per callback (the most in any of its blocks), summed
+    int voices;              // ... in the last callback
+    int maxVoices;
+};
+
+// Callback health telemetry. The audio thread records every callback into atomics it alone
+// writes, so recording never blocks; any thread can read them. A snapshot reads the fields
+// one by one and may straddle a callback, which is fine for monitoring.
+// SDL does not report device underruns, so a callback arriving later than the audio queued
+// before it could last (plus AUDIO_UNDERRUN_SLACK_PERCENT) is counted as one.
+class AudioTelemetry {
+private:
+    std::atomic<Uint64> callbacks{0};
+    std::atomic<Uint64> framesMixed{0};
+    std::atomic<Uint64> deadlineMisses{0};
+    std::atomic<Uint64> underruns{0};
+    std::atomic<Uint64> durationHistogram[AUDIO_TELEMETRY_BUCKETS] = {};
+    std::atomic<Uint64> totalDurationNS{0};
+    std::atomic<Uint64> maxDurationNS{0};
+    std::atomic<Uint64> totalDeadlineNS{0};
+    std::atomic<Uint64> totalQueuedBytes{0};
+    std::atomic<int> queuedBytes{0};
+    std::atomic<int> maxQueuedBytes{0};
+    std::atomic<Uint64> totalVoices{0};
+    std::atomic<int> voices{0};
+    std::atomic<int> maxVoices{0};
+    
+    int bytesPerFrame; // Of the output stream, to turn queued bytes into time
+    
+    // Audio thread only
+    Uint64 lastStartNS = 0;  // Start of the previous recorded callback
+    Uint64 suppliedNS = 0;   // How long the audio queued by then lasts
+    
+    // UI thread only: figures at the last threshold check
+    AudioTelemetrySnapshot reported = {};
+    Uint64 reportedNS = 0;
+
+public:
+    explicit AudioTelemetry(int streamBytesPerFrame) : bytesPerFrame(streamBytesPerFrame) {}
+    
+    // Audio thread: a callback that started at startNS with `queued` bytes already in the
+    // stream mixed `frames` frames by endNS, with up to `playingVoices` voices playing
+    void recordCallback(Uint64 startNS, Uint64 endNS, int frames, int queued, int playingVoices);
+    
+    // Any thread
+    AudioTelemetrySnapshot getSnapshot() const;
+    
+    // UI thread: every AUDIO_TELEMETRY_REPORT_MS, log underruns, deadline misses and callbacks
+    // over AUDIO_TELEMETRY_LOAD_WARN percent of their deadline since the last check
+    void checkThresholds();
+    
+    // Log everything recorded so far (at exit)
+    void logSummary() const;
+};
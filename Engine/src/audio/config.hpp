@@ -4,19 +4,97 @@
 #define WINDOW_WIDTH 800
 #define WINDOW_HEIGHT 600
 #define WINDOW_TITLE "SDL Sound Test - Async Audio Demo"
+#define VIDEO_SETTINGS_FILE "video_settings.txt"  // vsync, maxFPS and idleFPS, read from RESOURCES_PATH
+#define IDLE_AFTER_MS 250  // A scene still for this long with nothing playing drops to idleFPS
 
 // Audio settings
 #define AUDIO_SAMPLE_RATE 48000
-#define AUDIO_CHANNELS 4
+#define AUDIO_CHANNELS 4       // Channels asked of the device; the mixer pans into whatever layout it opens with
+#define MAX_OUTPUT_CHANNELS 6  // Widest layout the mixer pans into (5.1)
+#define RENDER_CHANNELS 2      // Layout of offline renders made without a device
+#define MIX_BLOCK_FRAMES 256  // Frames mixed per block in the audio callback
+
+// Oscillator settings
+#define WAVETABLE_BITS 11                    // log2 of the samples per wavetable cycle
+#define WAVETABLE_SIZE (1 << WAVETABLE_BITS)
+#define WAVETABLE_GUARD 3                    // Wrapped samples around each table (1 before, 2 after)
+#define DEFAULT_ATTACK_MS 10                 // Attack of sounds without an explicit envelope
+
+// Sampler settings
+#define SAMPLER_INSTRUMENT_FILE "instrument.txt" // Zones the piano keys play, read from RESOURCES_PATH (sines when missing)
+#define SAMPLE_ALIGNMENT 64                  // Bytes decoded samples are aligned to
+#define SAMPLE_GUARD_FRAMES 16               // Silent frames before and after each sample (one cache line), read by interpolation
+#define SAMPLE_FRACTION_BITS 16              // Fraction bits of a sample playback position
+#define SAMPLER_MAX_PITCH_RATIO 64.0         // Fastest a sample plays, including the sample rate conversion
+#define SAMPLER_DEFAULT_VELOCITY 100         // Velocity of sampled sounds without one (1-127)
+#define SAMPLE_DECODE_THREADS 0              // Threads decoding an instrument's files, 0 = one per logical core
+
+// Streaming (long files played without decoding them whole)
+#define STREAM_CAPACITY 16           // Streams that can play at once
+#define STREAM_MAX_CHANNELS 2        // Stereo files play as two sources either side of the stream; later channels are dropped
+#define STREAM_STEREO_SPREAD 30.0f   // Degrees each side of a stereo stream's azimuth its channels sit at
+#define STREAM_MAX_RATE 4            // Highest file rate a stream plays, as a multiple of the output rate
+#define STREAM_WINDOW_FRAMES (MIX_BLOCK_FRAMES * STREAM_MAX_RATE + 8) // File frames one block can read, with interpolation taps
+#define STREAM_CHUNK_FRAMES 256      // Frames per decoded chunk handed to the audio thread
+#define STREAM_RING_CHUNKS 16        // Decoded chunks queued ahead of the callback (~85 ms at 48 kHz)
+#define STREAM_READAHEAD_MS 500      // Mapped WAV audio paged in ahead of the play position
+#define STREAM_HEAD_MS 250           // Mapped WAV audio kept paged in at the start, so (re)starts and loops never wait
+#define STREAM_SERVICE_MS 5          // The streaming thread tops every stream up this often
+#define STREAM_BACKING_FILE "backing_track.wav" // Looped by NumPad . when it's in RESOURCES_PATH
+#define STREAM_BACKING_GAIN 0.5f
 
 // Visualization settings
-#define MAX_VISIBLE_BARS 100
 #define GRID_LINES 10
 #define STATUS_BOX_HEIGHT 30
 #define STATUS_BOX_WIDTH 200
+#define FRAME_PROFILER_WINDOW 240  // Frames kept for the profiler overlay's min/avg/p99 (development builds)
+
+// Spectrum analyzer (visualizer)
+#define SPECTRUM_FFT_SIZE 4096        // Samples per analysis, a power of two in 1024-8192 (~85 ms)
+#define SPECTRUM_BANDS 96             // Log-spaced bars drawn by the visualizer
+#define SPECTRUM_MIN_HZ 30.0f
+#define SPECTRUM_MAX_HZ 16000.0f
+#define SPECTRUM_FLOOR_DB -72.0f      // Level drawn as an empty bar; 0 dB (full scale) fills it
+#define SPECTRUM_UPDATE_MS 16         // The analyzer worker runs this often (~60 per second)
+#define SPECTRUM_RELEASE_MS 120       // Bars fall with this time constant (they rise at once)
+#define SPECTRUM_PEAK_HOLD_MS 600     // Peak markers stay put this long
+#define SPECTRUM_PEAK_FALL_PER_S 0.5f // and then fall this share of the full height per second
+#define SPECTRUM_TAP_BLOCKS 64        // Mixed blocks in flight from the audio thread to the analyzer
+#define SPECTRUM_SILENT_LEVEL 1e-4f   // Bands that fall below this are zero
 
 // Mixer settings
-#define DEFAULT_DELAY_MS 100  // Default delay value
+#define DEFAULT_DELAY_MS 100  // Default held-key retrigger interval
 #define MIN_DELAY_MS 10       // Minimum allowed delay
 #define MAX_DELAY_MS 500      // Maximum allowed delay
-#define DELAY_STEP_MS 10      // Step size for delay adjustment
\ No newline at end of file
+#define DELAY_STEP_MS 10      // Step size for delay adjustment
+#define VOICE_POOL_CAPACITY 256  // Voices allocated once at startup
+#define VOICE_STEAL_FADE_MS 5    // Anti-click fade for stolen voices
+#define REPEATER_CAPACITY 64     // Keys that can retrigger at once while held
+#define PLAYBACK_LOOKAHEAD_MS 50 // Recorded events are scheduled this far ahead of the audio clock
+#define RENDER_TAIL_LIMIT_MS 60000 // Offline renders stop this long after the last event even if notes still ring
+#define RENDER_CHUNK_FRAMES (MIX_BLOCK_FRAMES * 1024) // Offline renders are cut into chunks of this many frames (~5.5 s)
+#define RENDER_CHUNKS_PER_THREAD 2 // Chunks in flight per render worker
+#define RECORDING_EXTENSION ".srec"   // Recordings saved with this extension use the binary format
+#define RECORDING_JOURNAL_FILE "recording-%u.journal" // In SDL_GetPrefPath, recovered on the next start if a session crashed
+#define JOURNAL_FILE_COUNT 2          // Sessions alternate between this many journal files, so the last one is kept until loaded
+#define JOURNAL_QUEUE_CAPACITY 8192   // Recorded events waiting for the journal writer
+#define JOURNAL_FLUSH_MS 100          // Journal writer batches events this often
+#define JOURNAL_SYNC_MS 1000          // and flushes them to disk this often
+#define JOURNAL_NAME_MAX 64           // Longest sound name kept in the journal
+#define COMMAND_QUEUE_CAPACITY 1024      // UI -> audio commands in flight
+#define VOICE_EVENT_QUEUE_CAPACITY 4096  // Audio -> UI voice start/finish reports in flight
+
+// Multi-core mixing
+#define MIX_WORKER_THREADS -1          // Threads helping the audio callback mix, -1 = one per logical core beyond the first
+#define MIX_MAX_WORKER_THREADS 15
+#define MIX_PIN_WORKERS 1              // Pin worker k to logical core k + 1 where the OS allows it
+#define MIX_BATCH_VOICES 16            // Voices rendered per batch; batches are the unit workers claim and steal
+#define MIX_PARALLEL_MIN_VOICES 64     // Fewer active voices are mixed on the callback thread alone
+#define MIX_DETERMINISTIC 1            // Sum batches in a fixed order, so output never depends on thread timing or count
+#define MIX_WORKER_SPIN_US 500         // Workers spin this long for the next block before going to sleep
+
+// Audio telemetry
+#define AUDIO_TELEMETRY_BUCKETS 11        // Callback time histogram: 10% of the deadline per bucket, the last one is over it
+#define AUDIO_TELEMETRY_REPORT_MS 1000    // The UI thread checks the figures and logs breaches this often
+#define AUDIO_TELEMETRY_LOAD_WARN 80      // Callbacks over this percentage of their deadline are logged
+#define AUDIO_UNDERRUN_SLACK_PERCENT 50   // A callback this much later than the queued audio lasts counts as an underrun
\ No newline at end of file
@@ -0,0 +1,142 @@
+#include "dspKernels.hpp"
+#include <SDL3/SDL.h>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define DSP_X86 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#else
+#include <cpuid.h>
+#endif
+#endif
+
+// What each variant is compiled with, as the CPU and OS report it. The OS has to save the
+// ymm (and for AVX-512, opmask and zmm) registers across context switches too, or the
+// instructions exist but clobber each other between threads
+struct DspCpuFeatures {
+    bool avx2;   // AVX2, ymm state enabled
+    bool avx512; // AVX-512 F/VL/BW/DQ, ymm and zmm state enabled
+};
+
+#if DSP_X86
+static void readCpuid(unsigned leaf, unsigned subleaf, unsigned regs[4]) {
+#ifdef _MSC_VER
+    int values[4];
+    __cpuidex(values, static_cast<int>(leaf), static_cast<int>(subleaf));
+    for (int i = 0; i < 4; i++) {
+        regs[i] = static_cast<unsigned>(values[i]);
+    }
+#else
+    __cpuid_count(leaf, subleaf, regs[0], regs[1], regs[2], regs[3]);
+#endif
+}
+
+// XCR0, the register states the OS saves. Only valid once cpuid reports OSXSAVE
+static Uint64 readXcr0() {
+#ifdef _MSC_VER
+    return _xgetbv(0);
+#else
+    unsigned low, high;
+    __asm__ volatile("xgetbv" : "=a"(low), "=d"(high) : "c"(0));
+    return (static_cast<Uint64>(high) << 32) | low;
+#endif
+}
+#endif
+
+static DspCpuFeatures detectCpuFeatures() {
+    DspCpuFeatures features = {false, false};
+#if DSP_X86
+    unsigned regs[4];
+    readCpuid(0, 0, regs);
+    if (regs[0] < 7) {
+        return features;
+    }
+    
+    readCpuid(1, 0, regs);
+    const bool osxsave = (regs[2] >> 27) & 1;
+    const bool avx = (regs[2] >> 28) & 1;
+    if (!osxsave || !avx) {
+        return features;
+    }
+    
+    const Uint64 xcr0 = readXcr0();
+    const bool ymmState = (xcr0 & 0x06) == 0x06;   // SSE and AVX
+    const bool zmmState = (xcr0 & 0xE0) == 0xE0;   // Opmask, upper zmm0-15, zmm16-31
+    
+    readCpuid(7, 0, regs);
+    const bool avx2 = (regs[1] >> 5) & 1;
+    const bool avx512f = (regs[1] >> 16) & 1;
+    const bool avx512dq = (regs[1] >> 17) & 1;
+    const bool avx512bw = (regs[1] >> 30) & 1;
+    const bool avx512vl = (regs[1] >> 31) & 1;
+    
+    features.avx2 = ymmState && avx2;
+    features.avx512 = ymmState && zmmState && avx512f && avx512dq && avx512bw && avx512vl;
+#endif
+    return features;
+}
+
+bool isDspIsaSupported(DspIsa isa) {
+    static const DspCpuFeatures cpu = detectCpuFeatures();
+    switch (isa) {
+        case DspIsa::AVX512:
+            return getDspKernelsAVX512() != nullptr && cpu.avx512;
+        case DspIsa::AVX2:
+            return getDspKernelsAVX2() != nullptr && cpu.avx2;
+        case DspIsa::Scalar:
+        default:
+            return true;
+    }
+}
+
+static const DspKernels* getKernelsFor(DspIsa isa) {
+    switch (isa) {
+        case DspIsa::AVX512: return getDspKernelsAVX512();
+        case DspIsa::AVX2:   return getDspKernelsAVX2();
+        case DspIsa::Scalar:
+        default:             return getDspKernelsScalar();
+    }
+}
+
+static const DspKernels& selectDspKernels() {
+    DspIsa isa = DspIsa::Scalar;
+    if (isDspIsaSupported(DspIsa::AVX512)) {
+        isa = DspIsa::AVX512;
+    } else if (isDspIsaSupported(DspIsa::AVX2)) {
+        isa = DspIsa::AVX2;
+    }
+    
+    // Benchmarking override: GAMEENGINE_DSP_ISA=scalar|avx2|avx512
+    const char* forced = SDL_getenv("GAMEENGINE_DSP_ISA");
+    if (forced && *forced) {
+        DspIsa requested = isa;
+        bool known = true;
+        if (SDL_strcasecmp(forced, "scalar") == 0) {
+            requested = DspIsa::Scalar;
+        } else if (SDL_strcasecmp(forced, "avx2") == 0) {
+            requested = DspIsa::AVX2;
+        } else if (SDL_strcasecmp(forced, "avx512") == 0) {
+            requested = DspIsa::AVX512;
+        } else {
+            known = false;
+            SDL_Log("GAMEENGINE_DSP_ISA=%s not recognized (use scalar, avx2 or avx512)", forced);
+        }
+        
+        if (known) {
+            if (isDspIsaSupported(requested)) {
+                isa = requested;
+            } else {
+                SDL_Log("GAMEENGINE_DSP_ISA=%s is not supported on this CPU, ignoring", forced);
+            }
+        }
+    }
+    
+    const DspKernels* kernels = getKernelsFor(isa);
+    SDL_Log("DSP kernels: %s", kernels->name);
+    return *kernels;
+}
+
+const DspKernels& getDspKernels() {
+    static const DspKernels& kernels = selectDspKernels();
+    return kernels;
+}
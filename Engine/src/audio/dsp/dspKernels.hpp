@@ -0,0 +1,97 @@
+#pragma once
+
+#include <SDL3/SDL_stdinc.h>
+#include "../config.hpp"
+
+// Hot DSP loops, compiled once per instruction set (kernelsScalar.cpp,
+// kernelsAVX2.cpp, kernelsAVX512.cpp) and picked once at startup from the
+// CPU features. Set GAMEENGINE_DSP_ISA=scalar|avx2|avx512 to force a variant.
+// Keep this header free of templates and inline code: it is included by
+// translation units built with different -m flags.
+//
+// Every variant gives bit-identical output, so the machine (or the override) never changes
+// a render: the SIMD loops do the scalar loop's operations in the same order, never fused
+// into FMAs (the kernel files are built with contraction off).
+
+// Instruction set a kernel table was built for
+enum class DspIsa {
+    Scalar,
+    AVX2,
+    AVX512
+};
+
+// The top WAVETABLE_BITS of an oscillator phase pick the sample, the rest is the fraction
+#define PHASE_SHIFT (32 - WAVETABLE_BITS)
+#define PHASE_FRACTION_MASK ((1u << PHASE_SHIFT) - 1)
+#define PHASE_FRACTION_SCALE (1.0f / (1u << PHASE_SHIFT))
+
+// Sampler playback positions are fixed point: frame index above SAMPLE_FRACTION_BITS, fraction below
+#define SAMPLE_FRACTION_MASK ((1u << SAMPLE_FRACTION_BITS) - 1)
+#define SAMPLE_FRACTION_SCALE (1.0f / (1u << SAMPLE_FRACTION_BITS))
+
+// How to read between wavetable (and sample) frames
+enum class Interpolation {
+    Linear, // 2 taps
+    Cubic   // 4-tap Catmull-Rom
+};
+
+// Write `frames` samples of a wavetable oscillator starting at the 32-bit
+// fixed-point phase. table is a WavetableSet level (with guard samples); the
+// caller advances its own phase by phaseIncrement * frames afterwards.
+typedef void (*WavetableKernel)(const float* table, Uint32 phase, Uint32 phaseIncrement,
+                                float* out, int frames, Interpolation interpolation);
+
+// Write `frames` samples of a decoded sample played at a fractional rate. Output i reads
+// around frame (position + increment * i) >> SAMPLE_FRACTION_BITS of samples, which needs
+// one readable frame before and two after that (the sample pool's guard frames). The
+// caller keeps position below 1 << SAMPLE_FRACTION_BITS and the last offset below 2^32.
+typedef void (*SampleKernel)(const float* samples, Uint32 position, Uint32 increment,
+                             float* out, int frames, Interpolation interpolation);
+
+// out[i] += buses[0][i] + buses[1][i] + ..., added one bus at a time in order, so the
+// result is the same on every instruction set and for any split of the work
+typedef void (*SumBusesKernel)(float* out, const float* const* buses, int count, int frames);
+
+// Pan a mono product into a planar bus: channel c (at out + c * stride) gets
+// out[i] += a[i] * b[i] * (gains[c] + steps[c] * i). Silent channels are skipped
+typedef void (*PanMultiplyAddKernel)(float* out, int stride, int channels, const float* a, const float* b,
+                                     const float* gains, const float* steps, int frames);
+
+// Linear envelope segment: out[i] = start + step * i
+typedef void (*EnvelopeRampKernel)(float* out, int frames, float start, float step);
+
+// Exponential envelope segment: out[i] = target + distance * coef^i. The powers are built as
+// ENVELOPE_CURVE_LANES interleaved sequences, lane k from distance * coef^k stepping by
+// coef^ENVELOPE_CURVE_LANES, on every instruction set
+#define ENVELOPE_CURVE_LANES 8
+typedef void (*EnvelopeCurveKernel)(float* out, int frames, float target, float distance, float coef);
+
+struct DspKernels {
+    DspIsa isa;
+    const char* name;
+    WavetableKernel renderWavetable;
+    SampleKernel renderSample;
+    PanMultiplyAddKernel panMultiplyAdd;
+    EnvelopeRampKernel envelopeRamp;
+    EnvelopeCurveKernel envelopeCurve;
+    SumBusesKernel sumBuses;
+};
+
+// Per-ISA tables. Return nullptr when the variant wasn't compiled in.
+const DspKernels* getDspKernelsScalar();
+const DspKernels* getDspKernelsAVX2();
+const DspKernels* getDspKernelsAVX512();
+
+// Scalar wavetable loop, also used by the SIMD kernels for leftover frames
+void renderWavetableScalar(const float* table, Uint32 phase, Uint32 phaseIncrement,
+                           float* out, int frames, Interpolation interpolation);
+
+// Scalar sample loop, also used by the SIMD kernels for leftover frames
+void renderSampleScalar(const float* samples, Uint32 position, Uint32 increment,
+                        float* out, int frames, Interpolation interpolation);
+
+// Whether this CPU can run the given variant
+bool isDspIsaSupported(DspIsa isa);
+
+// The table selected for this machine (chosen on first call)
+const DspKernels& getDspKernels();
@@ -0,0 +1,231 @@
+#include "dspKernels.hpp"
+
+// Built with AVX2 code generation (see CMakeLists.txt); only called
+// after getDspKernels() confirmed the CPU supports it.
+#if defined(__AVX2__)
+#include <immintrin.h>
+
+static void renderWavetableAVX2(const float* table, Uint32 phase, Uint32 phaseIncrement,
+                                float* out, int frames, Interpolation interpolation) {
+    const __m256i laneOffsets = _mm256_mullo_epi32(_mm256_set1_epi32(static_cast<int>(phaseIncrement)),
+                                                   _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    const __m256i step = _mm256_set1_epi32(static_cast<int>(phaseIncrement * 8));
+    const __m256i fractionMask = _mm256_set1_epi32(PHASE_FRACTION_MASK);
+    const __m256 fractionScale = _mm256_set1_ps(PHASE_FRACTION_SCALE);
+    
+    // Wrapping 32-bit adds give the same phases as the scalar loop
+    __m256i phases = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(phase)), laneOffsets);
+    int i = 0;
+    
+    if (interpolation == Interpolation::Cubic) {
+        const __m256 half = _mm256_set1_ps(0.5f);
+        const __m256 oneAndHalf = _mm256_set1_ps(1.5f);
+        const __m256 two = _mm256_set1_ps(2.0f);
+        const __m256 twoAndHalf = _mm256_set1_ps(2.5f);
+        
+        for (; i + 8 <= frames; i += 8) {
+            const __m256i index = _mm256_srli_epi32(phases, PHASE_SHIFT);
+            const __m256 t = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(phases, fractionMask)), fractionScale);
+            
+            const __m256 x0 = _mm256_i32gather_ps(table, index, 4);
+            const __m256 x1 = _mm256_i32gather_ps(table + 1, index, 4);
+            const __m256 x2 = _mm256_i32gather_ps(table + 2, index, 4);
+            const __m256 x3 = _mm256_i32gather_ps(table + 3, index, 4);
+            
+            const __m256 c1 = _mm256_mul_ps(half, _mm256_sub_ps(x2, x0));
+            const __m256 c2 = _mm256_sub_ps(_mm256_add_ps(_mm256_sub_ps(x0, _mm256_mul_ps(twoAndHalf, x1)), _mm256_mul_ps(two, x2)), _mm256_mul_ps(half, x3));
+            const __m256 c3 = _mm256_add_ps(_mm256_mul_ps(half, _mm256_sub_ps(x3, x0)), _mm256_mul_ps(oneAndHalf, _mm256_sub_ps(x1, x2)));
+            
+            __m256 y = _mm256_add_ps(_mm256_mul_ps(c3, t), c2);
+            y = _mm256_add_ps(_mm256_mul_ps(y, t), c1);
+            y = _mm256_add_ps(_mm256_mul_ps(y, t), x1);
+            _mm256_storeu_ps(out + i, y);
+            
+            phases = _mm256_add_epi32(phases, step);
+        }
+    } else {
+        for (; i + 8 <= frames; i += 8) {
+            const __m256i index = _mm256_srli_epi32(phases, PHASE_SHIFT);
+            const __m256 t = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(phases, fractionMask)), fractionScale);
+            
+            const __m256 x1 = _mm256_i32gather_ps(table + 1, index, 4);
+            const __m256 x2 = _mm256_i32gather_ps(table + 2, index, 4);
+            _mm256_storeu_ps(out + i, _mm256_add_ps(x1, _mm256_mul_ps(_mm256_sub_ps(x2, x1), t)));
+            
+            phases = _mm256_add_epi32(phases, step);
+        }
+    }
+    
+    // Leftover frames
+    if (i < frames) {
+        renderWavetableScalar(table, phase + phaseIncrement * static_cast<Uint32>(i), phaseIncrement,
+                              out + i, frames - i, interpolation);
+    }
+}
+
+static void renderSampleAVX2(const float* samples, Uint32 position, Uint32 increment,
+                             float* out, int frames, Interpolation interpolation) {
+    const __m256i laneOffsets = _mm256_mullo_epi32(_mm256_set1_epi32(static_cast<int>(increment)),
+                                                   _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+    const __m256i step = _mm256_set1_epi32(static_cast<int>(increment * 8));
+    const __m256i fractionMask = _mm256_set1_epi32(SAMPLE_FRACTION_MASK);
+    const __m256 fractionScale = _mm256_set1_ps(SAMPLE_FRACTION_SCALE);
+    
+    __m256i positions = _mm256_add_epi32(_mm256_set1_epi32(static_cast<int>(position)), laneOffsets);
+    int i = 0;
+    
+    if (interpolation == Interpolation::Cubic) {
+        const __m256 half = _mm256_set1_ps(0.5f);
+        const __m256 oneAndHalf = _mm256_set1_ps(1.5f);
+        const __m256 two = _mm256_set1_ps(2.0f);
+        const __m256 twoAndHalf = _mm256_set1_ps(2.5f);
+        
+        for (; i + 8 <= frames; i += 8) {
+            const __m256i index = _mm256_srli_epi32(positions, SAMPLE_FRACTION_BITS);
+            const __m256 t = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(positions, fractionMask)), fractionScale);
+            
+            const __m256 x0 = _mm256_i32gather_ps(samples - 1, index, 4);
+            const __m256 x1 = _mm256_i32gather_ps(samples, index, 4);
+            const __m256 x2 = _mm256_i32gather_ps(samples + 1, index, 4);
+            const __m256 x3 = _mm256_i32gather_ps(samples + 2, index, 4);
+            
+            const __m256 c1 = _mm256_mul_ps(half, _mm256_sub_ps(x2, x0));
+            const __m256 c2 = _mm256_sub_ps(_mm256_add_ps(_mm256_sub_ps(x0, _mm256_mul_ps(twoAndHalf, x1)), _mm256_mul_ps(two, x2)), _mm256_mul_ps(half, x3));
+            const __m256 c3 = _mm256_add_ps(_mm256_mul_ps(half, _mm256_sub_ps(x3, x0)), _mm256_mul_ps(oneAndHalf, _mm256_sub_ps(x1, x2)));
+            
+            __m256 y = _mm256_add_ps(_mm256_mul_ps(c3, t), c2);
+            y = _mm256_add_ps(_mm256_mul_ps(y, t), c1);
+            y = _mm256_add_ps(_mm256_mul_ps(y, t), x1);
+            _mm256_storeu_ps(out + i, y);
+            
+            positions = _mm256_add_epi32(positions, step);
+        }
+    } else {
+        for (; i + 8 <= frames; i += 8) {
+            const __m256i index = _mm256_srli_epi32(positions, SAMPLE_FRACTION_BITS);
+            const __m256 t = _mm256_mul_ps(_mm256_cvtepi32_ps(_mm256_and_si256(positions, fractionMask)), fractionScale);
+            
+            const __m256 x0 = _mm256_i32gather_ps(samples, index, 4);
+            const __m256 x1 = _mm256_i32gather_ps(samples + 1, index, 4);
+            _mm256_storeu_ps(out + i, _mm256_add_ps(x0, _mm256_mul_ps(_mm256_sub_ps(x1, x0), t)));
+            
+            positions = _mm256_add_epi32(positions, step);
+        }
+    }
+    
+    // Leftover frames
+    if (i < frames) {
+        renderSampleScalar(samples, position + increment * static_cast<Uint32>(i), increment,
+                           out + i, frames - i, interpolation);
+    }
+}
+
+static void panMultiplyAddAVX2(float* out, int stride, int channels, const float* a, const float* b,
+                               const float* gains, const float* steps, int frames) {
+    // Only the channels the source reaches
+    int active[MAX_OUTPUT_CHANNELS];
+    int count = 0;
+    for (int c = 0; c < channels; c++) {
+        if (gains[c] != 0.0f || steps[c] != 0.0f) active[count++] = c;
+    }
+    
+    const __m256 laneIndex = _mm256_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f);
+    int i = 0;
+    for (; i + 8 <= frames; i += 8) {
+        const __m256 product = _mm256_mul_ps(_mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i));
+        const __m256 index = _mm256_add_ps(laneIndex, _mm256_set1_ps(static_cast<float>(i)));
+        for (int k = 0; k < count; k++) {
+            const int c = active[k];
+            float* channel = out + c * stride + i;
+            const __m256 gain = _mm256_add_ps(_mm256_set1_ps(gains[c]), _mm256_mul_ps(_mm256_set1_ps(steps[c]), index));
+            _mm256_storeu_ps(channel, _mm256_add_ps(_mm256_loadu_ps(channel), _mm256_mul_ps(product, gain)));
+        }
+    }
+    for (; i < frames; i++) {
+        const float product = a[i] * b[i];
+        for (int k = 0; k < count; k++) {
+            const int c = active[k];
+            out[c * stride + i] += product * (gains[c] + steps[c] * static_cast<float>(i));
+        }
+    }
+}
+
+static void envelopeRampAVX2(float* out, int frames, float start, float step) {
+    const __m256 startV = _mm256_set1_ps(start);
+    const __m256 stepV = _mm256_set1_ps(step);
+    const __m256 eight = _mm256_set1_ps(8.0f);
+    __m256 index = _mm256_setr_ps(0, 1, 2, 3, 4, 5, 6, 7);
+    
+    int i = 0;
+    for (; i + 8 <= frames; i += 8) {
+        _mm256_storeu_ps(out + i, _mm256_add_ps(startV, _mm256_mul_ps(stepV, index)));
+        index = _mm256_add_ps(index, eight);
+    }
+    for (; i < frames; i++) {
+        out[i] = start + step * static_cast<float>(i);
+    }
+}
+
+static void envelopeCurveAVX2(float* out, int frames, float target, float distance, float coef) {
+    // Lane k starts at distance * coef^k; every step multiplies all lanes by coef^8
+    float powers[ENVELOPE_CURVE_LANES];
+    float power = 1.0f;
+    for (int k = 0; k < ENVELOPE_CURVE_LANES; k++) {
+        powers[k] = distance * power;
+        power *= coef;
+    }
+    
+    const __m256 targetV = _mm256_set1_ps(target);
+    const __m256 stride = _mm256_set1_ps(power);
+    __m256 lanes = _mm256_loadu_ps(powers);
+    
+    int i = 0;
+    for (; i + ENVELOPE_CURVE_LANES <= frames; i += ENVELOPE_CURVE_LANES) {
+        _mm256_storeu_ps(out + i, _mm256_add_ps(targetV, lanes));
+        lanes = _mm256_mul_ps(lanes, stride);
+    }
+    
+    _mm256_storeu_ps(powers, lanes);
+    for (int k = 0; i < frames; i++, k++) {
+        out[i] = target + powers[k];
+    }
+}
+
+static void sumBusesAVX2(float* out, const float* const* buses, int count, int frames) {
+    int i = 0;
+    for (; i + 8 <= frames; i += 8) {
+        __m256 sum = _mm256_loadu_ps(out + i);
+        for (int b = 0; b < count; b++) {
+            sum = _mm256_add_ps(sum, _mm256_loadu_ps(buses[b] + i));
+        }
+        _mm256_storeu_ps(out + i, sum);
+    }
+    for (; i < frames; i++) {
+        float sum = out[i];
+        for (int b = 0; b < count; b++) {
+            sum += buses[b][i];
+        }
+        out[i] = sum;
+    }
+}
+
+const DspKernels* getDspKernelsAVX2() {
+    static const DspKernels kernels = {
+        DspIsa::AVX2, "AVX2",
+        renderWavetableAVX2,
+        renderSampleAVX2,
+        panMultiplyAddAVX2,
+        envelopeRampAVX2,
+        envelopeCurveAVX2,
+        sumBusesAVX2
+    };
+    return &kernels;
+}
+
+#else
+
+const DspKernels* getDspKernelsAVX2() {
+    return nullptr;
+}
+
+#endif
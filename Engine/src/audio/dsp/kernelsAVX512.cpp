@@ -0,0 +1,233 @@
+#include "dspKernels.hpp"
+
+// Built with AVX-512 code generation (see CMakeLists.txt); only called after
+// getDspKernels() confirmed the CPU supports it.
+#if defined(__AVX512F__)
+#include <immintrin.h>
+
+static void renderWavetableAVX512(const float* table, Uint32 phase, Uint32 phaseIncrement,
+                                  float* out, int frames, Interpolation interpolation) {
+    const __m512i laneOffsets = _mm512_mullo_epi32(_mm512_set1_epi32(static_cast<int>(phaseIncrement)),
+                                                   _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+    const __m512i step = _mm512_set1_epi32(static_cast<int>(phaseIncrement * 16));
+    const __m512i fractionMask = _mm512_set1_epi32(PHASE_FRACTION_MASK);
+    const __m512 fractionScale = _mm512_set1_ps(PHASE_FRACTION_SCALE);
+    
+    // Wrapping 32-bit adds give the same phases as the scalar loop
+    __m512i phases = _mm512_add_epi32(_mm512_set1_epi32(static_cast<int>(phase)), laneOffsets);
+    int i = 0;
+    
+    if (interpolation == Interpolation::Cubic) {
+        const __m512 half = _mm512_set1_ps(0.5f);
+        const __m512 oneAndHalf = _mm512_set1_ps(1.5f);
+        const __m512 two = _mm512_set1_ps(2.0f);
+        const __m512 twoAndHalf = _mm512_set1_ps(2.5f);
+        
+        for (; i + 16 <= frames; i += 16) {
+            const __m512i index = _mm512_srli_epi32(phases, PHASE_SHIFT);
+            const __m512 t = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_and_si512(phases, fractionMask)), fractionScale);
+            
+            const __m512 x0 = _mm512_i32gather_ps(index, table, 4);
+            const __m512 x1 = _mm512_i32gather_ps(index, table + 1, 4);
+            const __m512 x2 = _mm512_i32gather_ps(index, table + 2, 4);
+            const __m512 x3 = _mm512_i32gather_ps(index, table + 3, 4);
+            
+            const __m512 c1 = _mm512_mul_ps(half, _mm512_sub_ps(x2, x0));
+            const __m512 c2 = _mm512_sub_ps(_mm512_add_ps(_mm512_sub_ps(x0, _mm512_mul_ps(twoAndHalf, x1)), _mm512_mul_ps(two, x2)), _mm512_mul_ps(half, x3));
+            const __m512 c3 = _mm512_add_ps(_mm512_mul_ps(half, _mm512_sub_ps(x3, x0)), _mm512_mul_ps(oneAndHalf, _mm512_sub_ps(x1, x2)));
+            
+            __m512 y = _mm512_add_ps(_mm512_mul_ps(c3, t), c2);
+            y = _mm512_add_ps(_mm512_mul_ps(y, t), c1);
+            y = _mm512_add_ps(_mm512_mul_ps(y, t), x1);
+            _mm512_storeu_ps(out + i, y);
+            
+            phases = _mm512_add_epi32(phases, step);
+        }
+    } else {
+        for (; i + 16 <= frames; i += 16) {
+            const __m512i index = _mm512_srli_epi32(phases, PHASE_SHIFT);
+            const __m512 t = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_and_si512(phases, fractionMask)), fractionScale);
+            
+            const __m512 x1 = _mm512_i32gather_ps(index, table + 1, 4);
+            const __m512 x2 = _mm512_i32gather_ps(index, table + 2, 4);
+            _mm512_storeu_ps(out + i, _mm512_add_ps(x1, _mm512_mul_ps(_mm512_sub_ps(x2, x1), t)));
+            
+            phases = _mm512_add_epi32(phases, step);
+        }
+    }
+    
+    // Leftover frames
+    if (i < frames) {
+        renderWavetableScalar(table, phase + phaseIncrement * static_cast<Uint32>(i), phaseIncrement,
+                              out + i, frames - i, interpolation);
+    }
+}
+
+static void renderSampleAVX512(const float* samples, Uint32 position, Uint32 increment,
+                               float* out, int frames, Interpolation interpolation) {
+    const __m512i laneOffsets = _mm512_mullo_epi32(_mm512_set1_epi32(static_cast<int>(increment)),
+                                                   _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+    const __m512i step = _mm512_set1_epi32(static_cast<int>(increment * 16));
+    const __m512i fractionMask = _mm512_set1_epi32(SAMPLE_FRACTION_MASK);
+    const __m512 fractionScale = _mm512_set1_ps(SAMPLE_FRACTION_SCALE);
+    
+    __m512i positions = _mm512_add_epi32(_mm512_set1_epi32(static_cast<int>(position)), laneOffsets);
+    int i = 0;
+    
+    if (interpolation == Interpolation::Cubic) {
+        const __m512 half = _mm512_set1_ps(0.5f);
+        const __m512 oneAndHalf = _mm512_set1_ps(1.5f);
+        const __m512 two = _mm512_set1_ps(2.0f);
+        const __m512 twoAndHalf = _mm512_set1_ps(2.5f);
+        
+        for (; i + 16 <= frames; i += 16) {
+            const __m512i index = _mm512_srli_epi32(positions, SAMPLE_FRACTION_BITS);
+            const __m512 t = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_and_si512(positions, fractionMask)), fractionScale);
+            
+            const __m512 x0 = _mm512_i32gather_ps(index, samples - 1, 4);
+            const __m512 x1 = _mm512_i32gather_ps(index, samples, 4);
+            const __m512 x2 = _mm512_i32gather_ps(index, samples + 1, 4);
+            const __m512 x3 = _mm512_i32gather_ps(index, samples + 2, 4);
+            
+            const __m512 c1 = _mm512_mul_ps(half, _mm512_sub_ps(x2, x0));
+            const __m512 c2 = _mm512_sub_ps(_mm512_add_ps(_mm512_sub_ps(x0, _mm512_mul_ps(twoAndHalf, x1)), _mm512_mul_ps(two, x2)), _mm512_mul_ps(half, x3));
+            const __m512 c3 = _mm512_add_ps(_mm512_mul_ps(half, _mm512_sub_ps(x3, x0)), _mm512_mul_ps(oneAndHalf, _mm512_sub_ps(x1, x2)));
+            
+            __m512 y = _mm512_add_ps(_mm512_mul_ps(c3, t), c2);
+            y = _mm512_add_ps(_mm512_mul_ps(y, t), c1);
+            y = _mm512_add_ps(_mm512_mul_ps(y, t), x1);
+            _mm512_storeu_ps(out + i, y);
+            
+            positions = _mm512_add_epi32(positions, step);
+        }
+    } else {
+        for (; i + 16 <= frames; i += 16) {
+            const __m512i index = _mm512_srli_epi32(positions, SAMPLE_FRACTION_BITS);
+            const __m512 t = _mm512_mul_ps(_mm512_cvtepi32_ps(_mm512_and_si512(positions, fractionMask)), fractionScale);
+            
+            const __m512 x0 = _mm512_i32gather_ps(index, samples, 4);
+            const __m512 x1 = _mm512_i32gather_ps(index, samples + 1, 4);
+            _mm512_storeu_ps(out + i, _mm512_add_ps(x0, _mm512_mul_ps(_mm512_sub_ps(x1, x0), t)));
+            
+            positions = _mm512_add_epi32(positions, step);
+        }
+    }
+    
+    // Leftover frames
+    if (i < frames) {
+        renderSampleScalar(samples, position + increment * static_cast<Uint32>(i), increment,
+                           out + i, frames - i, interpolation);
+    }
+}
+
+static void panMultiplyAddAVX512(float* out, int stride, int channels, const float* a, const float* b,
+                                 const float* gains, const float* steps, int frames) {
+    // Only the channels the source reaches
+    int active[MAX_OUTPUT_CHANNELS];
+    int count = 0;
+    for (int c = 0; c < channels; c++) {
+        if (gains[c] != 0.0f || steps[c] != 0.0f) active[count++] = c;
+    }
+    
+    const __m512 laneIndex = _mm512_setr_ps(0.0f, 1.0f, 2.0f, 3.0f, 4.0f, 5.0f, 6.0f, 7.0f, 8.0f, 9.0f, 10.0f, 11.0f,
+                                             12.0f, 13.0f, 14.0f, 15.0f);
+    int i = 0;
+    for (; i + 16 <= frames; i += 16) {
+        const __m512 product = _mm512_mul_ps(_mm512_loadu_ps(a + i), _mm512_loadu_ps(b + i));
+        const __m512 index = _mm512_add_ps(laneIndex, _mm512_set1_ps(static_cast<float>(i)));
+        for (int k = 0; k < count; k++) {
+            const int c = active[k];
+            float* channel = out + c * stride + i;
+            const __m512 gain = _mm512_add_ps(_mm512_set1_ps(gains[c]), _mm512_mul_ps(_mm512_set1_ps(steps[c]), index));
+            _mm512_storeu_ps(channel, _mm512_add_ps(_mm512_loadu_ps(channel), _mm512_mul_ps(product, gain)));
+        }
+    }
+    for (; i < frames; i++) {
+        const float product = a[i] * b[i];
+        for (int k = 0; k < count; k++) {
+            const int c = active[k];
+            out[c * stride + i] += product * (gains[c] + steps[c] * static_cast<float>(i));
+        }
+    }
+}
+
+static void envelopeRampAVX512(float* out, int frames, float start, float step) {
+    const __m512 startV = _mm512_set1_ps(start);
+    const __m512 stepV = _mm512_set1_ps(step);
+    const __m512 sixteen = _mm512_set1_ps(16.0f);
+    __m512 index = _mm512_setr_ps(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15);
+    
+    int i = 0;
+    for (; i + 16 <= frames; i += 16) {
+        _mm512_storeu_ps(out + i, _mm512_add_ps(startV, _mm512_mul_ps(stepV, index)));
+        index = _mm512_add_ps(index, sixteen);
+    }
+    for (; i < frames; i++) {
+        out[i] = start + step * static_cast<float>(i);
+    }
+}
+
+static void envelopeCurveAVX512(float* out, int frames, float target, float distance, float coef) {
+    // Eight lanes as on AVX2, not sixteen: a coef^16 stride would round differently. Lane k
+    // starts at distance * coef^k; every step multiplies all lanes by coef^8
+    float powers[ENVELOPE_CURVE_LANES];
+    float power = 1.0f;
+    for (int k = 0; k < ENVELOPE_CURVE_LANES; k++) {
+        powers[k] = distance * power;
+        power *= coef;
+    }
+    
+    const __m256 targetV = _mm256_set1_ps(target);
+    const __m256 stride = _mm256_set1_ps(power);
+    __m256 lanes = _mm256_loadu_ps(powers);
+    
+    int i = 0;
+    for (; i + ENVELOPE_CURVE_LANES <= frames; i += ENVELOPE_CURVE_LANES) {
+        _mm256_storeu_ps(out + i, _mm256_add_ps(targetV, lanes));
+        lanes = _mm256_mul_ps(lanes, stride);
+    }
+    
+    _mm256_storeu_ps(powers, lanes);
+    for (int k = 0; i < frames; i++, k++) {
+        out[i] = target + powers[k];
+    }
+}
+
+static void sumBusesAVX512(float* out, const float* const* buses, int count, int frames) {
+    int i = 0;
+    for (; i + 16 <= frames; i += 16) {
+        __m512 sum = _mm512_loadu_ps(out + i);
+        for (int b = 0; b < count; b++) {
+            sum = _mm512_add_ps(sum, _mm512_loadu_ps(buses[b] + i));
+        }
+        _mm512_storeu_ps(out + i, sum);
+    }
+    for (; i < frames; i++) {
+        float sum = out[i];
+        for (int b = 0; b < count; b++) {
+            sum += buses[b][i];
+        }
+        out[i] = sum;
+    }
+}
+
+const DspKernels* getDspKernelsAVX512() {
+    static const DspKernels kernels = {
+        DspIsa::AVX512, "AVX-512",
+        renderWavetableAVX512,
+        renderSampleAVX512,
+        panMultiplyAddAVX512,
+        envelopeRampAVX512,
+        envelopeCurveAVX512,
+        sumBusesAVX512
+    };
+    return &kernels;
+}
+
+#else
+
+const DspKernels* getDspKernelsAVX512() {
+    return nullptr;
+}
+
+#endif
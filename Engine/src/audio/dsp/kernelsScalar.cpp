@@ -0,0 +1,114 @@
+#include "dspKernels.hpp"
+
+void renderWavetableScalar(const float* table, Uint32 phase, Uint32 phaseIncrement,
+                           float* out, int frames, Interpolation interpolation) {
+    if (interpolation == Interpolation::Cubic) {
+        for (int i = 0; i < frames; i++) {
+            const float* x = table + (phase >> PHASE_SHIFT);
+            const float t = (phase & PHASE_FRACTION_MASK) * PHASE_FRACTION_SCALE;
+            
+            const float c1 = 0.5f * (x[2] - x[0]);
+            const float c2 = x[0] - 2.5f * x[1] + 2.0f * x[2] - 0.5f * x[3];
+            const float c3 = 0.5f * (x[3] - x[0]) + 1.5f * (x[1] - x[2]);
+            out[i] = ((c3 * t + c2) * t + c1) * t + x[1];
+            
+            phase += phaseIncrement;
+        }
+    } else {
+        for (int i = 0; i < frames; i++) {
+            const float* x = table + (phase >> PHASE_SHIFT);
+            const float t = (phase & PHASE_FRACTION_MASK) * PHASE_FRACTION_SCALE;
+            
+            out[i] = x[1] + (x[2] - x[1]) * t;
+            
+            phase += phaseIncrement;
+        }
+    }
+}
+
+void renderSampleScalar(const float* samples, Uint32 position, Uint32 increment,
+                        float* out, int frames, Interpolation interpolation) {
+    if (interpolation == Interpolation::Cubic) {
+        for (int i = 0; i < frames; i++) {
+            const float* x = samples + (position >> SAMPLE_FRACTION_BITS) - 1;
+            const float t = (position & SAMPLE_FRACTION_MASK) * SAMPLE_FRACTION_SCALE;
+            
+            const float c1 = 0.5f * (x[2] - x[0]);
+            const float c2 = x[0] - 2.5f * x[1] + 2.0f * x[2] - 0.5f * x[3];
+            const float c3 = 0.5f * (x[3] - x[0]) + 1.5f * (x[1] - x[2]);
+            out[i] = ((c3 * t + c2) * t + c1) * t + x[1];
+            
+            position += increment;
+        }
+    } else {
+        for (int i = 0; i < frames; i++) {
+            const float* x = samples + (position >> SAMPLE_FRACTION_BITS);
+            const float t = (position & SAMPLE_FRACTION_MASK) * SAMPLE_FRACTION_SCALE;
+            
+            out[i] = x[0] + (x[1] - x[0]) * t;
+            
+            position += increment;
+        }
+    }
+}
+
+static void panMultiplyAddScalar(float* out, int stride, int channels, const float* a, const float* b,
+                                 const float* gains, const float* steps, int frames) {
+    for (int c = 0; c < channels; c++) {
+        if (gains[c] == 0.0f && steps[c] == 0.0f) continue;
+        float* channel = out + c * stride;
+        for (int i = 0; i < frames; i++) {
+            channel[i] += a[i] * b[i] * (gains[c] + steps[c] * static_cast<float>(i));
+        }
+    }
+}
+
+static void envelopeRampScalar(float* out, int frames, float start, float step) {
+    for (int i = 0; i < frames; i++) {
+        out[i] = start + step * static_cast<float>(i);
+    }
+}
+
+static void envelopeCurveScalar(float* out, int frames, float target, float distance, float coef) {
+    // ENVELOPE_CURVE_LANES interleaved sequences, as the SIMD kernels compute it
+    float lanes[ENVELOPE_CURVE_LANES];
+    float stride = 1.0f;
+    for (int k = 0; k < ENVELOPE_CURVE_LANES; k++) {
+        lanes[k] = distance * stride;
+        stride *= coef;
+    }
+    
+    int i = 0;
+    for (; i + ENVELOPE_CURVE_LANES <= frames; i += ENVELOPE_CURVE_LANES) {
+        for (int k = 0; k < ENVELOPE_CURVE_LANES; k++) {
+            out[i + k] = target + lanes[k];
+            lanes[k] *= stride;
+        }
+    }
+    for (int k = 0; i < frames; i++, k++) {
+        out[i] = target + lanes[k];
+    }
+}
+
+static void sumBusesScalar(float* out, const float* const* buses, int count, int frames) {
+    for (int i = 0; i < frames; i++) {
+        float sum = out[i];
+        for (int b = 0; b < count; b++) {
+            sum += buses[b][i];
+        }
+        out[i] = sum;
+    }
+}
+
+const DspKernels* getDspKernelsScalar() {
+    static const DspKernels kernels = {
+        DspIsa::Scalar, "scalar",
+        renderWavetableScalar,
+        renderSampleScalar,
+        panMultiplyAddScalar,
+        envelopeRampScalar,
+        envelopeCurveScalar,
+        sumBusesScalar
+    };
+    return &kernels;
+}
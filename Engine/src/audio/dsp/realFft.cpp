@@ -0,0 +1,124 @@
+#include "realFft.hpp"
+#include <SDL3/SDL.h>
+#include <cmath>
+
+RealFft::RealFft(int fftSize) : size(fftSize), half(fftSize / 2), re(fftSize / 2), im(fftSize / 2) {
+    int bits = 0;
+    while ((1 << bits) < half) bits++;
+    
+    bitReverse.resize(half);
+    for (int i = 0; i < half; i++) {
+        int reversed = 0;
+        for (int b = 0; b < bits; b++) {
+            reversed |= ((i >> b) & 1) << (bits - 1 - b);
+        }
+        bitReverse[i] = reversed;
+    }
+    
+    // An odd number of radix-2 steps leaves one to do on its own, first
+    radix2First = (bits & 1) != 0;
+    for (int span = radix2First ? 2 : 1; span < half; span *= 4) {
+        stages.push_back({span, w1Re.size()});
+        for (int k = 0; k < span; k++) {
+            const double angle = -2.0 * SDL_PI_D * k / (4.0 * span);
+            w1Re.push_back(static_cast<float>(std::cos(angle)));
+            w1Im.push_back(static_cast<float>(std::sin(angle)));
+            w2Re.push_back(static_cast<float>(std::cos(2.0 * angle)));
+            w2Im.push_back(static_cast<float>(std::sin(2.0 * angle)));
+            w3Re.push_back(static_cast<float>(std::cos(3.0 * angle)));
+            w3Im.push_back(static_cast<float>(std::sin(3.0 * angle)));
+        }
+    }
+    
+    splitCos.resize(half);
+    splitSin.resize(half);
+    for (int k = 0; k < half; k++) {
+        const double angle = 2.0 * SDL_PI_D * k / size;
+        splitCos[k] = static_cast<float>(std::cos(angle));
+        splitSin[k] = static_cast<float>(std::sin(angle));
+    }
+}
+
+void RealFft::transform() {
+    float* xr = re.data();
+    float* xi = im.data();
+    
+    if (radix2First) {
+        for (int i = 0; i < half; i += 2) {
+            const float ar = xr[i], ai = xi[i];
+            const float br = xr[i + 1], bi = xi[i + 1];
+            xr[i] = ar + br;
+            xi[i] = ai + bi;
+            xr[i + 1] = ar - br;
+            xi[i + 1] = ai - bi;
+        }
+    }
+    
+    for (const Stage& stage : stages) {
+        const int span = stage.span;
+        const float* c1 = w1Re.data() + stage.twiddles;
+        const float* s1 = w1Im.data() + stage.twiddles;
+        const float* c2 = w2Re.data() + stage.twiddles;
+        const float* s2 = w2Im.data() + stage.twiddles;
+        const float* c3 = w3Re.data() + stage.twiddles;
+        const float* s3 = w3Im.data() + stage.twiddles;
+        
+        for (int base = 0; base < half; base += 4 * span) {
+            // The four quarters of the block hold the DFTs of x[4n], x[4n+2], x[4n+1], x[4n+3]
+            float* r0 = xr + base;
+            float* i0 = xi + base;
+            float* r1 = r0 + span;
+            float* i1 = i0 + span;
+            float* r2 = r1 + span;
+            float* i2 = i1 + span;
+            float* r3 = r2 + span;
+            float* i3 = i2 + span;
+            
+            for (int k = 0; k < span; k++) {
+                const float t1r = r2[k] * c1[k] - i2[k] * s1[k];
+                const float t1i = r2[k] * s1[k] + i2[k] * c1[k];
+                const float t2r = r1[k] * c2[k] - i1[k] * s2[k];
+                const float t2i = r1[k] * s2[k] + i1[k] * c2[k];
+                const float t3r = r3[k] * c3[k] - i3[k] * s3[k];
+                const float t3i = r3[k] * s3[k] + i3[k] * c3[k];
+                
+                const float sum0r = r0[k] + t2r, sum0i = i0[k] + t2i;
+                const float diff0r = r0[k] - t2r, diff0i = i0[k] - t2i;
+                const float sum1r = t1r + t3r, sum1i = t1i + t3i;
+                const float diff1r = t1r - t3r, diff1i = t1i - t3i;
+                
+                r0[k] = sum0r + sum1r;
+                i0[k] = sum0i + sum1i;
+                r1[k] = diff0r + diff1i;
+                i1[k] = diff0i - diff1r;
+                r2[k] = sum0r - sum1r;
+                i2[k] = sum0i - sum1i;
+                r3[k] = diff0r - diff1i;
+                i3[k] = diff0i + diff1r;
+            }
+        }
+    }
+}
+
+void RealFft::magnitudes(const float* input, float* out) {
+    // Even samples are the real parts, odd ones the imaginary parts
+    for (int n = 0; n < half; n++) {
+        re[bitReverse[n]] = input[2 * n];
+        im[bitReverse[n]] = input[2 * n + 1];
+    }
+    
+    transform();
+    
+    // X[k] = E[k] + W^k O[k], with E and O the spectra of the even and odd samples
+    for (int k = 0; k < half; k++) {
+        const int mirror = (half - k) & (half - 1);
+        const float evenR = 0.5f * (re[k] + re[mirror]);
+        const float evenI = 0.5f * (im[k] - im[mirror]);
+        const float oddR = 0.5f * (im[k] + im[mirror]);
+        const float oddI = -0.5f * (re[k] - re[mirror]);
+        
+        const float binR = evenR + splitCos[k] * oddR + splitSin[k] * oddI;
+        const float binI = evenI + splitCos[k] * oddI - splitSin[k] * oddR;
+        out[k] = std::sqrt(binR * binR + binI * binI);
+    }
+}
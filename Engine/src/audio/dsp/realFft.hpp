@@ -0,0 +1,41 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// FFT of real input of a power-of-two size. The samples are packed as a complex sequence of
+// half the size, transformed with radix-4 stages (plus one radix-2 stage when log2 of that is
+// odd) and split back into the real spectrum. Data is kept as separate re/im arrays and each
+// stage has its twiddles laid out contiguously, so the butterfly loops run over plain arrays
+// the compiler vectorizes for the baseline instruction set.
+class RealFft {
+private:
+    struct Stage {
+        int span;        // Size of the sub-transforms this stage combines (radix-4 only)
+        size_t twiddles; // Offset of its L twiddle triples in the stage tables
+    };
+    
+    int size;
+    int half;
+    bool radix2First;
+    std::vector<int> bitReverse;   // Input order of the half-size transform
+    std::vector<Stage> stages;     // Radix-4 stages, in order
+    std::vector<float> w1Re, w1Im; // W^k, W^2k, W^3k for every radix-4 stage
+    std::vector<float> w2Re, w2Im;
+    std::vector<float> w3Re, w3Im;
+    std::vector<float> splitCos;   // cos and sin of 2*pi*k/size, for the split step
+    std::vector<float> splitSin;
+    std::vector<float> re;         // Work arrays, half entries each
+    std::vector<float> im;
+    
+    void transform();
+
+public:
+    // size must be a power of two, at least 4
+    explicit RealFft(int size);
+    
+    int getSize() const { return size; }
+    
+    // Magnitudes of bins 0..size/2-1 of `size` real samples, unnormalized
+    void magnitudes(const float* input, float* out);
+};
@@ -0,0 +1,141 @@
+#include "envelope.hpp"
+#include <cmath>
+
+// ln(1000): exponential segments cover all but 1/1000 of their distance
+#define ENVELOPE_EXP_DEPTH 6.907755f
+
+void Envelope::start(const EnvelopeParams& settings, int releaseAtSample) {
+    params = settings;
+    if (params.releaseSamples < 1) params.releaseSamples = 1;
+    position = 0;
+    releaseAt = NEVER;
+    releaseLevel = 0.0f;
+    
+    if (releaseAtSample != NEVER) {
+        releaseAt = releaseAtSample > 0 ? releaseAtSample : 0;
+        releaseLevel = heldLevelAt(releaseAt);
+    }
+}
+
+void Envelope::noteOff(int delay) {
+    const int at = position + (delay > 0 ? delay : 0);
+    if (at >= releaseAt) return;
+    
+    releaseAt = at;
+    releaseLevel = heldLevelAt(at);
+}
+
+void Envelope::fadeOut(int samples) {
+    releaseLevel = levelAt(position);
+    releaseAt = position;
+    params.releaseSamples = samples > 0 ? samples : 1;
+    params.curve = EnvelopeCurve::Linear;
+}
+
+void Envelope::stop() {
+    releaseLevel = 0.0f;
+    releaseAt = position;
+    params.releaseSamples = 0;
+}
+
+void Envelope::holdPosition() {
+    const int end = releaseAt == NEVER ? params.attackSamples + params.decaySamples : releaseAt + params.releaseSamples;
+    if (position > end) {
+        position = end;
+    }
+}
+
+float Envelope::heldLevelAt(int n) const {
+    const EnvelopeParams& p = params;
+    
+    if (n < p.attackSamples) {
+        return static_cast<float>(n) / p.attackSamples;
+    }
+    n -= p.attackSamples;
+    
+    if (n < p.decaySamples) {
+        const float t = static_cast<float>(n) / p.decaySamples;
+        if (p.curve == EnvelopeCurve::Exponential) {
+            return p.sustainLevel + (1.0f - p.sustainLevel) * expf(-ENVELOPE_EXP_DEPTH * t);
+        }
+        return 1.0f + (p.sustainLevel - 1.0f) * t;
+    }
+    
+    return p.sustainLevel;
+}
+
+float Envelope::levelAt(int n) const {
+    if (n < releaseAt) {
+        return heldLevelAt(n);
+    }
+    
+    const int r = n - releaseAt;
+    if (r >= params.releaseSamples) {
+        return 0.0f;
+    }
+    
+    const float t = static_cast<float>(r) / params.releaseSamples;
+    if (params.curve == EnvelopeCurve::Exponential) {
+        return releaseLevel * expf(-ENVELOPE_EXP_DEPTH * t);
+    }
+    return releaseLevel * (1.0f - t);
+}
+
+void Envelope::render(const DspKernels& kernels, float* out, int frames, float gain) {
+    const EnvelopeParams& p = params;
+    int done = 0;
+    
+    // Split the block at stage boundaries; every run is one ramp or curve kernel call
+    while (done < frames) {
+        const int n = position;
+        int run = frames - done;
+        
+        if (n >= releaseAt) {
+            const int r = n - releaseAt;
+            if (r >= p.releaseSamples) {
+                // Finished: silence for the rest of the block
+                SDL_memset(out + done, 0, (frames - done) * sizeof(float));
+                position += frames - done;
+                holdPosition();
+                return;
+            }
+            
+            if (run > p.releaseSamples - r) run = p.releaseSamples - r;
+            if (p.curve == EnvelopeCurve::Exponential) {
+                kernels.envelopeCurve(out + done, run, 0.0f, levelAt(n) * gain,
+                                      expf(-ENVELOPE_EXP_DEPTH / p.releaseSamples));
+            } else {
+                kernels.envelopeRamp(out + done, run, levelAt(n) * gain,
+                                     -releaseLevel * gain / p.releaseSamples);
+            }
+        } else {
+            const int untilRelease = releaseAt - n;
+            if (run > untilRelease) run = untilRelease;
+            
+            if (n < p.attackSamples) {
+                // Attack
+                if (run > p.attackSamples - n) run = p.attackSamples - n;
+                kernels.envelopeRamp(out + done, run, heldLevelAt(n) * gain, gain / p.attackSamples);
+            } else if (n < p.attackSamples + p.decaySamples) {
+                // Decay
+                const int d = n - p.attackSamples;
+                if (run > p.decaySamples - d) run = p.decaySamples - d;
+                if (p.curve == EnvelopeCurve::Exponential) {
+                    kernels.envelopeCurve(out + done, run, p.sustainLevel * gain,
+                                          (heldLevelAt(n) - p.sustainLevel) * gain,
+                                          expf(-ENVELOPE_EXP_DEPTH / p.decaySamples));
+                } else {
+                    kernels.envelopeRamp(out + done, run, heldLevelAt(n) * gain,
+                                         (p.sustainLevel - 1.0f) * gain / p.decaySamples);
+                }
+            } else {
+                // Sustain
+                kernels.envelopeRamp(out + done, run, p.sustainLevel * gain, 0.0f);
+            }
+        }
+        
+        done += run;
+        position += run;
+    }
+    holdPosition();
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include "dsp/dspKernels.hpp"
+
+// Shape of the decay and release segments (attack is always linear)
+enum class EnvelopeCurve {
+    Linear,
+    Exponential // Falls to 1/1000 of the distance over the segment, then snaps
+};
+
+// ADSR settings in samples
+struct EnvelopeParams {
+    int attackSamples;
+    int decaySamples;
+    float sustainLevel;
+    int releaseSamples;
+    EnvelopeCurve curve;
+};
+
+// ADSR generator of one voice, rendered a block at a time.
+// The level is a closed-form function of the sample position and the release
+// point, so a block is a handful of branch-free ramp segments and the result
+// doesn't depend on how the note was cut into blocks.
+struct Envelope {
+    static const int NEVER = 0x7fffffff;
+    
+    EnvelopeParams params;
+    int position;       // Samples since note-on, held where the level stops changing
+    int releaseAt;      // Position the release stage starts at, NEVER while held
+    float releaseLevel; // Level at releaseAt
+    
+    // Start the attack. releaseAt schedules the note-off (NEVER = wait for noteOff)
+    void start(const EnvelopeParams& settings, int releaseAt = NEVER);
+    
+    // Enter the release stage `delay` samples from now (key-up). No-op if it releases earlier
+    void noteOff(int delay = 0);
+    
+    // Replace the release with a linear fade of the given length, starting now
+    void fadeOut(int samples);
+    
+    // End the note now: silent and finished from here on
+    void stop();
+    
+    // Write the next `frames` levels times gain to out and advance.
+    // Frames past the end of the release are written as zero.
+    void render(const DspKernels& kernels, float* out, int frames, float gain);
+    
+    // Advance like render without writing anything
+    void skip(int frames) {
+        position += frames;
+        holdPosition();
+    }
+    
+    // Level at an arbitrary position
+    float levelAt(int samplePosition) const;
+    
+    float getLevel() const { return levelAt(position); }
+    bool isReleasing() const { return position >= releaseAt; }
+    bool isFinished() const { return releaseAt != NEVER && position >= releaseAt + params.releaseSamples; }
+    
+private:
+    // Level ignoring the release stage
+    float heldLevelAt(int samplePosition) const;
+    
+    // Stop the position at the start of sustain while held, or at the end of the release, so
+    // a note held for hours never overflows it. The level is constant past either point
+    void holdPosition();
+};
@@ -0,0 +1,72 @@
+#include "keySounds.hpp"
+
+// Define a sequence of frequencies for musical notes - expanded to include deeper notes
+std::vector<double> getNoteFrequencies() {
+    return {
+        65.0,  // C2
+        70.0,  // C#2/Db2
+        75.0,  // D2
+        80.0,  // D#2/Eb2
+        85.0,  // E2
+        90.0,  // F2
+        95.0,  // F#2/Gb2
+        100.0,  // G2
+        105.0, // G#2/Ab2
+        110.0, // A2
+        115.0, // A#2/Bb2
+        120.0, // B2
+        125.0, // C3
+        130.0, // C#3/Db3
+        135.0, // D3
+        140.0, // D#3/Eb3
+        145.0, // E3
+        150.0, // F3
+        155.0, // F#3/Gb3
+        160.0, // G3
+        165.0, // G#3/Ab3
+        170.0, // A3
+        175.0, // A#3/Bb3
+        180.0, // B3
+        185.0, // C4
+        190.0, // C#4/Db4
+        195.0, // D4
+        200.0  // D#4/Eb4
+    };
+}
+
+void addKeySounds(SoundManager &soundManager, const std::vector<double> &frequencies, KeySounds &keySounds) {
+    // Add sounds for each note with 100ms fadeout
+    for (size_t i = 0; i < frequencies.size(); i++) {
+        std::string noteName = "note" + std::to_string(i);
+        keySounds.notes.push_back(soundManager.addSound(noteName, frequencies[i], 0.3f, 500, 100)); // 500ms duration, 100ms fadeout
+        
+        // Laid out like a keyboard in front of the player: low notes left, high notes right
+        const float spread = frequencies.size() > 1 ? static_cast<float>(i) / (frequencies.size() - 1) : 0.5f;
+        soundManager.setPosition(keySounds.notes.back(), -30.0f + 60.0f * spread);
+    }
+    
+    // Play the notes from sampled instrument zones when one is installed
+    const SamplerInstrument* instrument =
+        soundManager.loadInstrument(std::string(RESOURCES_PATH) + SAMPLER_INSTRUMENT_FILE);
+    if (instrument) {
+        for (SoundHandle note : keySounds.notes) {
+            soundManager.setInstrument(note, instrument);
+        }
+    }
+    
+    // Create a chord sound with 200ms fadeout for smoother chord endings
+    keySounds.chord[0] = soundManager.addSound("chord1", 130.81, 0.2f, 5000, 200); // C3 for 3 seconds, 200ms fadeout
+    keySounds.chord[1] = soundManager.addSound("chord2", 164.81, 0.2f, 5000, 200); // E3 for 3 seconds, 200ms fadeout 
+    keySounds.chord[2] = soundManager.addSound("chord3", 195.99, 0.2f, 5000, 200); // G3 for 3 seconds, 200ms fadeout
+    
+    // Add drum sounds with appropriate characteristics
+    // Each drum has unique frequency, gain, duration and fadeout parameters to create different percussive sounds
+    keySounds.drums[0] = soundManager.addSound("kick0", 50.00, 0.8f, 120, 80);     // Bass drum - deeper sound, strong attack, short decay
+    keySounds.drums[1] = soundManager.addSound("kick1", 55.00, 0.8f, 120, 80);     // Bass drum - deeper sound, strong attack, short decay
+    keySounds.drums[2] = soundManager.addSound("kick2", 60.00, 0.8f, 120, 80);     // Bass drum - deeper sound, strong attack, short decay
+    keySounds.drums[3] = soundManager.addSound("kick3", 65.00, 0.8f, 120, 80);     // Bass drum - deeper sound, strong attack, short decay
+    keySounds.drums[4] = soundManager.addSound("kick4", 70.00, 0.8f, 120, 80);     // Bass drum - deeper sound, strong attack, short decay
+    keySounds.drums[5] = soundManager.addSound("kick5", 75.00, 0.8f, 120, 80);     // Bass drum - deeper sound, strong attack, short decay
+    keySounds.drums[6] = soundManager.addSound("kick6", 80.00, 0.8f, 120, 80);     // Bass drum - deeper sound, strong attack, short decay
+    keySounds.drums[7] = soundManager.addSound("kick7", 85.00, 0.8f, 120, 80);     // Bass drum - deeper sound, strong attack, short decay
+}
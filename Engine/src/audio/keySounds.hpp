@@ -0,0 +1,19 @@
+#pragma once
+
+#include <vector>
+#include "soundManager.hpp"
+
+// Handles of the sounds the keys play, looked up once after the sounds are added
+// so a key event never builds or compares a name
+struct KeySounds {
+    std::vector<SoundHandle> notes;
+    SoundHandle chord[3];
+    SoundHandle drums[8];
+};
+
+// Frequencies of the note keys, lowest first
+std::vector<double> getNoteFrequencies();
+
+// Add every sound the keys play. The game, the render mode and the benchmarks share this,
+// so recordings resolve to the same sounds everywhere
+void addKeySounds(SoundManager &soundManager, const std::vector<double> &frequencies, KeySounds &keySounds);
@@ -0,0 +1,232 @@
+#include "mixWorkers.hpp"
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include "config.hpp"
+
+#ifdef _WIN32
+#include <windows.h>
+#elif defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+// Keep the worker off the cores the other workers run on. SDL has no affinity call, so
+// this is per OS; elsewhere the scheduler places the thread
+static void pinCurrentThread(int core) {
+#if MIX_PIN_WORKERS && defined(_WIN32)
+    if (core < 64 && !SetThreadAffinityMask(GetCurrentThread(), 1ull << core)) {
+        SDL_Log("Could not pin mix worker to core %d", core);
+    }
+#elif MIX_PIN_WORKERS && defined(__linux__)
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(core, &set);
+    if (pthread_setaffinity_np(pthread_self(), sizeof(set), &set) != 0) {
+        SDL_Log("Could not pin mix worker to core %d", core);
+    }
+#else
+    (void)core;
+#endif
+}
+
+static Uint64 packRange(Uint32 job, int next, int end) {
+    return (static_cast<Uint64>(job) << 32) | (static_cast<Uint64>(next) << 16) | static_cast<Uint64>(end);
+}
+
+MixWorkers::MixWorkers(int threads, int batchLimit, int samples, bool deterministicSum)
+    : threadCount(threads < 0 ? SDL_GetNumLogicalCPUCores() - 1 : threads),
+      maxBatches(std::clamp(batchLimit, 1, 0xFFFF)), busSamples(samples), deterministic(deterministicSum),
+      kernels(getDspKernels()) {
+    threadCount = std::clamp(threadCount, 0, MIX_MAX_WORKER_THREADS);
+    
+    const int participants = threadCount + 1;
+    ranges = std::vector<std::atomic<Uint64>>(participants);
+    busEpoch = std::vector<std::atomic<Uint32>>(participants);
+    for (int p = 0; p < participants; p++) {
+        ranges[p].store(0, std::memory_order_relaxed);
+        busEpoch[p].store(0, std::memory_order_relaxed);
+    }
+    
+    buses.assign(static_cast<size_t>(deterministic ? maxBatches : participants) * busSamples, 0.0f);
+    sumList.reserve(deterministic ? maxBatches : participants);
+}
+
+MixWorkers::~MixWorkers() {
+    stop();
+}
+
+bool MixWorkers::start() {
+    if (running.load(std::memory_order_relaxed) || threadCount == 0) {
+        return true;
+    }
+    
+    running.store(true, std::memory_order_relaxed);
+    for (int i = 0; i < threadCount; i++) {
+        std::unique_ptr<Worker> worker = std::make_unique<Worker>();
+        worker->pool = this;
+        worker->index = i + 1;
+        worker->sleeping.store(false, std::memory_order_relaxed);
+        worker->wake = SDL_CreateSemaphore(0);
+        worker->thread = worker->wake ? SDL_CreateThread(workerMain, "MixWorker", worker.get()) : nullptr;
+        if (!worker->thread) {
+            SDL_Log("Failed to start mix worker %d: %s", worker->index, SDL_GetError());
+            if (worker->wake) {
+                SDL_DestroySemaphore(worker->wake);
+            }
+            break;
+        }
+        workers.push_back(std::move(worker));
+    }
+    
+    SDL_Log("Mixing on %d worker threads besides the audio callback (%s sum)", static_cast<int>(workers.size()),
+            deterministic ? "deterministic" : "unordered");
+    return static_cast<int>(workers.size()) == threadCount;
+}
+
+void MixWorkers::stop() {
+    running.store(false, std::memory_order_seq_cst);
+    for (std::unique_ptr<Worker>& worker : workers) {
+        SDL_SignalSemaphore(worker->wake);
+    }
+    for (std::unique_ptr<Worker>& worker : workers) {
+        SDL_WaitThread(worker->thread, nullptr);
+        SDL_DestroySemaphore(worker->wake);
+    }
+    workers.clear();
+}
+
+int MixWorkers::claim(int participant, Uint32 job, bool fromBack) {
+    std::atomic<Uint64>& range = ranges[participant];
+    Uint64 value = range.load(std::memory_order_acquire);
+    for (;;) {
+        if (static_cast<Uint32>(value >> 32) != job) {
+            return -1;
+        }
+        const int next = static_cast<int>((value >> 16) & 0xFFFF);
+        const int end = static_cast<int>(value & 0xFFFF);
+        if (next >= end) {
+            return -1;
+        }
+        
+        const Uint64 claimed = fromBack ? packRange(job, next, end - 1) : packRange(job, next + 1, end);
+        if (range.compare_exchange_weak(value, claimed, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            return fromBack ? end - 1 : next;
+        }
+    }
+}
+
+void MixWorkers::work(int participant, Uint32 job) {
+    const int participants = threadCount + 1;
+    
+    // Own range from the front first, then the others' from the back
+    for (int offset = 0; offset < participants; offset++) {
+        const int owner = (participant + offset) % participants;
+        const bool stealing = offset > 0;
+        
+        int batch;
+        while ((batch = claim(owner, job, stealing)) >= 0) {
+            float* bus;
+            if (deterministic) {
+                bus = &buses[static_cast<size_t>(batch) * busSamples];
+                std::memset(bus, 0, busSamples * sizeof(float));
+            } else {
+                bus = &buses[static_cast<size_t>(participant) * busSamples];
+                if (busEpoch[participant].load(std::memory_order_relaxed) != job) {
+                    std::memset(bus, 0, busSamples * sizeof(float));
+                    busEpoch[participant].store(job, std::memory_order_relaxed);
+                }
+            }
+            
+            batchFn(context, batch, bus, frames);
+            remaining.fetch_sub(1, std::memory_order_release);
+        }
+    }
+}
+
+void MixWorkers::run(BatchFn fn, void* userContext, int batches, float* out, int frameCount) {
+    batches = std::min(batches, maxBatches);
+    if (batches <= 0) {
+        return;
+    }
+    
+    batchFn = fn;
+    context = userContext;
+    frames = frameCount;
+    epoch++;
+    remaining.store(batches, std::memory_order_relaxed);
+    
+    // Contiguous ranges, so each participant walks neighbouring voices
+    const int participants = threadCount + 1;
+    for (int p = 0; p < participants; p++) {
+        ranges[p].store(packRange(epoch, batches * p / participants, batches * (p + 1) / participants),
+                        std::memory_order_release);
+    }
+    jobEpoch.store(epoch, std::memory_order_seq_cst);
+    
+    for (std::unique_ptr<Worker>& worker : workers) {
+        if (worker->sleeping.exchange(false, std::memory_order_seq_cst)) {
+            SDL_SignalSemaphore(worker->wake);
+        }
+    }
+    
+    work(0, epoch);
+    
+    // Only batches a worker claimed and is still rendering are left to wait for. Yield now
+    // and then in case that worker was preempted on an oversubscribed CPU
+    for (int spins = 1; remaining.load(std::memory_order_acquire) > 0; spins++) {
+        if (spins % 64 == 0) {
+            std::this_thread::yield();
+        } else {
+            SDL_CPUPauseInstruction();
+        }
+    }
+    
+    sumList.clear();
+    if (deterministic) {
+        for (int batch = 0; batch < batches; batch++) {
+            sumList.push_back(&buses[static_cast<size_t>(batch) * busSamples]);
+        }
+    } else {
+        for (int p = 0; p < participants; p++) {
+            if (busEpoch[p].load(std::memory_order_relaxed) == epoch) {
+                sumList.push_back(&buses[static_cast<size_t>(p) * busSamples]);
+            }
+        }
+    }
+    kernels.sumBuses(out, sumList.data(), static_cast<int>(sumList.size()), busSamples);
+}
+
+int SDLCALL MixWorkers::workerMain(void* userdata) {
+    Worker* worker = static_cast<Worker*>(userdata);
+    MixWorkers* pool = worker->pool;
+    
+    SDL_SetCurrentThreadPriority(SDL_THREAD_PRIORITY_TIME_CRITICAL);
+    pinCurrentThread(worker->index % std::max(SDL_GetNumLogicalCPUCores(), 1));
+    
+    Uint32 seen = pool->jobEpoch.load(std::memory_order_acquire);
+    Uint64 spinUntilNS = 0;
+    while (pool->running.load(std::memory_order_relaxed)) {
+        const Uint32 job = pool->jobEpoch.load(std::memory_order_acquire);
+        if (job != seen) {
+            seen = job;
+            pool->work(worker->index, job);
+            spinUntilNS = SDL_GetTicksNS() + SDL_US_TO_NS(MIX_WORKER_SPIN_US);
+            continue;
+        }
+        
+        // Blocks come in bursts per callback, so stay awake for the next one a little while
+        if (SDL_GetTicksNS() < spinUntilNS) {
+            std::this_thread::yield();
+            continue;
+        }
+        
+        // run() clears the flag and signals after publishing, so a job is never missed
+        worker->sleeping.store(true, std::memory_order_seq_cst);
+        if (pool->jobEpoch.load(std::memory_order_seq_cst) == seen && pool->running.load(std::memory_order_seq_cst)) {
+            SDL_WaitSemaphore(worker->wake);
+        }
+        worker->sleeping.store(false, std::memory_order_relaxed);
+    }
+    return 0;
+}
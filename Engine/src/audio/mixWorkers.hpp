@@ -0,0 +1,83 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include "dsp/dspKernels.hpp"
+
+// Threads that help the audio callback render large voice counts. A job is a number of
+// batches; they are split into one contiguous range per participant (the calling thread
+// plus every worker). Each takes batches from the front of its own range, then steals
+// from the back of the others' until none are left, so uneven voices even out. The caller
+// never waits for a worker to wake up: whatever nobody claimed it renders itself.
+//
+// Each batch renders into a partial bus, and the buses are summed into the output with a
+// SIMD kernel. Deterministic pools give every batch its own bus and sum them in batch
+// order, so the output is the same for any thread count and any scheduling; otherwise
+// each participant keeps one bus for all its batches, which sums fewer buses.
+class MixWorkers {
+public:
+    // Add batch `batch` of the job into bus (frames samples)
+    typedef void (*BatchFn)(void* context, int batch, float* bus, int frames);
+
+private:
+    struct Worker {
+        MixWorkers* pool;
+        int index;                  // Participant index, 1.. (0 is the caller)
+        SDL_Thread* thread;
+        SDL_Semaphore* wake;
+        std::atomic<bool> sleeping;
+    };
+    
+    int threadCount;
+    int maxBatches;
+    int busSamples;                 // Length of a partial bus (and of the output)
+    bool deterministic;
+    const DspKernels& kernels;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::atomic<bool> running{false};
+    
+    // The current job, written by run() before it publishes the ranges
+    BatchFn batchFn = nullptr;
+    void* context = nullptr;
+    int frames = 0;
+    Uint32 epoch = 0;                        // Job number, caller only
+    std::atomic<Uint32> jobEpoch{0};         // Last published job
+    std::vector<std::atomic<Uint64>> ranges; // Per participant: epoch << 32 | next << 16 | end
+    std::atomic<int> remaining{0};           // Batches not yet rendered
+    
+    std::vector<float> buses;                // maxBatches (deterministic) or participant buses of busSamples
+    std::vector<std::atomic<Uint32>> busEpoch; // Job a participant bus was last cleared for
+    std::vector<const float*> sumList;       // Buses to reduce, in order
+    
+    // Take a batch of the job from a participant's range, -1 when it is empty or stale
+    int claim(int participant, Uint32 job, bool fromBack);
+    
+    // Render every batch this participant can claim or steal
+    void work(int participant, Uint32 job);
+    
+    static int SDLCALL workerMain(void* userdata);
+
+public:
+    // threads extra threads besides the caller, -1 = one per logical core beyond the first.
+    // Buses are busSamples long: every channel of a planar block
+    MixWorkers(int threads, int maxBatches, int busSamples, bool deterministic);
+    ~MixWorkers();
+    
+    MixWorkers(const MixWorkers&) = delete;
+    MixWorkers& operator=(const MixWorkers&) = delete;
+    
+    // Start and stop the worker threads. run() still works while stopped, on the caller alone
+    bool start();
+    void stop();
+    
+    // Render batches 0..batches-1 (at most getMaxBatches()) through fn, which is passed frames,
+    // and add their sum to the busSamples of out. Only one thread may call this
+    void run(BatchFn fn, void* context, int batches, float* out, int frames);
+    
+    int getThreadCount() const { return threadCount; }
+    int getMaxBatches() const { return maxBatches; }
+    int getBusSamples() const { return busSamples; }
+    bool isDeterministic() const { return deterministic; }
+};
@@ -0,0 +1,241 @@
+#include "mixer.hpp"
+#include <algorithm>
+#include "audioStream.hpp"
+#include "config.hpp"
+
+Mixer::Mixer(int voiceCapacity, int repeatIntervalFrames, const SpeakerLayout& layout,
+             SpscQueue<VoiceEvent>* voiceEvents)
+    : voicePool(voiceCapacity, layout, VoiceStealPolicy::SameNote, VOICE_STEAL_FADE_MS), repeaters(REPEATER_CAPACITY),
+      repeatIntervalFrames(repeatIntervalFrames), bus(static_cast<size_t>(layout.channels) * MIX_BLOCK_FRAMES, 0.0f),
+      voiceEvents(voiceEvents) {
+    for (NoteRepeater& repeater : repeaters) {
+        repeater.soundId = -1;
+    }
+    streams.reserve(STREAM_CAPACITY);
+}
+
+void Mixer::advance(float* out, int frames) {
+    runRepeaters(frames);
+    if (out) {
+        const int channels = voicePool.getChannels();
+        SDL_memset(bus.data(), 0, bus.size() * sizeof(float));
+        voicePool.mix(bus.data(), frames);
+        for (size_t i = 0; i < streams.size();) {
+            if (streams[i]->render(bus.data(), voicePool.getLayout(), frames)) {
+                i++;
+            } else {
+                streams[i] = streams.back();
+                streams.pop_back();
+            }
+        }
+        
+        for (int c = 0; c < channels; c++) {
+            const float* channel = &bus[static_cast<size_t>(c) * MIX_BLOCK_FRAMES];
+            for (int i = 0; i < frames; i++) {
+                out[i * channels + c] = channel[i];
+            }
+        }
+    } else {
+        voicePool.skip(frames);
+    }
+    
+    for (int slot : voicePool.getFinishedSlots()) {
+        VoiceEvent event;
+        event.type = VoiceEventType::Finished;
+        event.slot = slot;
+        event.soundId = -1;
+        event.frequency = 0.0;
+        report(event);
+    }
+    
+    mixedFrames += frames;
+}
+
+void Mixer::apply(const AudioCommand& command) {
+    switch (command.type) {
+        case AudioCommandType::NoteOn: {
+            const int delay = frameDelay(command.frame);
+            startVoice(*command.wavetable, command.sample, command.playbackRate, command.frequency, command.gain,
+                       command.azimuth, command.envelope, command.intValue, command.soundId, delay);
+            
+            if (!command.repeat) break;
+            
+            NoteRepeater* slot = nullptr;
+            for (NoteRepeater& repeater : repeaters) {
+                if (repeater.soundId == command.soundId) {
+                    slot = &repeater; // Pressed again: restart its timing
+                    break;
+                }
+                if (!slot && repeater.soundId < 0) {
+                    slot = &repeater;
+                }
+            }
+            
+            if (slot) {
+                slot->soundId = command.soundId;
+                slot->wavetable = command.wavetable;
+                slot->sample = command.sample;
+                slot->playbackRate = command.playbackRate;
+                slot->frequency = command.frequency;
+                slot->gain = command.gain;
+                slot->azimuth = command.azimuth;
+                slot->envelope = command.envelope;
+                slot->releaseAt = command.intValue;
+                slot->nextFrame = mixedFrames + delay + repeatIntervalFrames;
+                slot->stopFrame = NoteRepeater::NOT_RELEASED;
+            }
+            break;
+        }
+        
+        case AudioCommandType::NoteOff: {
+            const int delay = frameDelay(command.frame);
+            voicePool.noteOff(command.soundId, delay);
+            
+            // Retriggers up to the key-up frame still play
+            for (NoteRepeater& repeater : repeaters) {
+                if (repeater.soundId == command.soundId && repeater.stopFrame == NoteRepeater::NOT_RELEASED) {
+                    repeater.stopFrame = mixedFrames + delay;
+                }
+            }
+            break;
+        }
+        
+        case AudioCommandType::ReleaseAll: {
+            const int delay = frameDelay(command.frame);
+            voicePool.noteOffAll(delay);
+            for (NoteRepeater& repeater : repeaters) {
+                if (repeater.stopFrame == NoteRepeater::NOT_RELEASED) {
+                    repeater.stopFrame = mixedFrames + delay;
+                }
+            }
+            break;
+        }
+        
+        case AudioCommandType::StopRepeats:
+            for (NoteRepeater& repeater : repeaters) {
+                if (repeater.soundId == command.soundId) {
+                    repeater.soundId = -1;
+                }
+            }
+            break;
+        
+        case AudioCommandType::Retune:
+            for (NoteRepeater& repeater : repeaters) {
+                if (repeater.soundId == command.soundId) {
+                    repeater.sample = command.sample;
+                    repeater.playbackRate = command.playbackRate;
+                    repeater.frequency = command.frequency;
+                }
+            }
+            break;
+        
+        case AudioCommandType::SetPosition:
+            voicePool.setPosition(command.soundId, command.azimuth);
+            for (NoteRepeater& repeater : repeaters) {
+                if (repeater.soundId == command.soundId) {
+                    repeater.azimuth = command.azimuth;
+                }
+            }
+            break;
+        
+        case AudioCommandType::SetRepeatInterval:
+            applyRepeatInterval(command.intValue);
+            break;
+        
+        case AudioCommandType::SetStealPolicy:
+            voicePool.setStealPolicy(static_cast<VoiceStealPolicy>(command.intValue));
+            break;
+        
+        case AudioCommandType::SetInterpolation:
+            voicePool.setInterpolation(static_cast<Interpolation>(command.intValue));
+            break;
+        
+        case AudioCommandType::StreamPlay:
+            // Playing again restarts it
+            if (std::find(streams.begin(), streams.end(), command.stream) == streams.end()) {
+                if (streams.size() >= STREAM_CAPACITY) {
+                    break; // Full: it doesn't start
+                }
+                streams.push_back(command.stream);
+            }
+            command.stream->start(command.gain, command.azimuth, voicePool.getLayout());
+            break;
+        
+        case AudioCommandType::StreamStop: {
+            auto it = std::find(streams.begin(), streams.end(), command.stream);
+            if (it != streams.end()) {
+                command.stream->stop();
+                streams.erase(it);
+            }
+            break;
+        }
+    }
+}
+
+void Mixer::startVoice(const WavetableSet& wavetable, const SampleData* sample, double playbackRate, double frequency,
+                       float gain, float azimuth, const EnvelopeParams& envelope, int releaseAt, int soundId,
+                       int delay) {
+    VoiceEvent event;
+    event.type = VoiceEventType::Started;
+    event.slot = voicePool.allocate(wavetable, sample, playbackRate, frequency, gain, azimuth, envelope, releaseAt,
+                                    soundId, delay);
+    event.soundId = soundId;
+    event.frequency = frequency;
+    report(event);
+}
+
+void Mixer::report(const VoiceEvent& event) {
+    if (voiceEvents) {
+        voiceEvents->push(event);
+    }
+}
+
+void Mixer::runRepeaters(int frames) {
+    const Uint64 blockEnd = mixedFrames + frames;
+    
+    for (NoteRepeater& repeater : repeaters) {
+        if (repeater.soundId < 0) continue;
+        
+        // Every retrigger lands on its exact frame, however long the block
+        while (repeater.nextFrame < blockEnd && repeater.nextFrame < repeater.stopFrame) {
+            int offset = repeater.nextFrame > mixedFrames ? static_cast<int>(repeater.nextFrame - mixedFrames) : 0;
+            startVoice(*repeater.wavetable, repeater.sample, repeater.playbackRate, repeater.frequency, repeater.gain,
+                       repeater.azimuth, repeater.envelope, repeater.releaseAt, repeater.soundId, offset);
+            repeater.nextFrame += repeatIntervalFrames;
+        }
+        
+        if (repeater.nextFrame >= repeater.stopFrame) {
+            repeater.soundId = -1;
+        }
+    }
+}
+
+void Mixer::applyRepeatInterval(int interval) {
+    // Keep the time since the last retrigger, like the old tick-based check did
+    for (NoteRepeater& repeater : repeaters) {
+        if (repeater.soundId < 0) continue;
+        Uint64 last = repeater.nextFrame - repeatIntervalFrames;
+        repeater.nextFrame = last + interval > mixedFrames ? last + interval : mixedFrames;
+    }
+    repeatIntervalFrames = interval;
+}
+
+int Mixer::frameDelay(Sint64 frame) const {
+    // Commands that arrive after their frame was mixed act right away
+    Sint64 delay = frame - static_cast<Sint64>(mixedFrames);
+    if (frame == AUDIO_FRAME_NOW || delay < 0) return 0;
+    if (delay > AUDIO_SAMPLE_RATE) return AUDIO_SAMPLE_RATE;
+    return static_cast<int>(delay);
+}
+
+bool Mixer::isSilent() const {
+    if (voicePool.getPlayingCount() > 0 || !streams.empty()) {
+        return false;
+    }
+    for (const NoteRepeater& repeater : repeaters) {
+        if (repeater.soundId >= 0) {
+            return false;
+        }
+    }
+    return true;
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <vector>
+#include "voicePool.hpp"
+#include "audioCommands.hpp"
+#include "spscQueue.hpp"
+
+// A held key retriggering its sound every repeat interval, timed on the mixer's frame clock
+struct NoteRepeater {
+    int soundId;                    // Sound being repeated, -1 = free slot
+    const WavetableSet* wavetable;
+    const SampleData* sample;
+    double playbackRate;
+    double frequency;
+    float gain;
+    float azimuth;
+    EnvelopeParams envelope;
+    int releaseAt;
+    Uint64 nextFrame;               // Output frame of the next retrigger
+    Uint64 stopFrame;               // Frame the key was released at (NOT_RELEASED while held)
+    
+    static const Uint64 NOT_RELEASED = ~0ull;
+};
+
+// Everything that turns commands into samples: the voice pool, the held-key repeaters,
+// the playing streams and the frame clock they run on. Voices are panned into a planar bus of the speaker
+// layout's channels, interleaved once per block on the way out. The audio callback owns one and feeds it from the
+// command queue; the offline renderer owns its own and feeds it from a recording, so
+// both produce the same samples for the same commands. Not thread safe.
+class Mixer {
+private:
+    VoicePool voicePool;
+    std::vector<NoteRepeater> repeaters; // Fixed size, never reallocated
+    std::vector<AudioStream*> streams;   // Playing, at most STREAM_CAPACITY (never reallocated)
+    int repeatIntervalFrames;
+    std::vector<float> bus;              // One planar block, MIX_BLOCK_FRAMES per channel
+    Uint64 mixedFrames = 0;              // Frames mixed so far
+    SpscQueue<VoiceEvent>* voiceEvents;  // Where voice starts/finishes are reported, nullptr = nowhere
+    
+    // Start a voice and report which slot it took
+    void startVoice(const WavetableSet& wavetable, const SampleData* sample, double playbackRate, double frequency,
+                    float gain, float azimuth, const EnvelopeParams& envelope, int releaseAt, int soundId, int delay);
+    
+    // Retrigger the repeaters due in the block starting at mixedFrames
+    void runRepeaters(int frames);
+    
+    // Retime the repeaters for a new interval in frames
+    void applyRepeatInterval(int interval);
+    
+    // Mix (or with out == nullptr, skip) the next block and advance the clock
+    void advance(float* out, int frames);
+    
+    // Report a voice start/finish if anyone listens
+    void report(const VoiceEvent& event);
+    
+    // Frames into the block starting at mixedFrames that a command frame falls on (0 = now or late)
+    int frameDelay(Sint64 frame) const;
+
+public:
+    Mixer(int voiceCapacity, int repeatIntervalFrames, const SpeakerLayout& layout,
+          SpscQueue<VoiceEvent>* voiceEvents = nullptr);
+    
+    // Apply one command at the start of the block at mixedFrames
+    void apply(const AudioCommand& command);
+    
+    // Sum every active voice into the next block (at most MIX_BLOCK_FRAMES frames of getChannels()
+    // interleaved samples) and advance the clock
+    void mix(float* out, int frames) { advance(out, frames); }
+    
+    // Advance through the next block exactly as mix would, without rendering it. Voices start,
+    // retrigger and finish on the same frames, so mixing continues bit-identically afterwards.
+    // Streams are live only (recordings carry none) and stay where they are
+    void skip(int frames) { advance(nullptr, frames); }
+    
+    // Frames mixed so far, i.e. the frame the next block starts at
+    Uint64 getMixedFrames() const { return mixedFrames; }
+    
+    // Share large mixes with these threads (nullptr = mix alone); copies never inherit them
+    void setWorkers(MixWorkers* workers) { voicePool.setWorkers(workers); }
+    
+    // Number of busy voices (safe to read from any thread)
+    int getPlayingCount() const { return voicePool.getPlayingCount(); }
+    int getVoiceCapacity() const { return voicePool.getCapacity(); }
+    int getChannels() const { return voicePool.getChannels(); }
+    
+    // True when nothing is sounding, streaming or about to retrigger
+    bool isSilent() const;
+};
@@ -0,0 +1,174 @@
+#include "offlineRenderer.hpp"
+#include "config.hpp"
+
+OfflineRenderer::OfflineRenderer(int voiceCapacity, int repeatIntervalFrames, const SpeakerLayout& layout)
+    : voiceCapacity(voiceCapacity), repeatIntervalFrames(repeatIntervalFrames), layout(layout) {
+}
+
+void OfflineRenderer::addCommand(const AudioCommand& command, Sint64 frame) {
+    commands.push_back(command);
+    commandFrames.push_back(frame);
+    lastFrame = frame;
+}
+
+int OfflineRenderer::run(Mixer& mixer, size_t& nextCommand, float* out, int frames) const {
+    const Uint64 frameLimit = lastFrame + static_cast<Uint64>(RENDER_TAIL_LIMIT_MS) * AUDIO_SAMPLE_RATE / 1000;
+    int done = 0;
+    
+    while (done < frames) {
+        const Uint64 blockStart = mixer.getMixedFrames();
+        const Sint64 blockEnd = static_cast<Sint64>(blockStart) + MIX_BLOCK_FRAMES;
+        
+        // Every command due in this block, the same ones live playback would send
+        while (nextCommand < commands.size() && commandFrames[nextCommand] < blockEnd) {
+            mixer.apply(commands[nextCommand++]);
+        }
+        
+        // Run until the last note has died away
+        if (nextCommand == commands.size() && static_cast<Sint64>(blockStart) > lastFrame &&
+            (mixer.isSilent() || blockStart >= frameLimit)) {
+            break;
+        }
+        
+        if (out) {
+            mixer.mix(out + static_cast<size_t>(done) * layout.channels, MIX_BLOCK_FRAMES);
+        } else {
+            mixer.skip(MIX_BLOCK_FRAMES);
+        }
+        done += MIX_BLOCK_FRAMES;
+    }
+    return done;
+}
+
+Sint64 OfflineRenderer::render(WavWriter& wav, int threads) {
+    const bool ok = threads > 1 ? renderParallel(wav, threads) : renderSerial(wav);
+    return ok ? static_cast<Sint64>(wav.getFramesWritten()) : -1;
+}
+
+bool OfflineRenderer::renderSerial(WavWriter& wav) {
+    Mixer mixer(voiceCapacity, repeatIntervalFrames, layout);
+    std::vector<float> samples(static_cast<size_t>(RENDER_CHUNK_FRAMES) * layout.channels);
+    size_t nextCommand = 0;
+    
+    int frames;
+    do {
+        frames = run(mixer, nextCommand, samples.data(), RENDER_CHUNK_FRAMES);
+        if (frames > 0 && !wav.write(samples.data(), frames)) {
+            return false;
+        }
+    } while (frames == RENDER_CHUNK_FRAMES);
+    return true;
+}
+
+bool OfflineRenderer::renderParallel(WavWriter& wav, int threads) {
+    // A few chunks per worker in flight keeps everyone busy while the oldest is written
+    chunks.clear();
+    chunks.resize(static_cast<size_t>(threads) * RENDER_CHUNKS_PER_THREAD);
+    chunksReady = 0;
+    chunksClaimed = 0;
+    stopping = false;
+    lock = SDL_CreateMutex();
+    changed = SDL_CreateCondition();
+    
+    std::vector<SDL_Thread*> workers;
+    for (int i = 0; i < threads && lock && changed; i++) {
+        SDL_Thread* worker = SDL_CreateThread(workerMain, "RenderWorker", this);
+        if (!worker) {
+            SDL_Log("Failed to start render worker: %s", SDL_GetError());
+            break;
+        }
+        workers.push_back(worker);
+    }
+    
+    bool ok = !workers.empty();
+    if (!ok) {
+        SDL_Log("No render workers, rendering on one thread");
+    }
+    
+    // The scout walks the timeline without rendering; every chunk starts from its state
+    Mixer scout(voiceCapacity, repeatIntervalFrames, layout);
+    size_t scoutCommand = 0;
+    bool scoutDone = false;
+    size_t chunksWritten = 0;
+    
+    SDL_LockMutex(lock);
+    while (ok && !(scoutDone && chunksWritten == chunksReady)) {
+        Chunk& oldest = chunks[chunksWritten % chunks.size()];
+        
+        if (chunksWritten < chunksReady && oldest.state == Chunk::State::Done) {
+            // Write outside the lock; the slot stays Done until it is written
+            SDL_UnlockMutex(lock);
+            ok = wav.write(oldest.samples.data(), oldest.frames);
+            SDL_LockMutex(lock);
+            oldest.state = Chunk::State::Free;
+            chunksWritten++;
+            SDL_BroadcastCondition(changed);
+        } else if (!scoutDone && chunksReady - chunksWritten < chunks.size()) {
+            SDL_UnlockMutex(lock);
+            std::unique_ptr<Mixer> start = std::make_unique<Mixer>(scout);
+            const size_t firstCommand = scoutCommand;
+            const int frames = run(scout, scoutCommand, nullptr, RENDER_CHUNK_FRAMES);
+            SDL_LockMutex(lock);
+            
+            scoutDone = frames < RENDER_CHUNK_FRAMES;
+            if (frames > 0) {
+                Chunk& chunk = chunks[chunksReady % chunks.size()];
+                chunk.mixer = std::move(start);
+                chunk.firstCommand = firstCommand;
+                chunk.frames = frames;
+                chunk.state = Chunk::State::Ready;
+                chunksReady++;
+                SDL_BroadcastCondition(changed);
+            }
+        } else {
+            SDL_WaitCondition(changed, lock);
+        }
+    }
+    stopping = true;
+    SDL_BroadcastCondition(changed);
+    SDL_UnlockMutex(lock);
+    
+    for (SDL_Thread* worker : workers) {
+        SDL_WaitThread(worker, nullptr);
+    }
+    SDL_DestroyCondition(changed);
+    SDL_DestroyMutex(lock);
+    changed = nullptr;
+    lock = nullptr;
+    chunks.clear();
+    
+    if (workers.empty()) {
+        return renderSerial(wav);
+    }
+    return ok;
+}
+
+int SDLCALL OfflineRenderer::workerMain(void* userdata) {
+    OfflineRenderer* renderer = static_cast<OfflineRenderer*>(userdata);
+    
+    SDL_LockMutex(renderer->lock);
+    while (true) {
+        if (renderer->chunksClaimed < renderer->chunksReady) {
+            Chunk& chunk = renderer->chunks[renderer->chunksClaimed % renderer->chunks.size()];
+            renderer->chunksClaimed++;
+            chunk.state = Chunk::State::Rendering;
+            SDL_UnlockMutex(renderer->lock);
+            
+            // Same blocks from the same state as a single-threaded render
+            chunk.samples.resize(static_cast<size_t>(RENDER_CHUNK_FRAMES) * renderer->layout.channels);
+            size_t nextCommand = chunk.firstCommand;
+            renderer->run(*chunk.mixer, nextCommand, chunk.samples.data(), chunk.frames);
+            chunk.mixer.reset();
+            
+            SDL_LockMutex(renderer->lock);
+            chunk.state = Chunk::State::Done;
+            SDL_BroadcastCondition(renderer->changed);
+        } else if (renderer->stopping) {
+            break;
+        } else {
+            SDL_WaitCondition(renderer->changed, renderer->lock);
+        }
+    }
+    SDL_UnlockMutex(renderer->lock);
+    return 0;
+}
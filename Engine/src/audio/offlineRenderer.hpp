@@ -0,0 +1,62 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "mixer.hpp"
+#include "wavWriter.hpp"
+
+// Renders a timeline of commands to a WAV file without a device, as fast as the CPU allows.
+// Long renders are cut into chunks mixed concurrently: a scout mixer skips ahead through
+// the timeline (no synthesis, a small fraction of the cost) and hands each worker an exact
+// copy of the mixer at its chunk's first frame, so the stitched file is bit-identical to
+// rendering it on one thread.
+class OfflineRenderer {
+private:
+    // One chunk of the output, from the scout's snapshot to the written samples
+    struct Chunk {
+        enum class State { Free, Ready, Rendering, Done };
+        
+        State state = State::Free;
+        std::unique_ptr<Mixer> mixer; // Mixer state at the first frame of the chunk
+        size_t firstCommand = 0;      // First command not yet applied to that state
+        int frames = 0;
+        std::vector<float> samples;   // Interleaved
+    };
+    
+    std::vector<AudioCommand> commands; // In the order they are applied
+    std::vector<Sint64> commandFrames;  // Frame each command is due at, never decreasing
+    int voiceCapacity;
+    int repeatIntervalFrames;
+    const SpeakerLayout& layout;
+    Sint64 lastFrame = 0; // Frame of the last command
+    
+    // Shared between the writer (calling thread) and the workers, under lock
+    std::vector<Chunk> chunks; // Ring of chunks in flight
+    size_t chunksReady = 0;    // Chunks handed out by the scout so far
+    size_t chunksClaimed = 0;  // Chunks a worker has picked up
+    bool stopping = false;
+    SDL_Mutex* lock = nullptr;
+    SDL_Condition* changed = nullptr;
+    
+    // Mix (or with out == nullptr, skip) up to `frames` interleaved frames, applying the commands due
+    // in each block. Returns the frames done, fewer than asked once everything has died away
+    int run(Mixer& mixer, size_t& nextCommand, float* out, int frames) const;
+    
+    bool renderSerial(WavWriter& wav);
+    bool renderParallel(WavWriter& wav, int threads);
+    
+    // Worker thread: render chunks until stopped
+    static int SDLCALL workerMain(void* userdata);
+
+public:
+    OfflineRenderer(int voiceCapacity, int repeatIntervalFrames, const SpeakerLayout& layout);
+    
+    // Append a command; frames must not go backwards
+    void addCommand(const AudioCommand& command, Sint64 frame);
+    
+    // Render the timeline until the last note has died away. threads <= 1 renders on this
+    // thread; otherwise chunks are mixed on that many workers. Returns the frames written, -1 on failure
+    Sint64 render(WavWriter& wav, int threads);
+};
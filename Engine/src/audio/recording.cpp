@@ -0,0 +1,410 @@
+#include "recording.hpp"
+#include "config.hpp"
+#include <cstring>
+#include <fstream>
+
+void writeVarint(std::vector<Uint8>& out, Uint64 value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<Uint8>(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<Uint8>(value));
+}
+
+void writeLE(std::vector<Uint8>& out, Uint64 value, int bytes) {
+    for (int i = 0; i < bytes; i++) {
+        out.push_back(static_cast<Uint8>(value >> (8 * i)));
+    }
+}
+
+Uint64 RecordingReader::readVarint() {
+    Uint64 value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (pos == end) break;
+        const Uint8 byte = *pos++;
+        value |= static_cast<Uint64>(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return value;
+    }
+    failed = true;
+    return 0;
+}
+
+Uint64 RecordingReader::readLE(int bytes) {
+    if (end - pos < bytes) {
+        failed = true;
+        return 0;
+    }
+    Uint64 value = 0;
+    for (int i = 0; i < bytes; i++) {
+        value |= static_cast<Uint64>(pos[i]) << (8 * i);
+    }
+    pos += bytes;
+    return value;
+}
+
+void RecordingEncoder::encode(std::vector<Uint8>& out, const SoundEvent& event, Uint64 nameIndex) {
+    const float clamped = event.volume < 0.0f ? 0.0f : (event.volume > 6.5f ? 6.5f : event.volume);
+    const Uint16 volume = static_cast<Uint16>(clamped * 10000.0f + 0.5f);
+    
+    Uint8 flags = 0;
+    if (event.isKeyDown) flags |= RECORDING_FLAG_KEY_DOWN;
+    if (event.articulation == Articulation::Sustain) flags |= RECORDING_FLAG_SUSTAIN;
+    if (volume != lastVolume) flags |= RECORDING_FLAG_VOLUME;
+    if (event.delay != lastDelay) flags |= RECORDING_FLAG_DELAY;
+    out.push_back(flags);
+    
+    // Zigzag so a timestamp that steps back a little stays one byte
+    const Sint64 delta = static_cast<Sint64>(event.timestamp - lastTimestamp);
+    writeVarint(out, (static_cast<Uint64>(delta) << 1) ^ static_cast<Uint64>(delta >> 63));
+    writeVarint(out, nameIndex);
+    
+    if (flags & RECORDING_FLAG_VOLUME) writeLE(out, volume, 2);
+    if (flags & RECORDING_FLAG_DELAY) writeVarint(out, event.delay > 0 ? event.delay : 0);
+    
+    lastTimestamp = event.timestamp;
+    lastVolume = volume;
+    lastDelay = event.delay;
+}
+
+bool RecordingReader::decodeEvent(Uint8 flags, SoundEvent& event, Uint64& nameIndex) {
+    const Uint64 zigzag = readVarint();
+    nameIndex = readVarint();
+    if (flags & RECORDING_FLAG_VOLUME) event.volume = readLE(2) / 10000.0f;
+    if (flags & RECORDING_FLAG_DELAY) event.delay = static_cast<int>(readVarint());
+    if (failed) {
+        return false;
+    }
+    
+    event.timestamp += static_cast<Uint64>(static_cast<Sint64>(zigzag >> 1) ^ -static_cast<Sint64>(zigzag & 1));
+    event.isKeyDown = (flags & RECORDING_FLAG_KEY_DOWN) != 0;
+    event.articulation = (flags & RECORDING_FLAG_SUSTAIN) ? Articulation::Sustain : Articulation::Repeat;
+    return true;
+}
+
+bool isBinaryRecording(const Uint8* data, size_t size) {
+    return size >= RECORDING_HEADER_SIZE && std::memcmp(data, RECORDING_MAGIC, 4) == 0;
+}
+
+bool saveRecordingBinary(const std::string& filename, const std::vector<SoundEvent>& events,
+                         const std::vector<std::string>& soundNames) {
+    // Only the sounds this recording uses go into the name table
+    std::vector<int> nameIndex(soundNames.size(), -1);
+    std::vector<SoundHandle> usedSounds;
+    for (const SoundEvent& event : events) {
+        if (nameIndex[event.sound] < 0) {
+            nameIndex[event.sound] = static_cast<int>(usedSounds.size());
+            usedSounds.push_back(event.sound);
+        }
+    }
+    
+    std::vector<Uint8> buffer;
+    buffer.reserve(RECORDING_HEADER_SIZE + usedSounds.size() * 8 + events.size() * 4);
+    
+    buffer.insert(buffer.end(), RECORDING_MAGIC, RECORDING_MAGIC + 4);
+    writeLE(buffer, RECORDING_VERSION, 2);
+    writeLE(buffer, 0, 2);
+    writeLE(buffer, usedSounds.size(), 4);
+    writeLE(buffer, events.size(), 8);
+    
+    for (SoundHandle sound : usedSounds) {
+        const std::string& name = soundNames[sound];
+        writeVarint(buffer, name.size());
+        buffer.insert(buffer.end(), name.begin(), name.end());
+    }
+    
+    RecordingEncoder encoder;
+    for (const SoundEvent& event : events) {
+        encoder.encode(buffer, event, nameIndex[event.sound]);
+    }
+    
+    std::ofstream file(filename, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(buffer.data()), static_cast<std::streamsize>(buffer.size()));
+    return file.good();
+}
+
+bool loadRecordingBinary(const Uint8* data, size_t size, const std::map<std::string, SoundHandle>& soundHandles,
+                         std::vector<SoundEvent>& events) {
+    events.clear();
+    if (!isBinaryRecording(data, size)) {
+        return false;
+    }
+    
+    RecordingReader reader = {data + 4, data + size};
+    const Uint64 version = reader.readLE(2);
+    reader.readLE(2);
+    const Uint64 nameCount = reader.readLE(4);
+    const Uint64 eventCount = reader.readLE(8);
+    if (version != RECORDING_VERSION) {
+        SDL_Log("Unsupported recording version %llu", static_cast<unsigned long long>(version));
+        return false;
+    }
+    
+    // Every event takes at least 3 bytes, so a bigger count means a damaged file
+    if (eventCount > size / 3 || nameCount > size) {
+        return false;
+    }
+    
+    // Resolve each name to a handle once
+    std::vector<SoundHandle> handles(nameCount, INVALID_SOUND_HANDLE);
+    std::string name;
+    for (Uint64 i = 0; i < nameCount; i++) {
+        const Uint64 length = reader.readVarint();
+        if (reader.failed || length > static_cast<Uint64>(reader.end - reader.pos)) {
+            return false;
+        }
+        name.assign(reinterpret_cast<const char*>(reader.pos), static_cast<size_t>(length));
+        reader.pos += length;
+        
+        auto it = soundHandles.find(name);
+        if (it != soundHandles.end()) {
+            handles[i] = it->second;
+        } else {
+            SDL_Log("Skipping events for unknown sound: %s", name.c_str());
+        }
+    }
+    
+    events.reserve(static_cast<size_t>(eventCount));
+    SoundEvent event;
+    event.timestamp = 0;
+    event.volume = 1.0f;
+    event.delay = DEFAULT_DELAY_MS;
+    for (Uint64 i = 0; i < eventCount; i++) {
+        if (reader.pos == reader.end) {
+            reader.failed = true;
+            break;
+        }
+        const Uint8 flags = *reader.pos++;
+        Uint64 index;
+        if (!reader.decodeEvent(flags, event, index) || index >= nameCount) {
+            reader.failed = true;
+            break;
+        }
+        event.sound = handles[index];
+        
+        if (event.sound != INVALID_SOUND_HANDLE) {
+            events.push_back(event);
+        }
+    }
+    
+    if (reader.failed) {
+        events.clear();
+        return false;
+    }
+    return true;
+}
+
+Uint32 recordingChecksum(const Uint8* data, size_t size) {
+    Uint32 hash = 2166136261u;
+    for (size_t i = 0; i < size; i++) {
+        hash = (hash ^ data[i]) * 16777619u;
+    }
+    return hash;
+}
+
+bool isRecordingJournal(const Uint8* data, size_t size) {
+    return size >= JOURNAL_HEADER_SIZE && std::memcmp(data, JOURNAL_MAGIC, 4) == 0;
+}
+
+bool loadRecordingJournal(const Uint8* data, size_t size, const std::map<std::string, SoundHandle>& soundHandles,
+                          std::vector<SoundEvent>& events, bool* complete) {
+    events.clear();
+    *complete = false;
+    if (!isRecordingJournal(data, size)) {
+        return false;
+    }
+    
+    RecordingReader header = {data + 4, data + JOURNAL_HEADER_SIZE};
+    const Uint64 version = header.readLE(2);
+    if (version != JOURNAL_VERSION) {
+        SDL_Log("Unsupported journal version %llu", static_cast<unsigned long long>(version));
+        return false;
+    }
+    
+    // Journal sound id -> handle in this session
+    std::vector<SoundHandle> handles;
+    std::string name;
+    
+    SoundEvent event;
+    event.timestamp = 0;
+    event.volume = 1.0f;
+    event.delay = DEFAULT_DELAY_MS;
+    
+    const Uint8* pos = data + JOURNAL_HEADER_SIZE;
+    const Uint8* end = data + size;
+    while (!*complete && end - pos >= JOURNAL_BATCH_HEADER_SIZE) {
+        RecordingReader frame = {pos, pos + JOURNAL_BATCH_HEADER_SIZE};
+        const Uint64 payloadSize = frame.readLE(4);
+        const Uint32 checksum = static_cast<Uint32>(frame.readLE(4));
+        
+        // The first torn or damaged batch ends what can be trusted
+        const Uint8* payload = pos + JOURNAL_BATCH_HEADER_SIZE;
+        if (payloadSize > static_cast<Uint64>(end - payload) ||
+            recordingChecksum(payload, static_cast<size_t>(payloadSize)) != checksum) {
+            break;
+        }
+        pos = payload + payloadSize;
+        
+        RecordingReader reader = {payload, pos};
+        while (reader.pos < reader.end && !reader.failed) {
+            const Uint8 flags = *reader.pos++;
+            
+            if (flags & RECORDING_FLAG_END) {
+                *complete = true;
+                break;
+            }
+            
+            if (flags & RECORDING_FLAG_NAME) {
+                const Uint64 id = reader.readVarint();
+                const Uint64 length = reader.readVarint();
+                if (reader.failed || id > 0xffff || length > static_cast<Uint64>(reader.end - reader.pos)) {
+                    reader.failed = true;
+                    break;
+                }
+                name.assign(reinterpret_cast<const char*>(reader.pos), static_cast<size_t>(length));
+                reader.pos += length;
+                
+                if (id >= handles.size()) handles.resize(static_cast<size_t>(id) + 1, INVALID_SOUND_HANDLE);
+                auto it = soundHandles.find(name);
+                handles[static_cast<size_t>(id)] = it != soundHandles.end() ? it->second : INVALID_SOUND_HANDLE;
+                continue;
+            }
+            
+            Uint64 index;
+            if (!reader.decodeEvent(flags, event, index)) {
+                break;
+            }
+            event.sound = index < handles.size() ? handles[static_cast<size_t>(index)] : INVALID_SOUND_HANDLE;
+            if (event.sound != INVALID_SOUND_HANDLE) {
+                events.push_back(event);
+            }
+        }
+        
+        if (reader.failed) {
+            break;
+        }
+    }
+    
+    return true;
+}
+
+bool saveRecordingCsv(const std::string& filename, const std::vector<SoundEvent>& events,
+                      const std::vector<std::string>& soundNames) {
+    std::ofstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+    
+    // Write a header
+    file << "# Sound Recording - Timestamp(ms),SoundName,Action(D/U),Volume,Delay,Hold(S/R)\n";
+    
+    // Write each event with shortened representations
+    for (const auto& event : events) {
+        // Shorten note and chord names (note1 -> n1, chord1 -> c1)
+        std::string shortName = soundNames[event.sound];
+        if (shortName.find("note") == 0) {
+            shortName = "n" + shortName.substr(4);  // Replace "note" with "n"
+        } else if (shortName.find("chord") == 0) {
+            shortName = "c" + shortName.substr(5);  // Replace "chord" with "c"
+        }
+        
+        file << event.timestamp << "," 
+             << shortName << ","
+             << (event.isKeyDown ? "D" : "U") << ","
+             << event.volume << ","
+             << event.delay << ","
+             << (event.articulation == Articulation::Sustain ? "S" : "R") << '\n';
+    }
+    
+    return file.good();
+}
+
+bool loadRecordingCsv(const std::string& filename, const std::map<std::string, SoundHandle>& soundHandles,
+                      std::vector<SoundEvent>& events) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    // Clear any existing recording
+    events.clear();
+    
+    std::string line;
+    
+    // Skip header line
+    std::getline(file, line);
+    
+    // Read event data
+    while (std::getline(file, line)) {
+        // Skip empty lines
+        if (line.empty()) continue;
+        
+        // Parse CSV format
+        size_t pos1 = line.find(',');
+        size_t pos2 = line.find(',', pos1 + 1);
+        size_t pos3 = line.find(',', pos2 + 1);
+        size_t pos4 = line.find(',', pos3 + 1);
+        size_t pos5 = pos4 != std::string::npos ? line.find(',', pos4 + 1) : std::string::npos;
+        
+        if (pos1 != std::string::npos && pos2 != std::string::npos) {
+            SoundEvent event;
+            event.timestamp = std::stoull(line.substr(0, pos1));
+            
+            // Extract and expand shortened sound name
+            std::string shortName = line.substr(pos1 + 1, pos2 - pos1 - 1);
+            std::string soundName;
+            if (shortName[0] == 'n' && shortName.length() > 1) {
+                soundName = "note" + shortName.substr(1);  // Expand "n1" to "note1"
+            } else if (shortName[0] == 'c' && shortName.length() > 1) {
+                soundName = "chord" + shortName.substr(1);  // Expand "c1" to "chord1"
+            } else {
+                soundName = shortName;  // Keep as is if not matching pattern
+            }
+            
+            // Playback works on handles, so resolve the name once here
+            auto it = soundHandles.find(soundName);
+            if (it == soundHandles.end()) {
+                SDL_Log("Skipping event for unknown sound: %s", soundName.c_str());
+                continue;
+            }
+            event.sound = it->second;
+            
+            // Parse action character
+            std::string action = line.substr(pos2 + 1, pos3 - pos2 - 1);
+            event.isKeyDown = (action == "D");
+            
+            // Parse volume data
+            try {
+                event.volume = std::stof(line.substr(pos3 + 1, pos4 - pos3 - 1));
+            }
+            catch(...) {
+                event.volume = 1.0f; // Default volume if parsing fails
+            }
+            
+            // Parse delay data if available
+            try {
+                if (pos4 != std::string::npos) {
+                    event.delay = std::stoi(line.substr(pos4 + 1));
+                } else {
+                    event.delay = DEFAULT_DELAY_MS; // Use default if not specified
+                }
+            }
+            catch(...) {
+                event.delay = DEFAULT_DELAY_MS; // Default delay if parsing fails
+            }
+            
+            // Parse held-key behaviour; older recordings were all made with retriggering keys
+            event.articulation = Articulation::Repeat;
+            if (pos5 != std::string::npos && line.compare(pos5 + 1, 1, "S") == 0) {
+                event.articulation = Articulation::Sustain;
+            }
+            
+            // Add event to the collection
+            events.push_back(event);
+        }
+    }
+    
+    return true;
+}
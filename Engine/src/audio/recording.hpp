@@ -0,0 +1,109 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "config.hpp"
+#include "sound.hpp"
+
+// What a key does while it is held down
+enum class Articulation {
+    Sustain, // One voice that holds until key-up, then enters its release
+    Repeat   // Retrigger the sound every currentDelay ms until key-up
+};
+
+// Structure to record sound events
+struct SoundEvent {
+    SoundHandle sound;
+    Uint64 timestamp;
+    bool isKeyDown; // true for key down, false for key up
+    float volume;   // Store volume level with each event
+    int delay;      // Store the current delay setting
+    Articulation articulation; // Held-key behaviour at key down
+};
+
+// Binary recording (.srec), little-endian:
+//   header   "SREC", Uint16 version, Uint16 reserved, Uint32 name count, Uint64 event count
+//   names    varint length + bytes, one per sound the events use
+//   events   Uint8 flags, varint zigzag timestamp delta (ms), varint name index,
+//            then Uint16 volume * 10000 if RECORDING_FLAG_VOLUME, varint delay (ms) if RECORDING_FLAG_DELAY.
+// Volume and delay are only stored when they change, so a typical event is 3 bytes.
+#define RECORDING_MAGIC "SREC"
+#define RECORDING_VERSION 1
+#define RECORDING_HEADER_SIZE 20
+#define RECORDING_FLAG_KEY_DOWN 0x01
+#define RECORDING_FLAG_SUSTAIN 0x02
+#define RECORDING_FLAG_VOLUME 0x04
+#define RECORDING_FLAG_DELAY 0x08
+
+// Carries the previous event's timestamp, volume and delay from one event record to the next
+struct RecordingEncoder {
+    Uint64 lastTimestamp = 0;
+    Uint16 lastVolume = 10000;
+    int lastDelay = DEFAULT_DELAY_MS;
+    
+    // Append one event record; nameIndex is the event's entry in the file's name table
+    void encode(std::vector<Uint8>& out, const SoundEvent& event, Uint64 nameIndex);
+};
+
+// Bounds-checked reader for the binary formats
+struct RecordingReader {
+    const Uint8* pos;
+    const Uint8* end;
+    bool failed = false;
+    
+    // Reads past the end set failed and return 0
+    Uint64 readVarint();
+    Uint64 readLE(int bytes);
+    
+    // Decode the rest of an event record whose flags byte was already read.
+    // event keeps the running timestamp, volume and delay between calls
+    bool decodeEvent(Uint8 flags, SoundEvent& event, Uint64& nameIndex);
+};
+
+void writeVarint(std::vector<Uint8>& out, Uint64 value);
+void writeLE(std::vector<Uint8>& out, Uint64 value, int bytes);
+
+// Recording journal, appended to while recording (see RecordingJournal), little-endian:
+//   header   "SJNL", Uint16 version, Uint16 reserved
+//   batches  Uint32 payload size, Uint32 FNV-1a of the payload, payload
+//   payload  event records as in .srec, with the journal's sound id as name index;
+//            RECORDING_FLAG_NAME, varint id, varint length, bytes: names a sound id;
+//            RECORDING_FLAG_END: the recording was stopped cleanly.
+// A batch cut short by a crash fails its checksum; everything before it is recovered.
+#define JOURNAL_MAGIC "SJNL"
+#define JOURNAL_VERSION 1
+#define JOURNAL_HEADER_SIZE 8
+#define JOURNAL_BATCH_HEADER_SIZE 8
+#define RECORDING_FLAG_END 0x40
+#define RECORDING_FLAG_NAME 0x80
+
+// FNV-1a, used to spot torn journal batches
+Uint32 recordingChecksum(const Uint8* data, size_t size);
+
+// Whether a file starts like a recording journal
+bool isRecordingJournal(const Uint8* data, size_t size);
+
+// Recover the events of a journal up to its first damaged batch.
+// complete tells whether the recording was stopped cleanly
+bool loadRecordingJournal(const Uint8* data, size_t size, const std::map<std::string, SoundHandle>& soundHandles,
+                          std::vector<SoundEvent>& events, bool* complete);
+
+// Whether a file starts like a binary recording
+bool isBinaryRecording(const Uint8* data, size_t size);
+
+// Encode events into one buffer and write it with a single call
+bool saveRecordingBinary(const std::string& filename, const std::vector<SoundEvent>& events,
+                         const std::vector<std::string>& soundNames);
+
+// Decode a binary recording already in memory (e.g. a MappedFile). Names resolve to
+// handles once per file; events for unknown sounds are skipped
+bool loadRecordingBinary(const Uint8* data, size_t size, const std::map<std::string, SoundHandle>& soundHandles,
+                         std::vector<SoundEvent>& events);
+
+// Text recording: Timestamp(ms),SoundName,Action(D/U),Volume,Delay,Hold(S/R), one event per line
+bool saveRecordingCsv(const std::string& filename, const std::vector<SoundEvent>& events,
+                      const std::vector<std::string>& soundNames);
+bool loadRecordingCsv(const std::string& filename, const std::map<std::string, SoundHandle>& soundHandles,
+                      std::vector<SoundEvent>& events);
@@ -0,0 +1,214 @@
+#include "recordingJournal.hpp"
+#include <cstring>
+
+std::string getJournalSessionPath(const std::string& directory, Uint32 session) {
+    char name[64];
+    SDL_snprintf(name, sizeof(name), RECORDING_JOURNAL_FILE, static_cast<unsigned>(session % JOURNAL_FILE_COUNT));
+    return directory + name;
+}
+
+RecordingJournal::RecordingJournal()
+    : queue(JOURNAL_QUEUE_CAPACITY), thread(nullptr), stopRequested(false), finishedSession(0), failedSession(0),
+      writtenEvents(0), droppedEvents(0), sessionOpen(false), writerSession(0), fileOk(false), dirty(false),
+      lastSyncNS(0), batchEvents(0) {
+}
+
+RecordingJournal::~RecordingJournal() {
+    stop();
+}
+
+bool RecordingJournal::start(const std::string& journalDirectory, Uint32 session) {
+    if (!thread) {
+        directory = journalDirectory;
+        stopRequested.store(false, std::memory_order_relaxed);
+        thread = SDL_CreateThread(writerMain, "RecordingJournal", this);
+        if (!thread) {
+            SDL_Log("Failed to start the recording journal: %s", SDL_GetError());
+            return false;
+        }
+    }
+    
+    JournalRecord record = {};
+    record.type = JournalRecordType::Start;
+    record.session = session;
+    push(record, true);
+    sessionOpen = true;
+    return true;
+}
+
+void RecordingJournal::defineSound(SoundHandle sound, const std::string& name) {
+    JournalRecord record = {};
+    record.type = JournalRecordType::Name;
+    record.event.sound = sound;
+    SDL_strlcpy(record.name, name.c_str(), sizeof(record.name));
+    push(record, true);
+}
+
+bool RecordingJournal::append(const SoundEvent& event) {
+    JournalRecord record = {};
+    record.type = JournalRecordType::Event;
+    record.event = event;
+    if (push(record, !event.isKeyDown)) {
+        return true;
+    }
+    droppedEvents++;
+    return false;
+}
+
+void RecordingJournal::finish() {
+    if (!sessionOpen) {
+        return;
+    }
+    
+    JournalRecord record = {};
+    record.type = JournalRecordType::Finish;
+    push(record, true);
+    sessionOpen = false;
+}
+
+bool RecordingJournal::push(const JournalRecord& record, bool required) {
+    // Nothing overtakes a held-back record, so the writer sees everything in order
+    pump();
+    if (backlog.empty() && queue.push(record)) {
+        return true;
+    }
+    if (required) {
+        backlog.push_back(record);
+        return true;
+    }
+    return false;
+}
+
+void RecordingJournal::pump() {
+    size_t moved = 0;
+    while (moved < backlog.size() && !queue.isFull()) {
+        queue.push(backlog[moved]);
+        moved++;
+    }
+    backlog.erase(backlog.begin(), backlog.begin() + moved);
+}
+
+void RecordingJournal::stop() {
+    if (!thread) {
+        return;
+    }
+    
+    finish();
+    while (!backlog.empty()) {
+        pump();
+        SDL_Delay(1);
+    }
+    stopRequested.store(true, std::memory_order_release);
+    SDL_WaitThread(thread, nullptr);
+    thread = nullptr;
+}
+
+int SDLCALL RecordingJournal::writerMain(void* userdata) {
+    static_cast<RecordingJournal*>(userdata)->run();
+    return 0;
+}
+
+void RecordingJournal::openSession(Uint32 session) {
+    writerSession = session;
+    encoder = RecordingEncoder();
+    batch.assign(JOURNAL_BATCH_HEADER_SIZE, 0);
+    batchEvents = 0;
+    dirty = false;
+    lastSyncNS = SDL_GetTicksNS();
+    writtenEvents.store(0, std::memory_order_relaxed);
+    
+    fileOk = file.open(getJournalSessionPath(directory, session));
+    if (fileOk) {
+        std::vector<Uint8> header;
+        header.reserve(JOURNAL_HEADER_SIZE);
+        header.insert(header.end(), JOURNAL_MAGIC, JOURNAL_MAGIC + 4);
+        writeLE(header, JOURNAL_VERSION, 2);
+        writeLE(header, 0, 2);
+        fileOk = file.write(header.data(), header.size()) && file.sync();
+    }
+}
+
+void RecordingJournal::writeBatch() {
+    if (batch.size() <= JOURNAL_BATCH_HEADER_SIZE) {
+        return;
+    }
+    
+    // One write per batch: size and checksum in front of the records
+    if (fileOk) {
+        const Uint32 payloadSize = static_cast<Uint32>(batch.size() - JOURNAL_BATCH_HEADER_SIZE);
+        const Uint32 checksum = recordingChecksum(batch.data() + JOURNAL_BATCH_HEADER_SIZE, payloadSize);
+        for (int i = 0; i < 4; i++) {
+            batch[i] = static_cast<Uint8>(payloadSize >> (8 * i));
+            batch[4 + i] = static_cast<Uint8>(checksum >> (8 * i));
+        }
+        fileOk = file.write(batch.data(), batch.size());
+        dirty = true;
+        writtenEvents.fetch_add(batchEvents, std::memory_order_relaxed);
+    }
+    batch.assign(JOURNAL_BATCH_HEADER_SIZE, 0);
+    batchEvents = 0;
+}
+
+void RecordingJournal::closeSession() {
+    batch.push_back(RECORDING_FLAG_END);
+    writeBatch();
+    if (fileOk && dirty) {
+        fileOk = file.sync();
+    }
+    file.close();
+    
+    if (!fileOk) {
+        failedSession.store(writerSession, std::memory_order_relaxed);
+    }
+    finishedSession.store(writerSession, std::memory_order_release);
+    writerSession = 0;
+}
+
+void RecordingJournal::run() {
+    batch.reserve(JOURNAL_QUEUE_CAPACITY * 4);
+    
+    for (;;) {
+        // Read the flag first, so every record pushed before stop() is drained below
+        const bool stopping = stopRequested.load(std::memory_order_acquire);
+        
+        JournalRecord record;
+        while (queue.pop(record)) {
+            switch (record.type) {
+                case JournalRecordType::Start:
+                    openSession(record.session);
+                    break;
+                case JournalRecordType::Name: {
+                    const size_t length = SDL_strlen(record.name);
+                    batch.push_back(RECORDING_FLAG_NAME);
+                    writeVarint(batch, static_cast<Uint64>(record.event.sound));
+                    writeVarint(batch, length);
+                    batch.insert(batch.end(), record.name, record.name + length);
+                    break;
+                }
+                case JournalRecordType::Event:
+                    encoder.encode(batch, record.event, static_cast<Uint64>(record.event.sound));
+                    batchEvents++;
+                    break;
+                case JournalRecordType::Finish:
+                    closeSession();
+                    break;
+            }
+        }
+        
+        if (writerSession != 0) {
+            writeBatch();
+            
+            const Uint64 nowNS = SDL_GetTicksNS();
+            if (fileOk && dirty && nowNS - lastSyncNS >= SDL_MS_TO_NS(JOURNAL_SYNC_MS)) {
+                fileOk = file.sync();
+                lastSyncNS = nowNS;
+                dirty = false;
+            }
+        }
+        
+        if (stopping) {
+            break;
+        }
+        SDL_Delay(JOURNAL_FLUSH_MS);
+    }
+}
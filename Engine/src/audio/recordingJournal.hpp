@@ -0,0 +1,110 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <atomic>
+#include <string>
+#include <vector>
+#include "config.hpp"
+#include "recording.hpp"
+#include "spscQueue.hpp"
+#include "../platform/appendFile.hpp"
+
+// What a journal record tells the writer
+enum class JournalRecordType : Uint8 {
+    Start,  // Open the file of a new session (session)
+    Name,   // Name a sound id (event.sound, name)
+    Event,  // A key event
+    Finish  // End marker, sync and close the session's file
+};
+
+// One entry on its way to the journal
+struct JournalRecord {
+    JournalRecordType type;
+    Uint32 session;                // Start records only
+    SoundEvent event;              // event.sound is the id for names and events
+    char name[JOURNAL_NAME_MAX];   // Name records only, NUL-terminated (longer names are cut)
+};
+
+// File a journal session is written to in directory. Sessions alternate between
+// JOURNAL_FILE_COUNT files, so the last finished one stays on disk while the next is written
+std::string getJournalSessionPath(const std::string& directory, Uint32 session);
+
+// Streams a recording to disk while it is being made. The UI thread only pushes
+// records into a bounded lock-free queue; one writer thread, started with the first
+// session and kept until stop(), drains it every JOURNAL_FLUSH_MS into one checksummed
+// batch per write and calls fdatasync every JOURNAL_SYNC_MS, so a crash loses at most
+// the last unsynced moment of a session. Sessions follow each other through the queue,
+// so starting one never waits for the previous one to reach the disk.
+// See recording.hpp for the file layout and loadRecordingJournal for recovery.
+class RecordingJournal {
+private:
+    SpscQueue<JournalRecord> queue;   // UI -> writer
+    std::string directory;            // Set before the writer starts, read by it
+    SDL_Thread* thread;
+    std::atomic<bool> stopRequested;
+    std::atomic<Uint32> finishedSession; // Last session the writer closed, 0 = none yet
+    std::atomic<Uint32> failedSession;   // Last session whose file could not be written
+    std::atomic<Uint64> writtenEvents;   // Events of the current session on disk
+    
+    // UI thread only
+    std::vector<JournalRecord> backlog; // Records that must not be lost, waiting for room in the queue
+    Uint64 droppedEvents;
+    bool sessionOpen;
+    
+    // Writer thread only
+    AppendFile file;
+    Uint32 writerSession;             // Session being written, 0 = none
+    bool fileOk;                      // Opening and every write of the session succeeded
+    bool dirty;                       // Written since the last sync
+    Uint64 lastSyncNS;
+    std::vector<Uint8> batch;
+    Uint64 batchEvents;
+    RecordingEncoder encoder;
+    
+    static int SDLCALL writerMain(void* userdata);
+    
+    // Queue a record, behind any held back. Required ones are held back when the queue is full,
+    // the others are dropped (false)
+    bool push(const JournalRecord& record, bool required);
+    
+    // Writer thread body
+    void run();
+    void openSession(Uint32 session);
+    void writeBatch();
+    void closeSession();
+
+public:
+    RecordingJournal();
+    ~RecordingJournal();
+    
+    RecordingJournal(const RecordingJournal&) = delete;
+    RecordingJournal& operator=(const RecordingJournal&) = delete;
+    
+    // Start session number `session` (counting up from 1) in directory, which the first
+    // call fixes. The writer truncates the session's file once the previous one is closed;
+    // this never waits for it
+    bool start(const std::string& directory, Uint32 session);
+    
+    // Name a sound id before its first event (UI thread, never blocks, never dropped)
+    void defineSound(SoundHandle sound, const std::string& name);
+    
+    // Queue an event (UI thread, never blocks). Key-ups are never dropped, or the note would
+    // hang on playback; a key-down is dropped (false) when the writer is behind
+    bool append(const SoundEvent& event);
+    
+    // End the session; the writer flushes, syncs and closes it in the background
+    void finish();
+    
+    // Hand held-back records to the writer once the queue has room (UI thread, every frame)
+    void pump();
+    
+    // Finish any open session, wait for the writer to write it and exit
+    void stop();
+    
+    // Whether session's file is complete on disk (or failed)
+    bool isFinished(Uint32 session) const { return finishedSession.load(std::memory_order_acquire) >= session; }
+    bool hasFailed(Uint32 session) const { return failedSession.load(std::memory_order_relaxed) == session; }
+    
+    Uint64 getWrittenCount() const { return writtenEvents.load(std::memory_order_relaxed); }
+    Uint64 getDroppedCount() const { return droppedEvents; }
+};
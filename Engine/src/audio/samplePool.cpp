@@ -0,0 +1,134 @@
+#include "samplePool.hpp"
+#include <algorithm>
+#include "audioDecoder.hpp"
+#include "config.hpp"
+
+SampleData::SampleData(const float* interleaved, Uint64 frames, int channels, int sampleRate,
+                       const std::string& filePath)
+    : frameCount(static_cast<int>(std::min<Uint64>(frames, SDL_MAX_SINT32 - 2 * SAMPLE_GUARD_FRAMES))),
+      rate(sampleRate), path(filePath) {
+    const size_t total = static_cast<size_t>(frameCount) + 2 * SAMPLE_GUARD_FRAMES;
+    const size_t bytes = (total * sizeof(float) + SAMPLE_ALIGNMENT - 1) / SAMPLE_ALIGNMENT * SAMPLE_ALIGNMENT;
+    allocation = static_cast<float*>(SDL_aligned_alloc(SAMPLE_ALIGNMENT, bytes));
+    if (!allocation) {
+        SDL_Log("Out of memory for sample %s (%d frames)", path.c_str(), frameCount);
+        frameCount = 0;
+        samples = nullptr;
+        return;
+    }
+    SDL_memset(allocation, 0, bytes);
+    
+    // Voices are panned after rendering, so a sample's own channels are averaged to one
+    float* out = allocation + SAMPLE_GUARD_FRAMES;
+    const float scale = 1.0f / static_cast<float>(channels);
+    for (int i = 0; i < frameCount; i++) {
+        const float* frame = interleaved + static_cast<size_t>(i) * channels;
+        float sum = 0.0f;
+        for (int c = 0; c < channels; c++) {
+            sum += frame[c];
+        }
+        out[i] = sum * scale;
+    }
+    samples = out;
+}
+
+SampleData::~SampleData() {
+    SDL_aligned_free(allocation);
+}
+
+void SamplePool::decodeAll(DecodeJob& job) {
+    const int count = static_cast<int>(job.paths->size());
+    for (int i = SDL_AddAtomicInt(&job.next, 1); i < count; i = SDL_AddAtomicInt(&job.next, 1)) {
+        const std::string& path = (*job.paths)[i];
+        DecodedAudio audio;
+        if (!decodeAudioFile(path, audio) || audio.channels <= 0 || audio.sampleRate <= 0) {
+            SDL_Log("Failed to decode sample: %s", path.c_str());
+            continue;
+        }
+        
+        std::shared_ptr<SampleData> sample =
+            std::make_shared<SampleData>(audio.samples, audio.frames, audio.channels, audio.sampleRate, path);
+        if (sample->getSamples()) {
+            (*job.results)[i] = std::move(sample);
+        }
+    }
+}
+
+int SDLCALL SamplePool::decodeWorker(void* userdata) {
+    decodeAll(*static_cast<DecodeJob*>(userdata));
+    return 0;
+}
+
+std::vector<SampleRef> SamplePool::load(const std::vector<std::string>& paths, int threads) {
+    std::vector<SampleRef> results(paths.size());
+    
+    // Files already held are shared; each missing one is decoded once even if listed twice
+    std::vector<std::string> missing;
+    for (size_t i = 0; i < paths.size(); i++) {
+        auto it = loaded.find(paths[i]);
+        if (it != loaded.end()) {
+            results[i] = it->second.lock();
+        }
+        if (!results[i] && std::find(missing.begin(), missing.end(), paths[i]) == missing.end()) {
+            missing.push_back(paths[i]);
+        }
+    }
+    
+    if (!missing.empty()) {
+        std::vector<SampleRef> decoded(missing.size());
+        DecodeJob job;
+        job.paths = &missing;
+        job.results = &decoded;
+        SDL_SetAtomicInt(&job.next, 0);
+        
+        // The calling thread decodes too; the extra threads only help with the rest
+        if (threads <= 0) {
+            threads = SDL_GetNumLogicalCPUCores();
+        }
+        threads = std::min(threads, static_cast<int>(missing.size()));
+        std::vector<SDL_Thread*> workers;
+        for (int i = 1; i < threads; i++) {
+            SDL_Thread* worker = SDL_CreateThread(decodeWorker, "SampleDecoder", &job);
+            if (!worker) {
+                SDL_Log("Failed to start sample decoder: %s", SDL_GetError());
+                break;
+            }
+            workers.push_back(worker);
+        }
+        decodeAll(job);
+        for (SDL_Thread* worker : workers) {
+            SDL_WaitThread(worker, nullptr);
+        }
+        
+        for (size_t i = 0; i < missing.size(); i++) {
+            if (decoded[i]) {
+                loaded[missing[i]] = decoded[i];
+            }
+        }
+        for (size_t i = 0; i < paths.size(); i++) {
+            if (!results[i]) {
+                results[i] = decoded[std::find(missing.begin(), missing.end(), paths[i]) - missing.begin()];
+            }
+        }
+    }
+    
+    // Forget the entries nobody holds any more
+    for (auto it = loaded.begin(); it != loaded.end();) {
+        it = it->second.expired() ? loaded.erase(it) : std::next(it);
+    }
+    return results;
+}
+
+SampleRef SamplePool::load(const std::string& path) {
+    return load(std::vector<std::string>{path}, 1)[0];
+}
+
+int SamplePool::getLoadedCount() const {
+    int count = 0;
+    for (const auto& entry : loaded) {
+        if (!entry.second.expired()) {
+            count++;
+        }
+    }
+    return count;
+}
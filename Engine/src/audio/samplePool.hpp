@@ -0,0 +1,63 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+// One decoded sample, mono at its own rate. Immutable once built, so any number of voices
+// on any thread read it in place; a note-on copies a pointer, never the frames. The frames
+// start on a SAMPLE_ALIGNMENT boundary with SAMPLE_GUARD_FRAMES of silence on both sides,
+// so interpolation can read past either end without checks.
+class SampleData {
+private:
+    float* allocation; // Guard, frames, guard
+    const float* samples;
+    int frameCount;
+    int rate;
+    std::string path;
+
+public:
+    // Downmix `frames` interleaved frames of `channels` channels
+    SampleData(const float* interleaved, Uint64 frames, int channels, int sampleRate, const std::string& path);
+    ~SampleData();
+    
+    SampleData(const SampleData&) = delete;
+    SampleData& operator=(const SampleData&) = delete;
+    
+    const float* getSamples() const { return samples; }
+    int getFrames() const { return frameCount; }
+    int getSampleRate() const { return rate; }
+    const std::string& getPath() const { return path; }
+};
+
+typedef std::shared_ptr<const SampleData> SampleRef;
+
+// Decoded samples shared by every instrument that uses them. A file is decoded once for
+// as long as anything holds a reference to it; loading it again returns the same data.
+// Load on the UI thread only, the audio thread just reads the samples.
+class SamplePool {
+private:
+    std::map<std::string, std::weak_ptr<const SampleData>> loaded; // Path -> data, while referenced
+    
+    // What the decode threads share
+    struct DecodeJob {
+        const std::vector<std::string>* paths;
+        std::vector<SampleRef>* results;
+        SDL_AtomicInt next; // Next path to claim
+    };
+    static int SDLCALL decodeWorker(void* userdata);
+    static void decodeAll(DecodeJob& job);
+
+public:
+    // Decode every path not already in the pool, spread across threads (0 = one per logical
+    // core). Returns the samples in the same order, nullptr for files that failed
+    std::vector<SampleRef> load(const std::vector<std::string>& paths, int threads = 0);
+    
+    // Decode one file (or return the copy already loaded), nullptr if it failed
+    SampleRef load(const std::string& path);
+    
+    // Files currently held by someone
+    int getLoadedCount() const;
+};
@@ -0,0 +1,101 @@
+#include "samplerInstrument.hpp"
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include "config.hpp"
+
+SamplerInstrument::SamplerInstrument() : zoneTable(SAMPLER_KEYS * SAMPLER_VELOCITIES, -1) {
+}
+
+bool SamplerInstrument::addZone(const SampleZone& zone) {
+    if (!zone.sample || zones.size() >= SDL_MAX_SINT16) {
+        return false;
+    }
+    
+    const Sint16 index = static_cast<Sint16>(zones.size());
+    zones.push_back(zone);
+    
+    const int lowKey = std::max(zone.lowKey, 0);
+    const int highKey = std::min(zone.highKey, SAMPLER_KEYS - 1);
+    const int lowVelocity = std::max(zone.lowVelocity, 1);
+    const int highVelocity = std::min(zone.highVelocity, SAMPLER_VELOCITIES - 1);
+    for (int key = lowKey; key <= highKey; key++) {
+        for (int velocity = lowVelocity; velocity <= highVelocity; velocity++) {
+            Sint16& cell = zoneTable[key * SAMPLER_VELOCITIES + velocity];
+            if (cell < 0) {
+                cell = index;
+            }
+        }
+    }
+    return true;
+}
+
+const SampleZone* SamplerInstrument::findZone(int key, int velocity) const {
+    if (key < 0 || key >= SAMPLER_KEYS || velocity < 0 || velocity >= SAMPLER_VELOCITIES) {
+        return nullptr;
+    }
+    const Sint16 index = zoneTable[key * SAMPLER_VELOCITIES + velocity];
+    return index >= 0 ? &zones[index] : nullptr;
+}
+
+bool SamplerInstrument::loadFromFile(const std::string& filename, SamplePool& pool) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        SDL_Log("No sampler instrument at %s", filename.c_str());
+        return false;
+    }
+    
+    const size_t slash = filename.find_last_of("/\\");
+    const std::string directory = slash != std::string::npos ? filename.substr(0, slash + 1) : "";
+    
+    // Read every zone first, so all the files decode in one parallel batch
+    std::vector<SampleZone> pending;
+    std::vector<std::string> paths;
+    std::string line;
+    while (std::getline(file, line)) {
+        // Skip comments and blank lines
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        if (line.empty() || line[0] == '#') continue;
+        
+        std::istringstream fields(line);
+        std::string path;
+        SampleZone zone = {};
+        zone.lowVelocity = 1;
+        zone.highVelocity = SAMPLER_VELOCITIES - 1;
+        zone.gain = 1.0f;
+        if (!(fields >> path >> zone.lowKey >> zone.highKey >> zone.rootKey)) {
+            SDL_Log("Invalid sampler zone: %s", line.c_str());
+            continue;
+        }
+        if (fields >> zone.lowVelocity >> zone.highVelocity) {
+            fields >> zone.gain;
+        }
+        
+        pending.push_back(zone);
+        paths.push_back(directory + path);
+    }
+    
+    const Uint64 start = SDL_GetTicksNS();
+    std::vector<SampleRef> samples = pool.load(paths, SAMPLE_DECODE_THREADS);
+    for (size_t i = 0; i < pending.size(); i++) {
+        pending[i].sample = samples[i];
+        addZone(pending[i]);
+    }
+    
+    SDL_Log("Loaded sampler instrument %s: %d zones from %d files in %.1f ms", filename.c_str(),
+            getZoneCount(), static_cast<int>(paths.size()), (SDL_GetTicksNS() - start) / 1e6);
+    return !zones.empty();
+}
+
+int SamplerInstrument::frequencyToKey(double frequency) {
+    if (frequency <= 0.0) {
+        return 0;
+    }
+    const int key = static_cast<int>(std::lround(69.0 + 12.0 * std::log2(frequency / 440.0)));
+    return std::clamp(key, 0, SAMPLER_KEYS - 1);
+}
+
+double SamplerInstrument::keyToFrequency(int key) {
+    return 440.0 * std::pow(2.0, (key - 69) / 12.0);
+}
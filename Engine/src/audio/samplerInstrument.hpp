@@ -0,0 +1,52 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <string>
+#include <vector>
+#include "samplePool.hpp"
+
+#define SAMPLER_KEYS 128       // MIDI keys 0-127, 60 = middle C, 69 = A4 (440 Hz)
+#define SAMPLER_VELOCITIES 128 // Velocities 1-127 (0 never plays)
+
+// A key and velocity region of an instrument and the sample it plays
+struct SampleZone {
+    SampleRef sample;
+    int lowKey;        // Keys covered, inclusive
+    int highKey;
+    int lowVelocity;   // Velocities covered, inclusive
+    int highVelocity;
+    int rootKey;       // Key the sample sounds at its recorded pitch
+    float gain;
+};
+
+// A sampled instrument: zones over the keyboard and the velocity range, all reading
+// samples from a shared SamplePool. Every (key, velocity) cell is resolved to its zone
+// when zones are added, so a note-on finds its sample with one table read.
+class SamplerInstrument {
+private:
+    std::vector<SampleZone> zones;
+    std::vector<Sint16> zoneTable; // [key * SAMPLER_VELOCITIES + velocity] -> zone, -1 = none
+
+public:
+    SamplerInstrument();
+    
+    // Add a zone. Where zones overlap, the one added first keeps the cells
+    bool addZone(const SampleZone& zone);
+    
+    // Zone that plays a key at a velocity, nullptr if none covers it
+    const SampleZone* findZone(int key, int velocity) const;
+    
+    // Read an instrument file, one zone per line:
+    //   file lowKey highKey rootKey [lowVelocity highVelocity [gain]]
+    // with files relative to the instrument file. Every file is decoded through the pool
+    // at once, in parallel. Returns false if the file can't be read or gives no zone
+    bool loadFromFile(const std::string& filename, SamplePool& pool);
+    
+    int getZoneCount() const { return static_cast<int>(zones.size()); }
+    
+    // Nearest key to a frequency, clamped to 0-127
+    static int frequencyToKey(double frequency);
+    
+    // Frequency of a key in equal temperament
+    static double keyToFrequency(int key);
+};
@@ -3,45 +3,61 @@
 #include <SDL3/SDL.h>
 #include <cmath>
 #include <string>
+#include "config.hpp"
+#include "envelope.hpp"
+#include "samplerInstrument.hpp"
+#include "wavetable.hpp"
 
 #ifndef M_PI
 #define M_PI 3.14159265358979323846
 #endif
 
-// Sound structure to manage individual sounds
+// Dense index of a registered sound, handed out by SoundManager::addSound.
+// Everything from key press to voice works on handles; names are only for files and logs.
+typedef int SoundHandle;
+#define INVALID_SOUND_HANDLE (-1)
+
+// Sound template: the parameters a voice is started with.
+// Nothing is rendered up front; voices synthesize the note block by block.
 class Sound {
 private:
-    SDL_AudioStream* stream;
+    SoundHandle id; // Identifies the voices started from this template
     double frequency;
     float gain;
-    bool playing;
-    Uint64 startTime;
-    int durationMs;
-    int fadeMs; // Fade out time in milliseconds
-    
-    // Apply amplitude envelope to the sample (fadeIn/fadeOut)
-    float applyEnvelope(int sampleIndex, int totalSamples, float value);
+    int durationMs; // Total length including the release; 0 = hold until released
+    int fadeMs;     // Release time in milliseconds
+    Waveform waveform;
+    float azimuth = 0.0f; // Position in degrees, 0 = straight ahead, positive to the right
+    const SamplerInstrument* instrument = nullptr; // Plays the zone for its key instead of the waveform
+    int velocity = SAMPLER_DEFAULT_VELOCITY;       // Picks the zone among velocity layers
     
-    // Fill the stream with sine wave data with smooth envelope
-    void generateSineWave(int durationMs);
+    // Envelope shape in front of the release
+    int attackMs = DEFAULT_ATTACK_MS;
+    int decayMs = 0;
+    float sustainLevel = 1.0f;
+    EnvelopeCurve curve = EnvelopeCurve::Linear;
     
 public:
-    Sound(SDL_AudioDeviceID deviceId, double freq, float gain = 0.3f, int durMs = 0, int fadeoutMs = 100);
-    ~Sound();
-    
-    // Start playing the sound
-    void play(int durationMs = 0);
-    
-    // Update playing state
-    void update();
+    Sound(SoundHandle id, double freq, float gain = 0.3f, int durMs = 0, int fadeoutMs = 100, Waveform wave = Waveform::Sine);
     
     // Getters for sound properties
+    SoundHandle getId() const { return id; }
     double getFrequency() const { return frequency; }
     float getGain() const { return gain; }
-    bool isPlaying() const { return playing; }
     int getDuration() const { return durationMs; }
     int getFadeTime() const { return fadeMs; }
+    Waveform getWaveform() const { return waveform; }
+    float getAzimuth() const { return azimuth; }
+    const SamplerInstrument* getInstrument() const { return instrument; }
+    int getVelocity() const { return velocity; }
+    bool isHeld() const { return durationMs == 0; }
+    
+    // ADSR settings in samples
+    EnvelopeParams getEnvelopeParams() const;
+    
+    // Sample at which a timed note starts its release (Envelope::NEVER for held notes)
+    int getReleaseSample() const;
     
     // Friend class for SoundManager to access private members
     friend class SoundManager;
-};
\ No newline at end of file
+};
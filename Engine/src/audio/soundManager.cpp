@@ -1,146 +1,489 @@
 #include "soundManager.hpp"
 #include "config.hpp"
 #include <SDL3/SDL.h>
+#include <algorithm>
+#include "../platform/mappedFile.hpp"
 
-SoundManager::SoundManager(SDL_AudioDeviceID device)
-    : deviceId(device), isRecording(false), recordingStartTime(0), 
-      isPlaying(false), playbackStartTime(0), currentEventIndex(0), globalVolume(1.0f) {}
+// Channels the device actually runs with, whatever was asked when it was opened
+static int getDeviceChannels(SDL_AudioDeviceID device) {
+    SDL_AudioSpec spec;
+    if (!device) {
+        return RENDER_CHANNELS;
+    }
+    if (!SDL_GetAudioDeviceFormat(device, &spec, nullptr)) {
+        SDL_Log("Failed to query the audio device format: %s", SDL_GetError());
+        return AUDIO_CHANNELS;
+    }
+    return spec.channels;
+}
+
+SoundManager::SoundManager(SDL_AudioDeviceID device, int voiceCapacity)
+    : deviceId(device), outputStream(nullptr), layout(::getSpeakerLayout(getDeviceChannels(device))),
+      mixBuffer(static_cast<size_t>(layout.channels) * MIX_BLOCK_FRAMES, 0.0f),
+      mixWorkers(MIX_WORKER_THREADS, voiceCapacity / MIX_BATCH_VOICES + 1, layout.channels * MIX_BLOCK_FRAMES,
+                 MIX_DETERMINISTIC != 0),
+      mixer(voiceCapacity, (currentDelay * AUDIO_SAMPLE_RATE) / 1000, layout, &voiceEventQueue),
+      telemetry(static_cast<int>(sizeof(float)) * layout.channels),
+      commandQueue(COMMAND_QUEUE_CAPACITY), voiceEventQueue(VOICE_EVENT_QUEUE_CAPACITY),
+      isRecording(false), recordingStartTime(0), isPlaying(false), playbackStartTime(0), currentEventIndex(0),
+      globalVolume(1.0f) {
+    
+    // Without a device the manager only renders offline
+    if (!deviceId) {
+        return;
+    }
+    
+    SDL_Log("Mixing in %s (%d channels)", layout.name, layout.channels);
+    
+    // Voices are panned into one stream in the device's own layout, so SDL only converts the format
+    SDL_AudioSpec spec;
+    SDL_zero(spec);
+    spec.format = SDL_AUDIO_F32;
+    spec.channels = layout.channels;
+    spec.freq = AUDIO_SAMPLE_RATE;
+    
+    outputStream = SDL_CreateAudioStream(&spec, &spec);
+    if (!outputStream) {
+        SDL_Log("Failed to create output stream: %s", SDL_GetError());
+        return;
+    }
+    
+    // Workers that failed to start leave their batches to the callback, so any count works
+    if (mixWorkers.getThreadCount() > 0) {
+        mixWorkers.start();
+        mixer.setWorkers(&mixWorkers);
+    }
+    
+    // Install the callback before binding so the device never pulls from an unmixed stream
+    SDL_SetAudioStreamGetCallback(outputStream, audioCallback, this);
+    if (!SDL_BindAudioStream(deviceId, outputStream)) {
+        SDL_Log("Failed to bind output stream: %s", SDL_GetError());
+    }
+    
+    spectrum.start();
+}
 
 SoundManager::~SoundManager() {
+    stopThreads();
+    
+    // SDL_Quit already destroys every stream, so only tear ours down while audio is up
+    if (outputStream && SDL_WasInit(SDL_INIT_AUDIO)) {
+        SDL_DestroyAudioStream(outputStream);
+    }
+    if (outputStream) {
+        telemetry.logSummary();
+    }
+    outputStream = nullptr;
+    
     // The unique_ptrs will clean up the Sound objects
     sounds.clear();
-    activeInstances.clear();
 }
 
-bool SoundManager::addSound(const std::string& name, double frequency, float gain, int durationMs, int fadeMs) {
-    if (sounds.find(name) != sounds.end()) {
-        // Sound already exists
-        return false;
+void SoundManager::stopThreads() {
+    journal.stop();
+    spectrum.stop();
+    streamer.stop();
+    mixWorkers.stop();
+}
+
+void SDLCALL SoundManager::audioCallback(void* userdata, SDL_AudioStream* stream, int additionalAmount, int totalAmount) {
+    SoundManager* manager = static_cast<SoundManager*>(userdata);
+    (void)totalAmount;
+    
+    // Mix whole blocks until the request is covered. The UI thread never touches
+    // the voice pool; it only queues commands, which mixAudio picks up per block.
+    const int channels = manager->layout.channels;
+    int framesNeeded = additionalAmount / static_cast<int>(sizeof(float) * channels);
+    int blocks = (framesNeeded + MIX_BLOCK_FRAMES - 1) / MIX_BLOCK_FRAMES;
+    if (blocks <= 0) {
+        return;
     }
     
-    sounds[name] = std::make_unique<Sound>(deviceId, frequency, gain, durationMs, fadeMs);
-    return true;
+    // Tell the UI thread which frame this callback starts at, so events can be placed on it
+    const Uint64 startNS = SDL_GetTicksNS();
+    const int queued = SDL_GetAudioStreamQueued(stream);
+    manager->audioClock.publish(manager->mixer.getMixedFrames(), startNS, blocks * MIX_BLOCK_FRAMES);
+    
+    int voices = 0;
+    for (int i = 0; i < blocks; i++) {
+        float* block = manager->mixBuffer.data();
+        manager->mixAudio(block, MIX_BLOCK_FRAMES);
+        manager->spectrum.tap(block, channels);
+        voices = std::max(voices, manager->mixer.getPlayingCount());
+        SDL_PutAudioStreamData(stream, block, MIX_BLOCK_FRAMES * channels * static_cast<int>(sizeof(float)));
+    }
+    
+    manager->telemetry.recordCallback(startNS, SDL_GetTicksNS(), blocks * MIX_BLOCK_FRAMES, std::max(queued, 0), voices);
 }
 
-bool SoundManager::playSound(const std::string& name, int durationMs) {
-    auto it = sounds.find(name);
-    if (it == sounds.end()) {
+void SoundManager::mixAudio(float* out, int frames) {
+    AudioCommand command;
+    while (commandQueue.pop(command)) {
+        mixer.apply(command);
+    }
+    
+    mixer.mix(out, frames);
+}
+
+Sint64 SoundManager::scheduleFrame(Uint64 timestampNS) const {
+    Sint64 frame;
+    if (timestampNS == 0 || !audioClock.frameAt(timestampNS, &frame)) {
+        return AUDIO_FRAME_NOW;
+    }
+    return frame;
+}
+
+bool SoundManager::sendCommand(const AudioCommand& command) {
+    if (!commandQueue.push(command)) {
+        SDL_Log("Audio command queue full, dropped command %d (%llu dropped so far)",
+                static_cast<int>(command.type), static_cast<unsigned long long>(commandQueue.getOverflowCount()));
         return false;
     }
+    return true;
+}
+
+void SoundManager::drainVoiceEvents() {
+    VoiceEvent event;
+    while (voiceEventQueue.pop(event)) {}
+}
+
+Uint64 SoundManager::eventTicks(Uint64 timestampNS) {
+    return timestampNS != 0 ? SDL_NS_TO_MS(timestampNS) : SDL_GetTicks();
+}
+
+SoundHandle SoundManager::addSound(const std::string& name, double frequency, float gain, int durationMs,
+                                   int fadeMs, Waveform waveform) {
+    if (soundHandles.find(name) != soundHandles.end()) {
+        // Sound already exists
+        return INVALID_SOUND_HANDLE;
+    }
+    
+    // Build the wavetables now so the first note-on doesn't pay for it
+    WavetableSet::get(waveform);
+    
+    const SoundHandle handle = static_cast<SoundHandle>(sounds.size());
+    sounds.push_back(std::make_unique<Sound>(handle, frequency, gain, durationMs, fadeMs, waveform));
+    soundNames.push_back(name);
+    keyStates.push_back(0);
+    soundHandles[name] = handle;
+    
+    if (isRecording) {
+        journal.defineSound(handle, name);
+    }
+    return handle;
+}
+
+SoundHandle SoundManager::getSoundHandle(const std::string& name) const {
+    auto it = soundHandles.find(name);
+    return it != soundHandles.end() ? it->second : INVALID_SOUND_HANDLE;
+}
+
+Sound* SoundManager::getSound(SoundHandle sound) const {
+    if (sound < 0 || sound >= static_cast<SoundHandle>(sounds.size())) {
+        return nullptr;
+    }
+    return sounds[sound].get();
+}
+
+bool SoundManager::playSound(SoundHandle sound, Uint64 timestampNS) {
+    return startSound(sound, timestampNS, false, articulation);
+}
+
+// Sample and playback rate of the zone a sampled sound's frequency falls in (none for
+// waveform sounds or uncovered keys). Returns the zone's gain
+static float pickSample(const Sound& sound, AudioCommand& command) {
+    command.sample = nullptr;
+    command.playbackRate = 0.0;
+    
+    const SamplerInstrument* instrument = sound.getInstrument();
+    const SampleZone* zone =
+        instrument ? instrument->findZone(SamplerInstrument::frequencyToKey(sound.getFrequency()), sound.getVelocity())
+                   : nullptr;
+    if (!zone) {
+        return 1.0f;
+    }
     
-    // Create a new instance of this sound
-    std::string instanceName = name + "_instance" + std::to_string(instanceCounter++);
-    Sound* templateSound = it->second.get();
+    command.sample = zone->sample.get();
+    command.playbackRate = sound.getFrequency() / SamplerInstrument::keyToFrequency(zone->rootKey) *
+                           zone->sample->getSampleRate() / AUDIO_SAMPLE_RATE;
+    return zone->gain;
+}
+
+AudioCommand SoundManager::noteOnCommand(const Sound& sound, Sint64 frame, bool keyDown,
+                                         Articulation keyArticulation, float volume) {
+    // Only the voice settings are sent; the mixer synthesizes the note.
+    // The template gain and the volume are squared on purpose: the old per-voice streams
+    // copied the template at gain * volume, scaled the samples by it and set it again
+    // with SDL_SetAudioStreamGain, so this keeps their loudness.
+    AudioCommand command = {};
+    command.type = AudioCommandType::NoteOn;
+    command.soundId = sound.id;
+    command.frame = frame;
+    command.wavetable = &WavetableSet::get(sound.waveform);
+    command.frequency = sound.frequency;
+    command.gain = (sound.gain * volume) * (sound.gain * volume) * pickSample(sound, command);
+    command.azimuth = sound.azimuth;
+    command.intValue = sound.getReleaseSample();
+    command.envelope = sound.getEnvelopeParams();
+    command.repeat = false;
+    
+    // A held key either keeps one voice going until key-up, or retriggers the timed
+    // sound on the audio clock (sounds without a duration always just sustain)
+    if (keyDown && keyArticulation == Articulation::Sustain) {
+        command.intValue = Envelope::NEVER;
+    } else if (keyDown) {
+        command.repeat = !sound.isHeld();
+    }
+    return command;
+}
+
+AudioCommand SoundManager::noteOffCommand(SoundHandle sound, Sint64 frame) {
+    AudioCommand command = {};
+    command.type = AudioCommandType::NoteOff;
+    command.soundId = sound;
+    command.frame = frame;
+    return command;
+}
+
+bool SoundManager::startSound(SoundHandle sound, Uint64 timestampNS, bool keyDown, Articulation keyArticulation) {
+    const Sound* templateSound = getSound(sound);
+    if (!templateSound) {
+        return false;
+    }
     
-    // Create a new sound instance with the same parameters but apply volume
-    auto newInstance = std::make_unique<Sound>(deviceId, templateSound->frequency, 
-                                           templateSound->gain * globalVolume, // Apply volume multiplier 
-                                           templateSound->durationMs, 
-                                           templateSound->fadeMs);
+    return sendCommand(noteOnCommand(*templateSound, scheduleFrame(timestampNS), keyDown, keyArticulation,
+                                     globalVolume));
+}
+
+bool SoundManager::releaseSound(SoundHandle sound, Uint64 timestampNS) {
+    if (!getSound(sound)) {
+        return false;
+    }
     
-    // Play the new instance
-    newInstance->play(durationMs);
+    return sendCommand(noteOffCommand(sound, scheduleFrame(timestampNS)));
+}
+
+void SoundManager::releaseAllHeld(Uint64 timestampNS) {
+    AudioCommand command = {};
+    command.type = AudioCommandType::ReleaseAll;
+    command.frame = scheduleFrame(timestampNS);
+    sendCommand(command);
+}
+
+void SoundManager::updateRepeatInterval() {
+    AudioCommand command = {};
+    command.type = AudioCommandType::SetRepeatInterval;
+    command.frame = AUDIO_FRAME_NOW;
+    command.intValue = (currentDelay * AUDIO_SAMPLE_RATE) / 1000;
+    sendCommand(command);
+}
+
+bool SoundManager::setFrequency(SoundHandle sound, double frequency) {
+    Sound* templateSound = getSound(sound);
+    if (!templateSound) {
+        return false;
+    }
     
-    // Add to active instances
-    activeInstances.push_back(std::move(newInstance));
+    templateSound->frequency = frequency;
     
-    // Clean up finished instances periodically
-    if (activeInstances.size() > 20) {
-        cleanupFinishedInstances();
+    AudioCommand command = {};
+    command.type = AudioCommandType::Retune;
+    command.soundId = sound;
+    command.frame = AUDIO_FRAME_NOW;
+    command.frequency = frequency;
+    pickSample(*templateSound, command);
+    return sendCommand(command);
+}
+
+const SamplerInstrument* SoundManager::loadInstrument(const std::string& filename) {
+    std::unique_ptr<SamplerInstrument> instrument = std::make_unique<SamplerInstrument>();
+    if (!instrument->loadFromFile(filename, samplePool)) {
+        return nullptr;
+    }
+    instruments.push_back(std::move(instrument));
+    return instruments.back().get();
+}
+
+bool SoundManager::setInstrument(SoundHandle sound, const SamplerInstrument* instrument, int velocity) {
+    Sound* templateSound = getSound(sound);
+    if (!templateSound) {
+        return false;
     }
     
+    // Sounding voices keep their sample; the next note-on picks the new one
+    templateSound->instrument = instrument;
+    templateSound->velocity = SDL_clamp(velocity, 1, SAMPLER_VELOCITIES - 1);
     return true;
 }
 
-bool SoundManager::removeSound(const std::string& name) {
-    auto it = sounds.find(name);
-    if (it == sounds.end()) {
-        // Sound doesn't exist
+AudioStream* SoundManager::openStream(const std::string& filename) {
+    std::unique_ptr<AudioStream> stream = std::make_unique<AudioStream>();
+    if (!stream->open(filename)) {
+        return nullptr;
+    }
+    streamer.add(stream.get());
+    streams.push_back(std::move(stream));
+    return streams.back().get();
+}
+
+bool SoundManager::playStream(AudioStream* stream, float gain, float azimuth, bool loop) {
+    if (!stream) {
         return false;
     }
     
-    // Remove the sound
-    sounds.erase(it);
-    return true;
+    stream->setLooping(loop);
+    AudioCommand command = {};
+    command.type = AudioCommandType::StreamPlay;
+    command.frame = AUDIO_FRAME_NOW;
+    command.gain = gain * globalVolume;
+    command.azimuth = azimuth;
+    command.stream = stream;
+    return sendCommand(command);
 }
 
-bool SoundManager::recordKeyDown(const std::string& name) {
-    auto it = sounds.find(name);
-    if (it == sounds.end()) {
+bool SoundManager::stopStream(AudioStream* stream) {
+    if (!stream) {
         return false;
     }
     
-    // Get template sound duration
-    int duration = it->second->getDuration();
+    AudioCommand command = {};
+    command.type = AudioCommandType::StreamStop;
+    command.frame = AUDIO_FRAME_NOW;
+    command.stream = stream;
+    return sendCommand(command);
+}
+
+bool SoundManager::isStreaming() const {
+    for (const std::unique_ptr<AudioStream>& stream : streams) {
+        if (stream->isPlaying()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool SoundManager::setPosition(SoundHandle sound, float azimuth) {
+    Sound* templateSound = getSound(sound);
+    if (!templateSound) {
+        return false;
+    }
     
-    // Update key state and store play duration
-    keyStates[name] = true;
-    keyPressTime[name] = SDL_GetTicks();
-    keyPlayDuration[name] = duration;
+    templateSound->azimuth = azimuth;
     
-    // Play the sound immediately
-    playSound(name);
+    AudioCommand command = {};
+    command.type = AudioCommandType::SetPosition;
+    command.soundId = sound;
+    command.frame = AUDIO_FRAME_NOW;
+    command.azimuth = azimuth;
+    return sendCommand(command);
+}
+
+bool SoundManager::setEnvelope(SoundHandle handle, int attackMs, int decayMs, float sustainLevel,
+                               EnvelopeCurve curve) {
+    Sound* templateSound = getSound(handle);
+    if (!templateSound) {
+        return false;
+    }
     
-    // If recording, add this event
-    if (isRecording) {
-        SoundEvent event;
-        event.soundName = name;
-        event.timestamp = SDL_GetTicks() - recordingStartTime;
-        event.isKeyDown = true;
-        event.volume = globalVolume; // Store current volume level
-        event.delay = currentDelay;  // Store the actual current delay value
-        recordedEvents.push_back(event);
-        SDL_Log("Recorded key down: %s at %llu ms (volume: %.2f, delay: %d ms)", 
-                name.c_str(), event.timestamp, globalVolume, currentDelay);
+    Sound& sound = *templateSound;
+    sound.attackMs = attackMs > 0 ? attackMs : 0;
+    sound.decayMs = decayMs > 0 ? decayMs : 0;
+    sound.sustainLevel = sustainLevel < 0.0f ? 0.0f : (sustainLevel > 1.0f ? 1.0f : sustainLevel);
+    sound.curve = curve;
+    return true;
+}
+
+bool SoundManager::removeSound(SoundHandle sound) {
+    if (!getSound(sound)) {
+        // Sound doesn't exist
+        return false;
     }
     
+    // Stop retriggering it; voices already playing finish on their own
+    AudioCommand command = {};
+    command.type = AudioCommandType::StopRepeats;
+    command.soundId = sound;
+    command.frame = AUDIO_FRAME_NOW;
+    sendCommand(command);
+    
+    // Retire the handle; it is never handed out again, so recorded events can't hit another sound
+    soundHandles.erase(soundNames[sound]);
+    sounds[sound].reset();
+    keyStates[sound] = 0;
     return true;
 }
 
-bool SoundManager::recordKeyUp(const std::string& name) {
-    auto it = sounds.find(name);
-    if (it == sounds.end()) {
+bool SoundManager::recordKeyDown(SoundHandle sound, Uint64 timestampNS) {
+    if (!getSound(sound)) {
         return false;
     }
     
     // Update key state
-    keyStates[name] = false;
+    keyStates[sound] = 1;
+    
+    // Play the sound at the frame matching the key press, sustaining or repeating while it is held
+    startSound(sound, timestampNS, true, articulation);
     
     // If recording, add this event
-    if (isRecording) {
-        SoundEvent event;
-        event.soundName = name;
-        event.timestamp = SDL_GetTicks() - recordingStartTime;
-        event.isKeyDown = false;
-        event.volume = globalVolume; // Store current volume level
-        event.delay = currentDelay;  // Store the actual current delay value
-        recordedEvents.push_back(event);
-        SDL_Log("Recorded key up: %s at %llu ms (volume: %.2f, delay: %d ms)", 
-                name.c_str(), event.timestamp, globalVolume, currentDelay);
+    recordEvent(sound, timestampNS, true);
+    return true;
+}
+
+bool SoundManager::recordKeyUp(SoundHandle sound, Uint64 timestampNS) {
+    if (!getSound(sound)) {
+        return false;
     }
     
+    // Update key state and let held notes enter their release
+    keyStates[sound] = 0;
+    releaseSound(sound, timestampNS);
+    
+    // If recording, add this event
+    recordEvent(sound, timestampNS, false);
     return true;
 }
 
-void SoundManager::cleanupFinishedInstances() {
-    // Remove finished instances
-    auto it = activeInstances.begin();
-    while (it != activeInstances.end()) {
-        if (!(*it)->playing) {
-            it = activeInstances.erase(it);
-        } else {
-            ++it;
-        }
+void SoundManager::recordEvent(SoundHandle sound, Uint64 timestampNS, bool isKeyDown) {
+    if (!isRecording) {
+        return;
     }
+    
+    Uint64 ticks = eventTicks(timestampNS);
+    SoundEvent event;
+    event.sound = sound;
+    event.timestamp = ticks > recordingStartTime ? ticks - recordingStartTime : 0;
+    event.isKeyDown = isKeyDown;
+    event.volume = globalVolume; // Store current volume level
+    event.delay = currentDelay;  // Store the actual current delay value
+    event.articulation = articulation;
+    if (!journal.append(event)) {
+        SDL_Log("Recording journal is behind, dropped an event (%llu so far)",
+                static_cast<unsigned long long>(journal.getDroppedCount()));
+    }
+    SDL_Log("Recorded key %s: %s at %llu ms (volume: %.2f, delay: %d ms)", isKeyDown ? "down" : "up",
+            soundNames[sound].c_str(), static_cast<unsigned long long>(event.timestamp), globalVolume, currentDelay);
 }
 
 void SoundManager::startRecording() {
     if (!isRecording) {
+        // The session streams to the journal as it is played; nothing accumulates in memory.
+        // Its file is not the one a stopped session may still be waiting to be loaded from
+        const std::string directory = getJournalDirectory();
+        if (!journal.start(directory, journalSession + 1)) {
+            return;
+        }
+        journalSession++;
         recordedEvents.clear();
-        keyStates.clear(); // Reset key states
+        for (SoundHandle sound = 0; sound < static_cast<SoundHandle>(sounds.size()); sound++) {
+            if (sounds[sound]) {
+                journal.defineSound(sound, soundNames[sound]);
+            }
+        }
+        
+        std::fill(keyStates.begin(), keyStates.end(), 0); // Reset key states
         recordingStartTime = SDL_GetTicks();
         isRecording = true;
-        SDL_Log("Recording started");
+        SDL_Log("Recording started, journal: %s", getJournalSessionPath(directory, journalSession).c_str());
     }
 }
 
@@ -149,27 +492,40 @@ void SoundManager::stopRecording() {
         isRecording = false;
         
         // Release all keys at the end of recording
-        for (const auto& keyState : keyStates) {
-            if (keyState.second) { // If key is down
+        for (SoundHandle sound = 0; sound < static_cast<SoundHandle>(keyStates.size()); sound++) {
+            if (keyStates[sound]) { // If key is down
                 SoundEvent event;
-                event.soundName = keyState.first;
+                event.sound = sound;
                 event.timestamp = SDL_GetTicks() - recordingStartTime;
                 event.isKeyDown = false;
-                recordedEvents.push_back(event);
+                event.volume = globalVolume;
+                event.delay = currentDelay;
+                event.articulation = articulation;
+                journal.append(event);
             }
         }
         
-        keyStates.clear(); // Reset key states
-        SDL_Log("Recording stopped - %zu events recorded", recordedEvents.size());
+        // The writer finishes the file in the background; update() loads it for playback
+        journal.finish();
+        journalLoadSession = journalSession;
+        journalLoadPending = true;
+        
+        std::fill(keyStates.begin(), keyStates.end(), 0); // Reset key states
+        SDL_Log("Recording stopped");
     }
 }
 
 void SoundManager::startPlayback() {
+    if (journalLoadPending) {
+        SDL_Log("Recording is still being written, try again in a moment");
+        return;
+    }
+    
     if (!recordedEvents.empty() && !isPlaying) {
         isPlaying = true;
         playbackStartTime = SDL_GetTicks();
         currentEventIndex = 0;
-        keyStates.clear(); // Reset key states for playback
+        std::fill(keyStates.begin(), keyStates.end(), 0); // Reset key states for playback
         SDL_Log("Playback started - %zu events to play", recordedEvents.size());
     } else if (recordedEvents.empty()) {
         SDL_Log("No recorded events to play");
@@ -179,51 +535,48 @@ void SoundManager::startPlayback() {
 void SoundManager::stopPlayback() {
     if (isPlaying) {
         isPlaying = false;
-        keyStates.clear(); // Reset key states
+        std::fill(keyStates.begin(), keyStates.end(), 0); // Reset key states
+        releaseAllHeld();
         SDL_Log("Playback stopped");
     }
 }
 
 void SoundManager::updatePlayback() {
     if (isPlaying && currentEventIndex < recordedEvents.size()) {
-        Uint64 currentTime = SDL_GetTicks() - playbackStartTime;
+        // Events are handed to the audio clock a little early so they land on their exact frame
+        Uint64 currentTime = SDL_GetTicks() - playbackStartTime + PLAYBACK_LOOKAHEAD_MS;
         
         // Process all events due at this time
         while (currentEventIndex < recordedEvents.size() && 
                recordedEvents[currentEventIndex].timestamp <= currentTime) {
             const SoundEvent& event = recordedEvents[currentEventIndex];
             
+            // Schedule on the recorded time rather than when this update happened to run
+            Uint64 eventTimeNS = SDL_MS_TO_NS(playbackStartTime + event.timestamp);
+            
             // Apply the delay setting from this event to match recording conditions
             if (event.delay != currentDelay) {
                 // Temporarily update global delay to match what was recorded
                 currentDelay = event.delay;
+                updateRepeatInterval();
                 SDL_Log("Playback: using delay of %d ms from recording", currentDelay);
             }
             
-            if (event.isKeyDown) {
-                // Key down event - play the sound and update state
-                auto it = sounds.find(event.soundName);
-                if (it != sounds.end()) {
-                    // Store key press info for continuous playback
-                    keyStates[event.soundName] = true;
-                    keyPressTime[event.soundName] = SDL_GetTicks();
-                    keyPlayDuration[event.soundName] = it->second->getDuration();
-                    
-                    // Temporarily adjust volume to match recorded level
-                    float originalVolume = globalVolume;
-                    globalVolume = event.volume;
-                    
-                    // Play the sound
-                    playSound(event.soundName);
-                    
-                    // Restore original volume
-                    globalVolume = originalVolume;
-                }
-                SDL_Log("Playback: key down %s at %llu ms (volume: %.2f)", event.soundName.c_str(), currentTime, event.volume);
+            if (!getSound(event.sound)) {
+                // Sound was removed since the recording was made
+            } else if (event.isKeyDown) {
+                // Key down event - play the sound, at the recorded volume and held the way it was
+                keyStates[event.sound] = 1;
+                sendCommand(noteOnCommand(*getSound(event.sound), scheduleFrame(eventTimeNS), true,
+                                          event.articulation, event.volume));
+                SDL_Log("Playback: key down %s at %llu ms (volume: %.2f)", soundNames[event.sound].c_str(),
+                        static_cast<unsigned long long>(currentTime), event.volume);
             } else {
-                // Key up event - just update state
-                keyStates[event.soundName] = false;
-                SDL_Log("Playback: key up %s at %llu ms", event.soundName.c_str(), currentTime);
+                // Key up event - update state and release held notes
+                keyStates[event.sound] = 0;
+                releaseSound(event.sound, eventTimeNS);
+                SDL_Log("Playback: key up %s at %llu ms", soundNames[event.sound].c_str(),
+                        static_cast<unsigned long long>(currentTime));
             }
             
             currentEventIndex++;
@@ -232,195 +585,218 @@ void SoundManager::updatePlayback() {
         // Check if we've reached the end
         if (currentEventIndex >= recordedEvents.size()) {
             SDL_Log("Playback completed");
-            keyStates.clear(); // Reset key states
-            // Keep isPlaying true to prevent repeating
-        }
-        
-        // Also check for continuous playback of held keys during playback
-        updateContinuousPlayback();
-    }
-}
-
-void SoundManager::updateContinuousPlayback() {
-    // Get current time once for all operations
-    Uint64 currentTime = SDL_GetTicks();
-    
-    // Use the currentDelay variable instead of DEFAULT_DELAY_MS for the replay interval
-    // This allows the user-adjusted delay to affect continuous playback
-    
-    // Process all held keys with a consistent approach
-    for (auto& keyPair : keyStates) {
-        const std::string& name = keyPair.first;
-        bool isKeyDown = keyPair.second;
-        
-        // Skip keys that aren't being held down
-        if (!isKeyDown) {
-            continue;
-        }
-        
-        // Check if we need to initialize timing for this key
-        if (keyPressTime.find(name) == keyPressTime.end()) {
-            // First encounter with this key - initialize timing data
-            keyPressTime[name] = currentTime;
-            continue; // Skip playing on first press - it's handled by recordKeyDown
-        }
-        
-        // Check if enough time has passed to replay this sound
-        Uint64 lastPlayTime = keyPressTime[name];
-        Uint64 elapsedTime = currentTime - lastPlayTime;
-        
-        // Replay at fixed intervals using the current delay value
-        if (elapsedTime >= currentDelay) {
-            // Play the sound again
-            playSound(name);
+            std::fill(keyStates.begin(), keyStates.end(), 0); // Reset key states
             
-            // Update the last play time for just this key
-            keyPressTime[name] = currentTime;
-            
-            SDL_Log("Replaying held key: %s (interval: %llu ms, current delay: %d ms)", 
-                    name.c_str(), elapsedTime, currentDelay);
+            // Whatever is still held stops on the last event's frame, as in a rendered file
+            releaseAllHeld(SDL_MS_TO_NS(playbackStartTime + recordedEvents.back().timestamp));
+            // Keep isPlaying true to prevent repeating
         }
     }
 }
 
 void SoundManager::update() {
-    // Update template sounds (not really necessary but keeping for consistency)
-    for (auto& pair : sounds) {
-        pair.second->update();
+    // Voice reports from the audio thread
+    drainVoiceEvents();
+    
+    // Log underruns and slow callbacks since the last check
+    if (outputStream) {
+        telemetry.checkThresholds();
     }
     
-    // Update active instances
-    for (auto& instance : activeInstances) {
-        instance->update();
+    // Journal records that had to wait for room in the queue
+    journal.pump();
+    
+    // A stopped recording becomes playable once its journal is on disk
+    if (journalLoadPending && journal.isFinished(journalLoadSession)) {
+        journalLoadPending = false;
+        const std::string path = getJournalSessionPath(getJournalDirectory(), journalLoadSession);
+        if (journal.hasFailed(journalLoadSession)) {
+            SDL_Log("Recording journal could not be written: %s", path.c_str());
+        } else {
+            loadRecordingFromFile(path);
+        }
     }
     
-    // Update playback if needed
+    // Update playback if needed; held keys retrigger on the audio clock by themselves
     if (isPlaying) {
         updatePlayback();
-    } else {
-        // Update continuous playback for held keys (when not in playback mode)
-        updateContinuousPlayback();
-    }
-    
-    // Clean up finished instances periodically
-    if (SDL_GetTicks() % 2000 == 0) {
-        cleanupFinishedInstances();
     }
 }
 
-int SoundManager::getPlayingCount() {
-    int count = 0;
-    for (const auto& instance : activeInstances) {
-        if (instance->playing) {
-            count++;
-        }
-    }
-    return count;
+void SoundManager::setStealPolicy(VoiceStealPolicy policy) {
+    AudioCommand command = {};
+    command.type = AudioCommandType::SetStealPolicy;
+    command.frame = AUDIO_FRAME_NOW;
+    command.intValue = static_cast<int>(policy);
+    sendCommand(command);
+}
+
+void SoundManager::setInterpolation(Interpolation mode) {
+    AudioCommand command = {};
+    command.type = AudioCommandType::SetInterpolation;
+    command.frame = AUDIO_FRAME_NOW;
+    command.intValue = static_cast<int>(mode);
+    sendCommand(command);
 }
 
 bool SoundManager::saveRecordingToFile(const std::string& filename) {
-    std::ofstream file(filename);
-    if (!file.is_open()) {
-        SDL_Log("Failed to open file for saving: %s", filename.c_str());
+    if (journalLoadPending) {
+        SDL_Log("Recording is still being written, try again in a moment");
         return false;
     }
     
-    // Write a header
-    file << "# Sound Recording - Timestamp(ms),SoundName,Action(D/U),Volume,Delay" << std::endl;
+    // .srec is the compact binary format; anything else is written as text
+    const std::string binaryExtension = RECORDING_EXTENSION;
+    const bool binary = filename.size() >= binaryExtension.size() &&
+                        filename.compare(filename.size() - binaryExtension.size(), binaryExtension.size(), binaryExtension) == 0;
     
-    // Write each event with shortened representations
-    for (const auto& event : recordedEvents) {
-        // Shorten note and chord names (note1 -> n1, chord1 -> c1)
-        std::string shortName = event.soundName;
-        if (shortName.find("note") == 0) {
-            shortName = "n" + shortName.substr(4);  // Replace "note" with "n"
-        } else if (shortName.find("chord") == 0) {
-            shortName = "c" + shortName.substr(5);  // Replace "chord" with "c"
-        }
-        
-        file << event.timestamp << "," 
-             << shortName << ","
-             << (event.isKeyDown ? "D" : "U") << ","
-             << event.volume << ","
-             << event.delay << std::endl;
+    const bool saved = binary ? saveRecordingBinary(filename, recordedEvents, soundNames)
+                              : saveRecordingCsv(filename, recordedEvents, soundNames);
+    if (!saved) {
+        SDL_Log("Failed to open file for saving: %s", filename.c_str());
+        return false;
     }
     
-    file.close();
     SDL_Log("Successfully saved recording to: %s", filename.c_str());
     return true;
 }
 
 bool SoundManager::loadRecordingFromFile(const std::string& filename) {
-    std::ifstream file(filename);
-    if (!file.is_open()) {
+    // Binary recordings are decoded straight out of the mapping; text ones are parsed line by line
+    MappedFile file;
+    if (!file.open(filename)) {
         SDL_Log("Failed to open file for loading: %s", filename.c_str());
         return false;
     }
-
-    // Clear any existing recording
-    recordedEvents.clear();
     
-    std::string line;
+    bool loaded;
+    if (isBinaryRecording(file.getData(), file.getSize())) {
+        loaded = loadRecordingBinary(file.getData(), file.getSize(), soundHandles, recordedEvents);
+    } else if (isRecordingJournal(file.getData(), file.getSize())) {
+        bool complete;
+        loaded = loadRecordingJournal(file.getData(), file.getSize(), soundHandles, recordedEvents, &complete);
+    } else {
+        file.close();
+        loaded = loadRecordingCsv(filename, soundHandles, recordedEvents);
+    }
+    
+    if (!loaded) {
+        SDL_Log("Failed to read recording: %s", filename.c_str());
+        return false;
+    }
     
-    // Skip header line
-    std::getline(file, line);
+    SDL_Log("Successfully loaded %zu events from file: %s", recordedEvents.size(), filename.c_str());
+    return true;
+}
+
+bool SoundManager::renderRecording(const std::string& filename, WavFormat format, int threads) {
+    if (recordedEvents.empty()) {
+        SDL_Log("No recorded events to render");
+        return false;
+    }
     
-    // Read event data
-    while (std::getline(file, line)) {
-        // Skip empty lines
-        if (line.empty()) continue;
+    WavWriter wav;
+    if (!wav.open(filename, format, layout.channels, AUDIO_SAMPLE_RATE)) {
+        SDL_Log("Failed to open file for rendering: %s", filename.c_str());
+        return false;
+    }
+    
+    // Turn the events into the commands playback would send, each on its exact frame.
+    // Event times are ms from the start of the recording, which is frame 0 of the file
+    OfflineRenderer renderer(mixer.getVoiceCapacity(), (currentDelay * AUDIO_SAMPLE_RATE) / 1000, layout);
+    int delay = currentDelay;
+    Sint64 frame = 0;
+    for (const SoundEvent& event : recordedEvents) {
+        frame = static_cast<Sint64>(event.timestamp * AUDIO_SAMPLE_RATE / 1000);
         
-        // Parse CSV format
-        size_t pos1 = line.find(',');
-        size_t pos2 = line.find(',', pos1 + 1);
-        size_t pos3 = line.find(',', pos2 + 1);
-        size_t pos4 = line.find(',', pos3 + 1);
+        if (event.delay != delay) {
+            delay = event.delay;
+            AudioCommand command = {};
+            command.type = AudioCommandType::SetRepeatInterval;
+            command.frame = AUDIO_FRAME_NOW;
+            command.intValue = (delay * AUDIO_SAMPLE_RATE) / 1000;
+            renderer.addCommand(command, frame);
+        }
         
-        if (pos1 != std::string::npos && pos2 != std::string::npos) {
-            SoundEvent event;
-            event.timestamp = std::stoull(line.substr(0, pos1));
-            
-            // Extract and expand shortened sound name
-            std::string shortName = line.substr(pos1 + 1, pos2 - pos1 - 1);
-            if (shortName[0] == 'n' && shortName.length() > 1) {
-                event.soundName = "note" + shortName.substr(1);  // Expand "n1" to "note1"
-            } else if (shortName[0] == 'c' && shortName.length() > 1) {
-                event.soundName = "chord" + shortName.substr(1);  // Expand "c1" to "chord1"
-            } else {
-                event.soundName = shortName;  // Keep as is if not matching pattern
-            }
-            
-            // Parse action character
-            std::string action = line.substr(pos2 + 1, pos3 - pos2 - 1);
-            event.isKeyDown = (action == "D");
-            
-            // Parse volume data
-            try {
-                event.volume = std::stof(line.substr(pos3 + 1, pos4 - pos3 - 1));
-            }
-            catch(...) {
-                event.volume = 1.0f; // Default volume if parsing fails
-            }
-            
-            // Parse delay data if available
-            try {
-                if (pos4 != std::string::npos) {
-                    event.delay = std::stoi(line.substr(pos4 + 1));
-                } else {
-                    event.delay = DEFAULT_DELAY_MS; // Use default if not specified
-                }
-            }
-            catch(...) {
-                event.delay = DEFAULT_DELAY_MS; // Default delay if parsing fails
-            }
-            
-            // Add event to the collection
-            recordedEvents.push_back(event);
+        const Sound* templateSound = getSound(event.sound);
+        if (!templateSound) {
+            continue; // Sound was removed since the recording was made
         }
+        renderer.addCommand(event.isKeyDown
+            ? noteOnCommand(*templateSound, frame, true, event.articulation, event.volume)
+            : noteOffCommand(event.sound, frame), frame);
     }
     
-    file.close();
-    SDL_Log("Successfully loaded %zu events from file: %s", recordedEvents.size(), filename.c_str());
+    // Like the end of playback: whatever is still held stops on the last event's frame
+    AudioCommand releaseAll = {};
+    releaseAll.type = AudioCommandType::ReleaseAll;
+    releaseAll.frame = frame;
+    renderer.addCommand(releaseAll, frame);
+    
+    if (threads <= 0) {
+        threads = SDL_GetNumLogicalCPUCores();
+    }
+    
+    const Uint64 startNS = SDL_GetTicksNS();
+    const Sint64 frames = renderer.render(wav, threads);
+    if (!wav.close() || frames < 0) {
+        SDL_Log("Failed to write rendered recording: %s", filename.c_str());
+        return false;
+    }
+    
+    const double seconds = static_cast<double>(frames) / AUDIO_SAMPLE_RATE;
+    const double elapsed = static_cast<double>(SDL_GetTicksNS() - startNS) / SDL_NS_PER_SECOND;
+    SDL_Log("Rendered %.1f s of audio to %s in %.2f s on %d threads (%.0fx realtime)", seconds, filename.c_str(),
+            elapsed, threads, elapsed > 0.0 ? seconds / elapsed : 0.0);
+    return true;
+}
+
+std::string SoundManager::getJournalDirectory() {
+    // The per-user writable directory, so the journal survives wherever the game is installed
+    std::string path;
+    char* prefPath = SDL_GetPrefPath("GameEngine", "SoundTest");
+    if (prefPath) {
+        path = prefPath;
+        SDL_free(prefPath);
+    }
+    return path;
+}
+
+bool SoundManager::recoverRecording() {
+    // Only the newest journal can be the session that was cut off
+    const std::string directory = getJournalDirectory();
+    SDL_Time newestTime = 0;
+    bool found = false;
+    for (Uint32 session = 0; session < JOURNAL_FILE_COUNT; session++) {
+        SDL_PathInfo info;
+        if (SDL_GetPathInfo(getJournalSessionPath(directory, session).c_str(), &info) &&
+            (!found || info.modify_time > newestTime)) {
+            newestTime = info.modify_time;
+            journalSession = session;
+            found = true;
+        }
+    }
+    if (!found) {
+        return false;
+    }
+    
+    // The next session goes to another file, so this one stays until a recording replaces it
+    const std::string path = getJournalSessionPath(directory, journalSession);
+    MappedFile file;
+    if (!file.open(path)) {
+        return false;
+    }
+    
+    // A clean stop marks the journal complete; anything else was cut off by a crash
+    bool complete;
+    std::vector<SoundEvent> events;
+    if (!loadRecordingJournal(file.getData(), file.getSize(), soundHandles, events, &complete) ||
+        complete || events.empty()) {
+        return false;
+    }
+    
+    recordedEvents.swap(events);
+    SDL_Log("Recovered %zu events from an unfinished recording: %s", recordedEvents.size(), path.c_str());
     return true;
 }
 
@@ -443,6 +819,7 @@ void SoundManager::setDelay(int delay) {
     
     // Update the global delay variable
     currentDelay = delay;
+    updateRepeatInterval();
     
     SDL_Log("SoundManager: Delay set to %d ms", currentDelay);
 }
\ No newline at end of file
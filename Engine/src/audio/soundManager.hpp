@@ -1,6 +1,19 @@
 #pragma once
 
 #include "sound.hpp"
+#include "mixer.hpp"
+#include "audioClock.hpp"
+#include "audioTelemetry.hpp"
+#include "spectrumAnalyzer.hpp"
+#include "audioCommands.hpp"
+#include "recording.hpp"
+#include "recordingJournal.hpp"
+#include "spscQueue.hpp"
+#include "offlineRenderer.hpp"
+#include "samplePool.hpp"
+#include "samplerInstrument.hpp"
+#include "audioStream.hpp"
+#include "config.hpp"
 #include <SDL3/SDL.h> // Include SDL header for SDL_AudioDeviceID
 #include <map>
 #include <string>
@@ -11,32 +24,44 @@
 // External reference to currentDelay (defined in main.cpp)
 extern int currentDelay;
 
-// Structure to record sound events
-struct SoundEvent {
-    std::string soundName;
-    Uint64 timestamp;
-    bool isKeyDown; // true for key down, false for key up
-    float volume;   // Store volume level with each event
-    int delay;      // Store the current delay setting
-};
-
 // Sound manager class
 class SoundManager {
 private:
     SDL_AudioDeviceID deviceId;
-    std::map<std::string, std::unique_ptr<Sound>> sounds;
-    std::vector<std::unique_ptr<Sound>> activeInstances;
-    int instanceCounter = 0;
+    SDL_AudioStream* outputStream; // The only stream bound to the device, fed by audioCallback
+    const SpeakerLayout& layout;   // Channels the mixer pans into, matched to the device
+    std::vector<float> mixBuffer;  // One interleaved block of mixed output
+    std::vector<std::unique_ptr<Sound>> sounds; // Indexed by handle, nullptr once removed
+    std::vector<std::string> soundNames;        // Indexed by handle, for files and logs
+    std::map<std::string, SoundHandle> soundHandles; // Name -> handle, only used at the file/UI boundary
+    SamplePool samplePool; // Decoded samples, shared by every instrument
+    std::vector<std::unique_ptr<SamplerInstrument>> instruments; // Kept for the manager's lifetime: voices read their samples
+    std::vector<std::unique_ptr<AudioStream>> streams; // Kept for the manager's lifetime: the mixer and streamer use them
+    AudioStreamer streamer; // Pages in and decodes ahead of every stream
+    MixWorkers mixWorkers; // Threads the callback shares large mixes with
+    Mixer mixer; // Voices and held-key retriggers, mixed by the audio callback (audio thread only)
+    AudioClock audioClock; // Event time -> output frame mapping, published by the callback
+    AudioTelemetry telemetry; // Callback health, recorded by the callback and checked by update()
+    SpectrumAnalyzer spectrum; // Fed every mixed block by the callback, analyzed on its own thread
+    
+    // UI -> audio: everything the UI thread wants done to voices and repeaters.
+    // The callback drains it before every block; nothing is shared under a lock
+    SpscQueue<AudioCommand> commandQueue;
+    
+    // Audio -> UI: voices starting and finishing, drained by update()
+    SpscQueue<VoiceEvent> voiceEventQueue;
     
-    // Key tracking for recording
-    std::map<std::string, bool> keyStates; // Tracks if a key is currently pressed
-    std::map<std::string, Uint64> keyPressTime; // Tracks when a key was last pressed
-    std::map<std::string, int> keyPlayDuration; // Tracks how long a key's sound should play
+    // Key tracking for recording, indexed by handle
+    std::vector<Uint8> keyStates; // Tracks if a key is currently pressed
     
     // Recording variables
     bool isRecording;
     Uint64 recordingStartTime;
-    std::vector<SoundEvent> recordedEvents;
+    std::vector<SoundEvent> recordedEvents; // Loaded or finished recording
+    RecordingJournal journal;               // Streams the recording in progress to disk
+    Uint32 journalSession = 0;              // Last journal session started
+    Uint32 journalLoadSession = 0;          // Stopped session to load once the writer has closed it
+    bool journalLoadPending = false;        // Stopped, waiting for the journal writer to finish
     bool isPlaying;
     Uint64 playbackStartTime;
     size_t currentEventIndex;
@@ -44,28 +69,108 @@ private:
     // Volume control
     float globalVolume = 1.0f;  // Default volume level (100%)
     
+    // What held keys do
+    Articulation articulation = Articulation::Sustain;
+    
+    // SDL pull callback: mixes all active voices into the output stream (audio thread)
+    static void SDLCALL audioCallback(void* userdata, SDL_AudioStream* stream, int additionalAmount, int totalAmount);
+    
+    // Apply the queued commands and mix one mono block (audio thread)
+    void mixAudio(float* out, int frames);
+    
+    // Output frame an event at timestampNS falls on (AUDIO_FRAME_NOW if it should just play now)
+    Sint64 scheduleFrame(Uint64 timestampNS) const;
+    
+    // Queue a command for the audio thread; counted and logged if the queue is full
+    bool sendCommand(const AudioCommand& command);
+    
+    // Take the voice start/finish reports off the queue, so the audio thread always has room
+    // to report and a dropped report means update() fell behind
+    void drainVoiceEvents();
+    
+    // Event time in ms for recording (timestampNS = 0 means now)
+    static Uint64 eventTicks(Uint64 timestampNS);
+    
+    // Directory the recording journals are written to
+    static std::string getJournalDirectory();
+    
     // Update playback (check for events to play)
     void updatePlayback();
     
-    // Play continuous sounds for held keys
-    void updateContinuousPlayback();
+    // Start a voice at timestampNS. For a key press (keyDown) the articulation decides
+    // whether it sustains until releaseSound or retriggers every currentDelay ms;
+    // otherwise the sound plays once for its own duration
+    bool startSound(SoundHandle sound, Uint64 timestampNS, bool keyDown, Articulation keyArticulation);
+    
+    // Template behind a handle, nullptr if it was never added or has been removed
+    Sound* getSound(SoundHandle sound) const;
+    
+    // Write down a key event if recording
+    void recordEvent(SoundHandle sound, Uint64 timestampNS, bool isKeyDown);
+    
+    // Pick up a new currentDelay in the repeaters
+    void updateRepeatInterval();
+    
+    // Release every held voice and repeating key at timestampNS (when key states are reset)
+    void releaseAllHeld(Uint64 timestampNS = 0);
     
 public:
-    SoundManager(SDL_AudioDeviceID device);
+    // device = 0 creates no output stream, for rendering without audio
+    SoundManager(SDL_AudioDeviceID device, int voiceCapacity = VOICE_POOL_CAPACITY);
     ~SoundManager();
     
-    // Add a new sound template
-    bool addSound(const std::string& name, double frequency, float gain = 0.3f, int durationMs = 1000, int fadeMs = 100);
+    // Stop the spectrum analyzer, streaming and mix worker threads; call after closing the audio device
+    // and before SDL_Quit if the manager outlives them
+    void stopThreads();
+    
+    // Add a new sound template (durationMs = 0 holds the note until the key is released).
+    // Returns its handle, or INVALID_SOUND_HANDLE if the name is taken
+    SoundHandle addSound(const std::string& name, double frequency, float gain = 0.3f, int durationMs = 1000, int fadeMs = 100,
+                  Waveform waveform = Waveform::Sine);
+    
+    // Play a sound on a pooled voice (steals one when the pool is full).
+    // timestampNS is the SDL event time (SDL_GetTicksNS base) to start it at; 0 starts it now
+    bool playSound(SoundHandle sound, Uint64 timestampNS = 0);
+    
+    // Release the held voices of a sound (timed one-shots are unaffected) at timestampNS
+    bool releaseSound(SoundHandle sound, Uint64 timestampNS = 0);
+    
+    // Change the pitch of a sound; a key held down retriggers at the new pitch
+    bool setFrequency(SoundHandle sound, double frequency);
     
-    // Play a sound (always creates a new instance)
-    bool playSound(const std::string& name, int durationMs = 0);
+    // Place a sound around the listener (degrees, 0 = ahead, positive to the right, +-180 behind).
+    // Its sounding voices glide there; later notes start there
+    bool setPosition(SoundHandle sound, float azimuth);
     
-    // Record key up/down events
-    bool recordKeyDown(const std::string& name);
-    bool recordKeyUp(const std::string& name);
+    // Load a sampler instrument file (see SamplerInstrument::loadFromFile), decoding its samples
+    // in parallel. Returns nullptr if it has no playable zone
+    const SamplerInstrument* loadInstrument(const std::string& filename);
     
-    // Clean up any finished sound instances
-    void cleanupFinishedInstances();
+    // Play a sound from an instrument: each note-on plays the zone of the sound's frequency at
+    // velocity, pitched from the zone's root key. Frequencies no zone covers play the waveform.
+    // nullptr goes back to the waveform
+    bool setInstrument(SoundHandle sound, const SamplerInstrument* instrument,
+                       int velocity = SAMPLER_DEFAULT_VELOCITY);
+    
+    // Open a long WAV, FLAC, MP3 or Ogg Vorbis file to play from disk rather than decode whole
+    // (see AudioStream). Returns nullptr if it can't be played
+    AudioStream* openStream(const std::string& filename);
+    
+    // Play a stream from the start (restarting it if it's playing), scaled by the volume,
+    // at azimuth; looped streams go back to the start until stopped
+    bool playStream(AudioStream* stream, float gain = 1.0f, float azimuth = 0.0f, bool loop = false);
+    bool stopStream(AudioStream* stream);
+    
+    // Some stream is playing
+    bool isStreaming() const;
+    
+    // Shape the envelope of a sound; the release time stays its fade time
+    bool setEnvelope(SoundHandle sound, int attackMs, int decayMs, float sustainLevel,
+                     EnvelopeCurve curve = EnvelopeCurve::Exponential);
+    
+    // Record key up/down events; pass the event's e.key.timestamp for sample-accurate timing
+    bool recordKeyDown(SoundHandle sound, Uint64 timestampNS = 0);
+    bool recordKeyUp(SoundHandle sound, Uint64 timestampNS = 0);
     
     // Recording and playback control
     void startRecording();
@@ -77,12 +182,21 @@ public:
     void update();
     
     // Get number of sounds currently playing
-    int getPlayingCount();
+    int getPlayingCount() const { return mixer.getPlayingCount(); }
+    
+    // Voice stealing policy used when the pool is full
+    void setStealPolicy(VoiceStealPolicy policy);
+    
+    // Oscillator interpolation used for new notes
+    void setInterpolation(Interpolation mode);
     
     // Status getters
     bool isCurrentlyRecording() const { return isRecording; }
     bool isCurrentlyPlaying() const { return isPlaying; }
     
+    // Nothing sounding, playing back or about to load: nothing changes until the next input
+    bool isIdle() const { return getPlayingCount() == 0 && !isPlaying && !journalLoadPending && !isStreaming(); }
+    
     // Volume control
     void adjustVolume(float delta);
     float getVolume() const { return globalVolume; }
@@ -90,16 +204,56 @@ public:
     // Delay control
     void setDelay(int delay); // Add a method to directly set the delay
     
+    // Held-key behaviour for key presses from now on
+    void setArticulation(Articulation mode) { articulation = mode; }
+    Articulation getArticulation() const { return articulation; }
+    
+    // Commands and voice reports dropped because a queue was full
+    Uint64 getDroppedCommandCount() const { return commandQueue.getOverflowCount(); }
+    Uint64 getDroppedVoiceEventCount() const { return voiceEventQueue.getOverflowCount(); }
+    
+    // Callback timing, underruns, queue depth and voices of the output stream so far
+    AudioTelemetrySnapshot getAudioTelemetry() const { return telemetry.getSnapshot(); }
+    
+    // Latest spectrum of the output: SPECTRUM_BANDS smoothed levels and peak markers, 0-1
+    void getSpectrum(float* levels, float* peaks) const { spectrum.getBands(levels, peaks); }
+    
+    // Layout the output is mixed in
+    const SpeakerLayout& getSpeakerLayout() const { return layout; }
+    
     // Access to sound collections for rendering
-    const std::vector<std::unique_ptr<Sound>>& getActiveInstances() const { return activeInstances; }
-    const std::map<std::string, std::unique_ptr<Sound>>& getSounds() const { return sounds; }
+    const std::vector<std::unique_ptr<Sound>>& getSounds() const { return sounds; }
+    
+    // Handle of a sound by name (INVALID_SOUND_HANDLE if unknown); look it up once, not per event
+    SoundHandle getSoundHandle(const std::string& name) const;
+    
+    // Name a sound was added under
+    const std::string& getSoundName(SoundHandle sound) const { return soundNames[sound]; }
     
-    // Save recorded events to a file
+    // Save recorded events to a file: binary for RECORDING_EXTENSION, text (CSV) otherwise
     bool saveRecordingToFile(const std::string& filename);
     
-    // Load recorded events from a file
+    // Load recorded events from a binary or text file (detected from its contents)
     bool loadRecordingFromFile(const std::string& filename);
     
+    // Mix the loaded recording straight into a WAV file, as fast as the CPU allows. Runs the
+    // same mixer code as the audio callback on its own voices, with every event on its exact
+    // frame, so the file matches what playback sounds like. Needs no device.
+    // threads = 0 uses every core; the file is bit-identical whatever the thread count
+    bool renderRecording(const std::string& filename, WavFormat format, int threads = 0);
+    
+    // Load the journal of a recording that was cut off by a crash, if the newest one was.
+    // Call after the sounds are added and before recording; returns true if events were recovered
+    bool recoverRecording();
+    
     // Add a new method to remove a sound
-    bool removeSound(const std::string& name);
+    bool removeSound(SoundHandle sound);
+    
+    // NoteOn for a sound at frame. For a key press (keyDown) the articulation decides whether it
+    // sustains or retriggers; volume scales the template gain. Shared by live play and rendering
+    static AudioCommand noteOnCommand(const Sound& sound, Sint64 frame, bool keyDown, Articulation keyArticulation,
+                                      float volume);
+    
+    // NoteOff releasing the held voices and repeater of a sound at frame
+    static AudioCommand noteOffCommand(SoundHandle sound, Sint64 frame);
 };
\ No newline at end of file
@@ -0,0 +1,60 @@
+#include "speakerLayout.hpp"
+#include <SDL3/SDL.h>
+#include <cmath>
+
+static const SpeakerLayout MONO = {"mono", 1, 1, {0}, {0.0f}, false};
+static const SpeakerLayout STEREO = {"stereo", 2, 2, {0, 1}, {-30.0f, 30.0f}, false};
+static const SpeakerLayout QUAD = {"quad", 4, 4, {2, 0, 1, 3}, {-135.0f, -45.0f, 45.0f, 135.0f}, true};
+static const SpeakerLayout SURROUND_51 = {"5.1", 6, 5, {4, 0, 2, 1, 5}, {-110.0f, -30.0f, 0.0f, 30.0f, 110.0f}, true};
+
+void SpeakerLayout::computeGains(float azimuth, float* gains) const {
+    for (int c = 0; c < channels; c++) {
+        gains[c] = 0.0f;
+    }
+    if (speakers == 1) {
+        gains[speakerChannel[0]] = 1.0f;
+        return;
+    }
+    
+    // Into (-180, 180]
+    azimuth = std::fmod(azimuth, 360.0f);
+    if (azimuth > 180.0f) azimuth -= 360.0f;
+    if (azimuth <= -180.0f) azimuth += 360.0f;
+    
+    // Front-only layouts mirror sources behind the listener to the front, and hold the ones
+    // past the outermost speakers there
+    if (!surround) {
+        if (azimuth > 90.0f) azimuth = 180.0f - azimuth;
+        if (azimuth < -90.0f) azimuth = -180.0f - azimuth;
+        azimuth = SDL_clamp(azimuth, speakerAzimuth[0], speakerAzimuth[speakers - 1]);
+    }
+    
+    // The pair of neighbouring speakers around the source; on a ring the last pair wraps behind
+    int first = speakers - 1;
+    for (int s = 0; s < speakers - 1; s++) {
+        if (azimuth >= speakerAzimuth[s] && azimuth <= speakerAzimuth[s + 1]) {
+            first = s;
+            break;
+        }
+    }
+    const int second = (first + 1) % speakers;
+    
+    float span = speakerAzimuth[second] - speakerAzimuth[first];
+    float offset = azimuth - speakerAzimuth[first];
+    if (span <= 0.0f) span += 360.0f;
+    if (offset < 0.0f) offset += 360.0f;
+    
+    // Exact zeros on a speaker, so the mixer skips the channels a source doesn't reach
+    const float t = offset / span * 0.5f * SDL_PI_F;
+    const float firstGain = std::cos(t);
+    const float secondGain = std::sin(t);
+    gains[speakerChannel[first]] = firstGain > 1e-6f ? firstGain : 0.0f;
+    gains[speakerChannel[second]] = secondGain > 1e-6f ? secondGain : 0.0f;
+}
+
+const SpeakerLayout& getSpeakerLayout(int deviceChannels) {
+    if (deviceChannels >= 6) return SURROUND_51;
+    if (deviceChannels >= 4) return QUAD;
+    if (deviceChannels >= 2) return STEREO;
+    return MONO;
+}
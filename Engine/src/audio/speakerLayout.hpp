@@ -0,0 +1,21 @@
+#pragma once
+
+#include "config.hpp"
+
+// Speaker arrangement the mixer pans voices into, in SDL's channel order. Positions are
+// azimuths in degrees: 0 is straight ahead, positive to the right, +-180 behind.
+struct SpeakerLayout {
+    const char* name;
+    int channels;                           // Interleaved channels of the output
+    int speakers;                           // Full-range speakers panned between (the LFE takes none)
+    int speakerChannel[MAX_OUTPUT_CHANNELS];  // Channel of each speaker, by ascending azimuth
+    float speakerAzimuth[MAX_OUTPUT_CHANNELS];
+    bool surround;                          // Speakers ring the listener; otherwise sources behind fold to the front
+    
+    // Constant-power gains of a source at azimuth for every channel: it sits between the two
+    // nearest speakers, cos/sin of how far it is from one to the other
+    void computeGains(float azimuth, float* gains) const;
+};
+
+// Layout for a device with this many channels: mono, stereo (2.1 included), quad (4.1 included) or 5.1 (6 and up)
+const SpeakerLayout& getSpeakerLayout(int deviceChannels);
@@ -0,0 +1,161 @@
+#include "spectrumAnalyzer.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+SpectrumAnalyzer::SpectrumAnalyzer()
+    : taps(SPECTRUM_TAP_BLOCKS), fft(SPECTRUM_FFT_SIZE), history(SPECTRUM_FFT_SIZE, 0.0f),
+      window(SPECTRUM_FFT_SIZE), frame(SPECTRUM_FFT_SIZE), bins(SPECTRUM_FFT_SIZE / 2) {
+    for (int i = 0; i < SPECTRUM_FFT_SIZE; i++) {
+        window[i] = static_cast<float>(0.5 - 0.5 * std::cos(2.0 * SDL_PI_D * i / SPECTRUM_FFT_SIZE));
+    }
+    
+    // Each band takes the loudest bin between its edges; low bands narrower than a bin share one
+    const float binsPerHz = static_cast<float>(SPECTRUM_FFT_SIZE) / AUDIO_SAMPLE_RATE;
+    const float ratio = SPECTRUM_MAX_HZ / SPECTRUM_MIN_HZ;
+    for (int band = 0; band < SPECTRUM_BANDS; band++) {
+        const float low = SPECTRUM_MIN_HZ * std::pow(ratio, static_cast<float>(band) / SPECTRUM_BANDS);
+        const float high = SPECTRUM_MIN_HZ * std::pow(ratio, static_cast<float>(band + 1) / SPECTRUM_BANDS);
+        const int first = std::clamp(static_cast<int>(low * binsPerHz + 0.5f), 1, SPECTRUM_FFT_SIZE / 2 - 1);
+        bandFirstBin[band] = first;
+        bandLastBin[band] = std::clamp(static_cast<int>(high * binsPerHz + 0.5f) - 1, first, SPECTRUM_FFT_SIZE / 2 - 1);
+    }
+    
+    for (int band = 0; band < SPECTRUM_BANDS; band++) {
+        publishedLevels[band].store(0.0f, std::memory_order_relaxed);
+        publishedPeaks[band].store(0.0f, std::memory_order_relaxed);
+    }
+}
+
+SpectrumAnalyzer::~SpectrumAnalyzer() {
+    stop();
+}
+
+bool SpectrumAnalyzer::start() {
+    if (worker) {
+        return true;
+    }
+    
+    running.store(true, std::memory_order_relaxed);
+    worker = SDL_CreateThread(workerMain, "SpectrumAnalyzer", this);
+    if (!worker) {
+        SDL_Log("Failed to start spectrum analyzer: %s", SDL_GetError());
+        running.store(false, std::memory_order_relaxed);
+        return false;
+    }
+    return true;
+}
+
+void SpectrumAnalyzer::stop() {
+    if (!worker) {
+        return;
+    }
+    
+    running.store(false, std::memory_order_relaxed);
+    SDL_WaitThread(worker, nullptr);
+    worker = nullptr;
+}
+
+void SpectrumAnalyzer::tap(const float* block, int channels) {
+    Block item;
+    for (int i = 0; i < MIX_BLOCK_FRAMES; i++) {
+        float sum = 0.0f;
+        for (int c = 0; c < channels; c++) {
+            sum += block[i * channels + c];
+        }
+        item.samples[i] = sum;
+    }
+    taps.push(item);
+}
+
+bool SpectrumAnalyzer::drainTaps() {
+    bool any = false;
+    Block item;
+    while (taps.pop(item)) {
+        // SPECTRUM_FFT_SIZE is a multiple of the block size, so a block never wraps
+        std::memcpy(&history[historyPos], item.samples, sizeof(item.samples));
+        historyPos = (historyPos + MIX_BLOCK_FRAMES) % SPECTRUM_FFT_SIZE;
+        any = true;
+    }
+    return any;
+}
+
+void SpectrumAnalyzer::analyze(Uint64 nowNS) {
+    // Oldest sample first, windowed
+    const int older = SPECTRUM_FFT_SIZE - historyPos;
+    for (int i = 0; i < older; i++) {
+        frame[i] = history[historyPos + i] * window[i];
+    }
+    for (int i = 0; i < historyPos; i++) {
+        frame[older + i] = history[i] * window[older + i];
+    }
+    
+    fft.magnitudes(frame.data(), bins.data());
+    
+    const float dt = lastAnalysisNS ? std::min((nowNS - lastAnalysisNS) / 1e9f, 0.1f) : 0.0f;
+    const float release = std::exp(-dt * 1000.0f / SPECTRUM_RELEASE_MS);
+    lastAnalysisNS = nowNS;
+    
+    // A full-scale sine comes out of a Hann-windowed FFT at a quarter of the size
+    const float amplitudeScale = 4.0f / SPECTRUM_FFT_SIZE;
+    
+    for (int band = 0; band < SPECTRUM_BANDS; band++) {
+        const float loudest = *std::max_element(bins.begin() + bandFirstBin[band], bins.begin() + bandLastBin[band] + 1);
+        const float db = 20.0f * std::log10(loudest * amplitudeScale + 1e-9f);
+        const float target = std::clamp((db - SPECTRUM_FLOOR_DB) / -SPECTRUM_FLOOR_DB, 0.0f, 1.0f);
+        
+        // Rise at once, fall smoothly, and settle at exactly zero rather than decaying forever
+        levels[band] = target > levels[band] ? target : target + (levels[band] - target) * release;
+        if (levels[band] < SPECTRUM_SILENT_LEVEL) {
+            levels[band] = 0.0f;
+        }
+        
+        if (levels[band] >= peaks[band]) {
+            peaks[band] = levels[band];
+            peakHeldUntilNS[band] = nowNS + SDL_MS_TO_NS(SPECTRUM_PEAK_HOLD_MS);
+        } else if (nowNS > peakHeldUntilNS[band]) {
+            peaks[band] = std::max(levels[band], peaks[band] - SPECTRUM_PEAK_FALL_PER_S * dt);
+        }
+    }
+}
+
+void SpectrumAnalyzer::publish() {
+    const Uint32 s = sequence.load(std::memory_order_relaxed);
+    sequence.store(s + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    
+    for (int band = 0; band < SPECTRUM_BANDS; band++) {
+        publishedLevels[band].store(levels[band], std::memory_order_relaxed);
+        publishedPeaks[band].store(peaks[band], std::memory_order_relaxed);
+    }
+    
+    sequence.store(s + 2, std::memory_order_release);
+}
+
+void SpectrumAnalyzer::getBands(float* outLevels, float* outPeaks) const {
+    Uint32 before, after;
+    
+    // Retry until we read a set no publish was writing to
+    do {
+        before = sequence.load(std::memory_order_acquire);
+        for (int band = 0; band < SPECTRUM_BANDS; band++) {
+            outLevels[band] = publishedLevels[band].load(std::memory_order_relaxed);
+            outPeaks[band] = publishedPeaks[band].load(std::memory_order_relaxed);
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        after = sequence.load(std::memory_order_relaxed);
+    } while ((before & 1) || before != after);
+}
+
+int SDLCALL SpectrumAnalyzer::workerMain(void* userdata) {
+    SpectrumAnalyzer* analyzer = static_cast<SpectrumAnalyzer*>(userdata);
+    
+    while (analyzer->running.load(std::memory_order_relaxed)) {
+        if (analyzer->drainTaps()) {
+            analyzer->analyze(SDL_GetTicksNS());
+            analyzer->publish();
+        }
+        SDL_Delay(SPECTRUM_UPDATE_MS);
+    }
+    return 0;
+}
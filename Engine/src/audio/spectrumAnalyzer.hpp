@@ -0,0 +1,76 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <atomic>
+#include <vector>
+#include "dsp/realFft.hpp"
+#include "spscQueue.hpp"
+#include "config.hpp"
+
+static_assert(SPECTRUM_FFT_SIZE >= 1024 && SPECTRUM_FFT_SIZE <= 8192 &&
+              (SPECTRUM_FFT_SIZE & (SPECTRUM_FFT_SIZE - 1)) == 0, "SPECTRUM_FFT_SIZE must be a power of two in 1024-8192");
+static_assert(SPECTRUM_FFT_SIZE % MIX_BLOCK_FRAMES == 0, "SPECTRUM_FFT_SIZE must hold whole mix blocks");
+
+// Spectrum of the master mix for the visualizer. The audio callback taps every mixed block
+// into a queue; a worker thread keeps the last SPECTRUM_FFT_SIZE samples, runs a Hann-windowed
+// FFT on them every SPECTRUM_UPDATE_MS and folds the bins into SPECTRUM_BANDS log-spaced bands
+// with smoothing and peak hold. Bands are published through a seqlock, so neither the audio
+// thread nor the renderer ever waits on the worker.
+class SpectrumAnalyzer {
+private:
+    struct Block {
+        float samples[MIX_BLOCK_FRAMES];
+    };
+    
+    SpscQueue<Block> taps; // Audio -> worker
+    
+    // Worker only
+    RealFft fft;
+    std::vector<float> history;   // Ring of the latest SPECTRUM_FFT_SIZE samples
+    int historyPos = 0;
+    std::vector<float> window;    // Hann
+    std::vector<float> frame;     // Windowed copy of the history, oldest first
+    std::vector<float> bins;      // Magnitudes, SPECTRUM_FFT_SIZE / 2
+    int bandFirstBin[SPECTRUM_BANDS];
+    int bandLastBin[SPECTRUM_BANDS];
+    float levels[SPECTRUM_BANDS] = {};  // Smoothed, 0 = SPECTRUM_FLOOR_DB, 1 = full scale
+    float peaks[SPECTRUM_BANDS] = {};
+    Uint64 peakHeldUntilNS[SPECTRUM_BANDS] = {};
+    Uint64 lastAnalysisNS = 0;
+    
+    // Published bands
+    std::atomic<Uint32> sequence{0}; // Odd while the worker is writing
+    std::atomic<float> publishedLevels[SPECTRUM_BANDS];
+    std::atomic<float> publishedPeaks[SPECTRUM_BANDS];
+    
+    SDL_Thread* worker = nullptr;
+    std::atomic<bool> running{false};
+    
+    // Take the queued blocks into the history; false if none came in
+    bool drainTaps();
+    
+    // FFT the history and move the bands toward it
+    void analyze(Uint64 nowNS);
+    
+    void publish();
+    
+    static int SDLCALL workerMain(void* userdata);
+
+public:
+    SpectrumAnalyzer();
+    ~SpectrumAnalyzer();
+    
+    SpectrumAnalyzer(const SpectrumAnalyzer&) = delete;
+    SpectrumAnalyzer& operator=(const SpectrumAnalyzer&) = delete;
+    
+    // Start and stop the worker thread
+    bool start();
+    void stop();
+    
+    // Audio thread: one mixed block of MIX_BLOCK_FRAMES interleaved frames, analyzed as the sum of
+    // its channels (dropped if the worker is behind)
+    void tap(const float* block, int channels);
+    
+    // Any thread: the latest bands and peak markers, SPECTRUM_BANDS each, 0-1
+    void getBands(float* outLevels, float* outPeaks) const;
+};
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <atomic>
+#include <type_traits>
+#include <vector>
+
+// Wait-free single-producer/single-consumer ring of POD items.
+// One thread only pushes, one thread only pops; neither ever blocks or allocates.
+// A push into a full ring fails and is counted instead of waiting for room.
+template <typename T>
+class SpscQueue {
+    static_assert(std::is_trivially_copyable<T>::value, "SpscQueue items must be plain data");
+
+private:
+    std::vector<T> slots;        // Sized once, power of two
+    Uint32 mask;
+
+    // Producer and consumer indices live on their own cache lines so the two
+    // threads don't bounce one line between cores on every push and pop
+    alignas(64) std::atomic<Uint32> tail; // Next slot to write (producer)
+    Uint32 cachedHead;                    // Producer's last look at head
+    alignas(64) std::atomic<Uint32> head; // Next slot to read (consumer)
+    Uint32 cachedTail;                    // Consumer's last look at tail
+    alignas(64) std::atomic<Uint64> overflowCount; // Pushes dropped because the ring was full
+
+public:
+    // capacity is rounded up to a power of two
+    explicit SpscQueue(Uint32 capacity) : tail(0), cachedHead(0), head(0), cachedTail(0), overflowCount(0) {
+        Uint32 size = 1;
+        while (size < capacity) size <<= 1;
+        slots.resize(size);
+        mask = size - 1;
+    }
+
+    // Producer: false (and counted) if the ring is full
+    bool push(const T& item) {
+        const Uint32 t = tail.load(std::memory_order_relaxed);
+        if (t - cachedHead > mask) {
+            cachedHead = head.load(std::memory_order_acquire);
+            if (t - cachedHead > mask) {
+                overflowCount.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+        }
+
+        slots[t & mask] = item;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Producer: whether a push would fail right now, so a costly item needn't be built
+    bool isFull() {
+        const Uint32 t = tail.load(std::memory_order_relaxed);
+        if (t - cachedHead > mask) {
+            cachedHead = head.load(std::memory_order_acquire);
+        }
+        return t - cachedHead > mask;
+    }
+
+    // Consumer: false if the ring is empty
+    bool pop(T& item) {
+        const Uint32 h = head.load(std::memory_order_relaxed);
+        if (h == cachedTail) {
+            cachedTail = tail.load(std::memory_order_acquire);
+            if (h == cachedTail) {
+                return false;
+            }
+        }
+
+        item = slots[h & mask];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    Uint32 getCapacity() const { return mask + 1; }
+
+    // Items dropped by push so far (safe to read from any thread)
+    Uint64 getOverflowCount() const { return overflowCount.load(std::memory_order_relaxed); }
+};
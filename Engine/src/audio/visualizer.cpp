@@ -1,96 +1,140 @@
 #include "visualizer.hpp"
 #include "config.hpp"
+#include <cmath>
+#include <cstring>
 
-void SoundVisualizer::RenderPlayingSounds(SDL_Renderer *renderer, SoundManager& soundManager) {
-    const auto& activeInstances = soundManager.getActiveInstances();
-    int playingCount = soundManager.getPlayingCount();
+// Two bars per band plus the placeholder and the status boxes
+static const int MAX_RECTS = SPECTRUM_BANDS * 2 + 3;
+
+SoundVisualizer::SoundVisualizer() {
+    vertices.reserve(MAX_RECTS * 4);
+    drawn.reserve(MAX_RECTS * 4);
     
+    indices.reserve(MAX_RECTS * 6);
+    for (int i = 0; i < MAX_RECTS; i++) {
+        const int corner = i * 4;
+        const int quad[6] = {corner, corner + 1, corner + 2, corner, corner + 2, corner + 3};
+        indices.insert(indices.end(), quad, quad + 6);
+    }
+}
 
+void SoundVisualizer::addRect(const SDL_FRect& rect, SDL_Color color) {
+    const SDL_FColor fcolor = {color.r / 255.0f, color.g / 255.0f, color.b / 255.0f, color.a / 255.0f};
+    const SDL_FPoint corners[4] = {
+        {rect.x, rect.y},
+        {rect.x + rect.w, rect.y},
+        {rect.x + rect.w, rect.y + rect.h},
+        {rect.x, rect.y + rect.h}
+    };
     
-    // If no active instances, just show a placeholder
-    if (playingCount == 0) {
-        SDL_FRect bar = {
-            WINDOW_WIDTH / 2.0f - 50.0f,
-            WINDOW_HEIGHT - 50.0f - 20.0f,
-            100.0f,
-            20.0f
-        };
-        
-        SDL_SetRenderDrawColor(renderer, 100, 100, 100, 255);
-        SDL_RenderFillRect(renderer, &bar);
-        return;
+    for (const SDL_FPoint& corner : corners) {
+        vertices.push_back({corner, fcolor, {0.0f, 0.0f}});
     }
+}
+
+bool SoundVisualizer::Update(SoundManager& soundManager) {
+    float levels[SPECTRUM_BANDS];
+    float peaks[SPECTRUM_BANDS];
+    soundManager.getSpectrum(levels, peaks);
+    int playingCount = soundManager.getPlayingCount();
     
-    // Draw active sounds
-    int i = 0;
-    for (const auto& instance : activeInstances) {
-        if (!instance->isPlaying()) continue;
-        if (i >= MAX_VISIBLE_BARS) break; // Limit visualization to prevent too many bars
-        
-        int barHeight = 0;
-        SDL_Color color = {0, 0, 0, 255};
-        
-        // Calculate height based on frequency
-        barHeight = static_cast<int>(instance->getFrequency() / 5.0); // Scale for visualization
-        if (barHeight > WINDOW_HEIGHT - 100)
-            barHeight = WINDOW_HEIGHT - 100;
+    const float maxHeight = WINDOW_HEIGHT - 100.0f;
+    const float bandWidth = WINDOW_WIDTH / float(SPECTRUM_BANDS);
+    bool silent = true;
+    
+    vertices.clear();
+    
+    // Draw the spectrum of the output, low bands on the left. Heights are whole pixels,
+    // so a spectrum that has settled lays out exactly the same frame again
+    for (int i = 0; i < SPECTRUM_BANDS; i++) {
+        float barHeight = std::floor(levels[i] * maxHeight);
+        float peakHeight = std::floor(peaks[i] * maxHeight);
+        if (peakHeight <= 0.0f) {
+            continue;
+        }
+        silent = false;
         
-        // Set color based on frequency (low frequencies are blue, high are red)
-        float normalizedFreq = instance->getFrequency() / 1000.0f;
-        if (normalizedFreq > 1.0f) normalizedFreq = 1.0f;
+        // Set color based on the band (low frequencies are blue, high are red)
+        float normalizedBand = i / float(SPECTRUM_BANDS - 1);
         
-        // Calculate position - spread evenly across the screen
-        float xPos = i * (WINDOW_WIDTH / float(MAX_VISIBLE_BARS));
+        SDL_Color color = {0, 0, 0, 255};
+        color.r = static_cast<Uint8>(normalizedBand * 255);
+        color.g = static_cast<Uint8>((1.0f - normalizedBand) * 128);
+        color.b = static_cast<Uint8>((1.0f - normalizedBand) * 255);
         
-        // Calculate width based on number of active sounds
-        float width = WINDOW_WIDTH / float(MAX_VISIBLE_BARS) - 5.0f;
+        float xPos = i * bandWidth;
+        float width = bandWidth - 2.0f;
         
-        color.r = static_cast<Uint8>(normalizedFreq * 255);
-        color.g = static_cast<Uint8>((1.0f - normalizedFreq) * 128);
-        color.b = static_cast<Uint8>((1.0f - normalizedFreq) * 255);
-        color.a = 255;
+        // The bar
+        if (barHeight > 0.0f) {
+            SDL_FRect bar = {
+                xPos,
+                WINDOW_HEIGHT - barHeight - 50.0f,
+                width,
+                barHeight
+            };
+            addRect(bar, color);
+        }
         
-        // Draw the bar
-        SDL_FRect bar = {
+        // Peak marker
+        SDL_FRect peak = {
             xPos,
-            WINDOW_HEIGHT - barHeight - 50.0f,
+            WINDOW_HEIGHT - peakHeight - 50.0f - 2.0f,
             width,
-            static_cast<float>(barHeight)
+            2.0f
         };
-        
-        SDL_SetRenderDrawColor(renderer, color.r, color.g, color.b, color.a);
-        SDL_RenderFillRect(renderer, &bar);
-        
-        i++;
+        addRect(peak, {230, 230, 230, 255});
     }
     
-    // Display recording/playback status
-    SDL_FRect statusBox = {
-        10.0f, 10.0f,
-        static_cast<float>(STATUS_BOX_WIDTH), static_cast<float>(STATUS_BOX_HEIGHT)
-    };
-    
-    if (soundManager.isCurrentlyRecording()) {
-        // Red for recording
-        SDL_SetRenderDrawColor(renderer, 255, 40, 40, 200);
-    } else if (soundManager.isCurrentlyPlaying()) {
-        // Green for playback
-        SDL_SetRenderDrawColor(renderer, 40, 255, 40, 200);
+    // If nothing is playing or ringing out, just show a placeholder
+    if (silent && playingCount == 0) {
+        SDL_FRect bar = {
+            WINDOW_WIDTH / 2.0f - 50.0f,
+            WINDOW_HEIGHT - 50.0f - 20.0f,
+            100.0f,
+            20.0f
+        };
+        addRect(bar, {100, 100, 100, 255});
     } else {
-        // Black for idle
-        SDL_SetRenderDrawColor(renderer, 0, 0, 0, 180);
+        // Display recording/playback status
+        SDL_FRect statusBox = {
+            10.0f, 10.0f,
+            static_cast<float>(STATUS_BOX_WIDTH), static_cast<float>(STATUS_BOX_HEIGHT)
+        };
+        
+        if (soundManager.isCurrentlyRecording()) {
+            // Red for recording
+            addRect(statusBox, {255, 40, 40, 200});
+        } else if (soundManager.isCurrentlyPlaying()) {
+            // Green for playback
+            addRect(statusBox, {40, 255, 40, 200});
+        } else {
+            // Black for idle
+            addRect(statusBox, {0, 0, 0, 180});
+        }
+        
+        // Box for the count of playing sounds
+        SDL_FRect countBox = {
+            10.0f, 50.0f,
+            static_cast<float>(STATUS_BOX_WIDTH), static_cast<float>(STATUS_BOX_HEIGHT)
+        };
+        addRect(countBox, {0, 0, 0, 180});
     }
     
-    SDL_RenderFillRect(renderer, &statusBox);
-    
-    // Display count of playing sounds
-    char countText[32];
-    snprintf(countText, sizeof(countText), "Playing: %d", playingCount);
-    SDL_FRect countBox = {
-        10.0f, 50.0f,
-        static_cast<float>(STATUS_BOX_WIDTH), static_cast<float>(STATUS_BOX_HEIGHT)
-    };
+    // Only a different frame needs drawing
+    if (vertices.size() == drawn.size() &&
+        std::memcmp(vertices.data(), drawn.data(), vertices.size() * sizeof(SDL_Vertex)) == 0) {
+        return false;
+    }
+    drawn.swap(vertices);
+    return true;
+}
+
+void SoundVisualizer::RenderPlayingSounds(SDL_Renderer *renderer) {
+    if (drawn.empty()) {
+        return;
+    }
     
-    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 180);
-    SDL_RenderFillRect(renderer, &countBox);
-}
\ No newline at end of file
+    const int rects = static_cast<int>(drawn.size() / 4);
+    SDL_RenderGeometry(renderer, nullptr, drawn.data(), static_cast<int>(drawn.size()), indices.data(), rects * 6);
+}
@@ -1,12 +1,27 @@
 #pragma once
 
 #include <SDL3/SDL.h>
+#include <vector>
 #include "soundManager.hpp"
 #include "config.hpp"
 
-// Class to handle sound visualizations
+// Class to handle sound visualizations. Every rectangle of a frame goes into one vertex
+// array that is submitted with a single SDL_RenderGeometry call, and a frame identical to
+// the one on screen is reported as unchanged so the caller can skip drawing it.
 class SoundVisualizer {
+private:
+    std::vector<SDL_Vertex> vertices; // This frame, four per rectangle
+    std::vector<SDL_Vertex> drawn;    // The frame on screen
+    std::vector<int> indices;         // Two triangles per rectangle, built once
+    
+    void addRect(const SDL_FRect& rect, SDL_Color color);
+    
 public:
-    // Render visualization of the playing sounds
-    static void RenderPlayingSounds(SDL_Renderer *renderer, SoundManager& soundManager);
-};
\ No newline at end of file
+    SoundVisualizer();
+    
+    // Lay out the playing sounds; returns false if the frame matches the one on screen
+    bool Update(SoundManager& soundManager);
+    
+    // Render the frame laid out by the last Update
+    void RenderPlayingSounds(SDL_Renderer *renderer);
+};
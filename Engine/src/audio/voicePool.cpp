@@ -0,0 +1,351 @@
+#include "voicePool.hpp"
+#include "config.hpp"
+
+void Note::start(const WavetableSet& wavetable, const SampleData* sampleData, double playbackRate,
+                 Interpolation mode, double frequency, float g, const EnvelopeParams& envelopeParams,
+                 int releaseAt, int delay) {
+    interpolation = mode;
+    phase = 0;
+    phaseIncrement = static_cast<Uint32>(frequency / AUDIO_SAMPLE_RATE * 4294967296.0);
+    table = wavetable.getTable(phaseIncrement);
+    
+    // A block's offsets stay within 32 bits up to SAMPLER_MAX_PITCH_RATIO
+    sample = sampleData;
+    samplePosition = 0;
+    playbackRate = SDL_clamp(playbackRate, 0.0, SAMPLER_MAX_PITCH_RATIO);
+    sampleIncrement = static_cast<Uint32>(playbackRate * (1u << SAMPLE_FRACTION_BITS) + 0.5);
+    if (sampleIncrement == 0) sampleIncrement = 1;
+    
+    envelope.start(envelopeParams, releaseAt);
+    gain = g;
+    startDelay = delay > 0 ? delay : 0;
+}
+
+void Note::noteOff(int delay) {
+    // The envelope counts from the note's own start, which may still be ahead
+    envelope.noteOff(delay - startDelay);
+}
+
+void Note::setPan(const float* gains, int channels, bool immediate) {
+    for (int c = 0; c < channels; c++) {
+        panTargets[c] = gains[c];
+        if (immediate) {
+            panGains[c] = gains[c];
+        }
+    }
+}
+
+int Note::sampleFramesLeft(int n) const {
+    const Uint64 end = static_cast<Uint64>(sample->getFrames()) << SAMPLE_FRACTION_BITS;
+    if (samplePosition >= end) return 0;
+    
+    const Uint64 left = (end - samplePosition + sampleIncrement - 1) / sampleIncrement;
+    return left < static_cast<Uint64>(n) ? static_cast<int>(left) : n;
+}
+
+void Note::render(const DspKernels& kernels, float* out, int channels, int frames) {
+    float oscillator[MIX_BLOCK_FRAMES];
+    float levels[MIX_BLOCK_FRAMES];
+    float steps[MAX_OUTPUT_CHANNELS];
+    
+    // Not started yet: leave the frames before the note-on untouched
+    if (startDelay > 0) {
+        int waiting = startDelay < frames ? startDelay : frames;
+        startDelay -= waiting;
+        out += waiting;
+        frames -= waiting;
+    }
+    
+    for (int done = 0; done < frames && !isFinished(); done += MIX_BLOCK_FRAMES) {
+        int n = frames - done < MIX_BLOCK_FRAMES ? frames - done : MIX_BLOCK_FRAMES;
+        
+        // A sample that runs out mid-block leaves silence behind it and ends the note
+        int sounding = n;
+        if (sample) {
+            sounding = sampleFramesLeft(n);
+            kernels.renderSample(sample->getSamples() + (samplePosition >> SAMPLE_FRACTION_BITS),
+                                 static_cast<Uint32>(samplePosition & SAMPLE_FRACTION_MASK), sampleIncrement,
+                                 oscillator, sounding, interpolation);
+            SDL_memset(oscillator + sounding, 0, (n - sounding) * sizeof(float));
+            samplePosition += static_cast<Uint64>(sampleIncrement) * sounding;
+        } else {
+            kernels.renderWavetable(table, phase, phaseIncrement, oscillator, n, interpolation);
+            phase += phaseIncrement * static_cast<Uint32>(n);
+        }
+        
+        envelope.render(kernels, levels, n, gain);
+        
+        // Glide to a new position across the block, so moving a voice never clicks
+        for (int c = 0; c < channels; c++) {
+            steps[c] = (panTargets[c] - panGains[c]) / static_cast<float>(n);
+        }
+        kernels.panMultiplyAdd(out + done, MIX_BLOCK_FRAMES, channels, oscillator, levels, panGains, steps, n);
+        for (int c = 0; c < channels; c++) {
+            panGains[c] = panTargets[c];
+        }
+        
+        if (sounding < n) {
+            envelope.stop();
+        }
+    }
+}
+
+void Note::skip(int channels, int frames) {
+    if (startDelay > 0) {
+        int waiting = startDelay < frames ? startDelay : frames;
+        startDelay -= waiting;
+        frames -= waiting;
+    }
+    
+    // Same steps as render: phase and envelope position are exact integers, so nothing drifts
+    for (int done = 0; done < frames && !isFinished(); done += MIX_BLOCK_FRAMES) {
+        int n = frames - done < MIX_BLOCK_FRAMES ? frames - done : MIX_BLOCK_FRAMES;
+        int sounding = n;
+        if (sample) {
+            sounding = sampleFramesLeft(n);
+            samplePosition += static_cast<Uint64>(sampleIncrement) * sounding;
+        }
+        phase += phaseIncrement * static_cast<Uint32>(n);
+        envelope.skip(n);
+        for (int c = 0; c < channels; c++) {
+            panGains[c] = panTargets[c];
+        }
+        if (sounding < n) {
+            envelope.stop();
+        }
+    }
+}
+
+VoicePool::VoicePool(int capacity, const SpeakerLayout& speakerLayout, VoiceStealPolicy policy, int stealFadeMs)
+    : voices(capacity), activePos(capacity, -1),
+      batchBus(static_cast<size_t>(speakerLayout.channels) * MIX_BLOCK_FRAMES, 0.0f), stealPolicy(policy), nextSerial(0),
+      stealFadeSamples((stealFadeMs * AUDIO_SAMPLE_RATE) / 1000), interpolation(Interpolation::Linear),
+      kernels(getDspKernels()), layout(speakerLayout), playingCount(0) {
+    
+    freeList.reserve(capacity);
+    activeList.reserve(capacity);
+    finishedSlots.reserve(capacity);
+    
+    // Push in reverse so slot 0 is handed out first
+    for (int slot = capacity - 1; slot >= 0; slot--) {
+        freeList.push_back(slot);
+    }
+}
+
+VoicePool::VoicePool(const VoicePool& other)
+    : voices(other.voices), freeList(other.freeList), activeList(other.activeList), activePos(other.activePos),
+      finishedSlots(other.finishedSlots), batchBus(other.batchBus), stealPolicy(other.stealPolicy), nextSerial(other.nextSerial),
+      stealFadeSamples(other.stealFadeSamples), interpolation(other.interpolation), kernels(other.kernels),
+      layout(other.layout), playingCount(other.playingCount.load(std::memory_order_relaxed)) {
+    
+    // Keep the same headroom, so a copy never allocates on the mixing path either
+    freeList.reserve(voices.size());
+    activeList.reserve(voices.size());
+    finishedSlots.reserve(voices.size());
+}
+
+int VoicePool::findVictim(double frequency) const {
+    // A slot holds one tail, so stealing one that is still fading would cut that tail dead
+    int victim = -1;
+    for (int slot : activeList) {
+        if (!voices[slot].isTailBusy()) {
+            victim = slot;
+            break;
+        }
+    }
+    
+    // Every slot is fading a tail (a burst of steals): cut the one closest to silence
+    if (victim < 0) {
+        victim = activeList[0];
+        float lowest = voices[victim].getTailLevel();
+        for (int slot : activeList) {
+            float level = voices[slot].getTailLevel();
+            if (level < lowest) {
+                lowest = level;
+                victim = slot;
+            }
+        }
+        return victim;
+    }
+    
+    if (stealPolicy == VoiceStealPolicy::Quietest) {
+        float lowest = voices[victim].getLevel();
+        for (int slot : activeList) {
+            float level = voices[slot].getLevel();
+            if (!voices[slot].isTailBusy() && level < lowest) {
+                lowest = level;
+                victim = slot;
+            }
+        }
+        return victim;
+    }
+    
+    if (stealPolicy == VoiceStealPolicy::SameNote) {
+        int sameNote = -1;
+        for (int slot : activeList) {
+            if (!voices[slot].isTailBusy() && voices[slot].frequency == frequency &&
+                (sameNote < 0 || voices[slot].serial < voices[sameNote].serial)) {
+                sameNote = slot;
+            }
+        }
+        if (sameNote >= 0) return sameNote;
+    }
+    
+    // Oldest (also the SameNote fallback)
+    for (int slot : activeList) {
+        if (!voices[slot].isTailBusy() && voices[slot].serial < voices[victim].serial) {
+            victim = slot;
+        }
+    }
+    return victim;
+}
+
+int VoicePool::allocate(const WavetableSet& wavetable, const SampleData* sample, double playbackRate,
+                        double frequency, float gain, float azimuth, const EnvelopeParams& envelopeParams,
+                        int releaseAt, int soundId, int startDelay) {
+    int slot;
+    
+    if (!freeList.empty()) {
+        slot = freeList.back();
+        freeList.pop_back();
+        activePos[slot] = static_cast<int>(activeList.size());
+        activeList.push_back(slot);
+        playingCount.store(static_cast<int>(activeList.size()), std::memory_order_relaxed);
+        
+        voices[slot].tailActive = false;
+    } else {
+        // Pool is full: keep the victim's note as a short fading tail in the same slot
+        slot = findVictim(frequency);
+        
+        Voice& voice = voices[slot];
+        if (!voice.note.isFinished()) {
+            voice.tail = voice.note;
+            voice.tail.envelope.fadeOut(stealFadeSamples);
+            voice.tailActive = true;
+        }
+    }
+    
+    Voice& voice = voices[slot];
+    voice.note.start(wavetable, sample, playbackRate, interpolation, frequency, gain, envelopeParams, releaseAt,
+                     startDelay);
+    float gains[MAX_OUTPUT_CHANNELS];
+    layout.computeGains(azimuth, gains);
+    voice.note.setPan(gains, layout.channels, true);
+    voice.soundId = soundId;
+    voice.frequency = frequency;
+    voice.azimuth = azimuth;
+    voice.serial = nextSerial++;
+    return slot;
+}
+
+void VoicePool::noteOff(int soundId, int delay) {
+    for (int slot : activeList) {
+        Note& note = voices[slot].note;
+        if (voices[slot].soundId == soundId && note.envelope.releaseAt == Envelope::NEVER) {
+            note.noteOff(delay);
+        }
+    }
+}
+
+void VoicePool::setPosition(int soundId, float azimuth) {
+    float gains[MAX_OUTPUT_CHANNELS];
+    layout.computeGains(azimuth, gains);
+    for (int slot : activeList) {
+        Voice& voice = voices[slot];
+        if (voice.soundId == soundId) {
+            voice.note.setPan(gains, layout.channels, false);
+            voice.azimuth = azimuth;
+        }
+    }
+}
+
+void VoicePool::noteOffAll(int delay) {
+    for (int slot : activeList) {
+        Note& note = voices[slot].note;
+        if (note.envelope.releaseAt == Envelope::NEVER) {
+            note.noteOff(delay);
+        }
+    }
+}
+
+void VoicePool::freeSlot(int slot) {
+    // Swap-remove from the dense active list
+    int index = activePos[slot];
+    int lastSlot = activeList.back();
+    activeList[index] = lastSlot;
+    activePos[lastSlot] = index;
+    activeList.pop_back();
+    activePos[slot] = -1;
+    
+    freeList.push_back(slot);
+    playingCount.store(static_cast<int>(activeList.size()), std::memory_order_relaxed);
+}
+
+void VoicePool::renderVoice(Voice& voice, float* out, int frames) {
+    voice.note.render(kernels, out, layout.channels, frames);
+    
+    // Stolen note fading out underneath
+    if (voice.tailActive) {
+        voice.tail.render(kernels, out, layout.channels, frames);
+        voice.tailActive = !voice.tail.isFinished();
+    }
+}
+
+void VoicePool::renderBatch(void* pool, int batch, float* bus, int frames) {
+    VoicePool* self = static_cast<VoicePool*>(pool);
+    const int count = static_cast<int>(self->activeList.size());
+    const int end = (batch + 1) * MIX_BATCH_VOICES < count ? (batch + 1) * MIX_BATCH_VOICES : count;
+    for (int i = batch * MIX_BATCH_VOICES; i < end; i++) {
+        self->renderVoice(self->voices[self->activeList[i]], bus, frames);
+    }
+}
+
+void VoicePool::advance(float* out, int frames) {
+    finishedSlots.clear();
+    
+    // Large mixes are rendered in batches across the worker threads; freeing stays below, in order
+    const int count = static_cast<int>(activeList.size());
+    const int batches = (count + MIX_BATCH_VOICES - 1) / MIX_BATCH_VOICES;
+    const bool parallel = out && workers && count >= MIX_PARALLEL_MIN_VOICES && batches <= workers->getMaxBatches() &&
+                          workers->getBusSamples() == layout.channels * MIX_BLOCK_FRAMES;
+    const bool batched = parallel || (out && MIX_DETERMINISTIC && count >= MIX_PARALLEL_MIN_VOICES);
+    if (parallel) {
+        workers->run(renderBatch, this, batches, out, frames);
+    } else if (batched) {
+        // The same batches summed in the same order as the workers would, so a mix comes out
+        // the same with or without them (one core, offline renders)
+        const float* partial = batchBus.data();
+        for (int batch = 0; batch < batches; batch++) {
+            SDL_memset(batchBus.data(), 0, batchBus.size() * sizeof(float));
+            renderBatch(this, batch, batchBus.data(), frames);
+            kernels.sumBuses(out, &partial, 1, static_cast<int>(batchBus.size()));
+        }
+    }
+    
+    // Walk backwards so swap-removal doesn't skip anyone
+    for (int i = count - 1; i >= 0; i--) {
+        int slot = activeList[i];
+        Voice& voice = voices[slot];
+        
+        if (out && !batched) {
+            renderVoice(voice, out, frames);
+        } else if (!out) {
+            voice.note.skip(layout.channels, frames);
+            if (voice.tailActive) {
+                voice.tail.skip(layout.channels, frames);
+                voice.tailActive = !voice.tail.isFinished();
+            }
+        }
+        
+        if (voice.note.isFinished() && !voice.tailActive) {
+            freeSlot(slot);
+            finishedSlots.push_back(slot);
+        }
+    }
+}
+
+void VoicePool::clear() {
+    while (!activeList.empty()) {
+        freeSlot(activeList.back());
+    }
+}
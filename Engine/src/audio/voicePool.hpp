@@ -0,0 +1,182 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <atomic>
+#include <vector>
+#include "dsp/dspKernels.hpp"
+#include "envelope.hpp"
+#include "mixWorkers.hpp"
+#include "samplePool.hpp"
+#include "speakerLayout.hpp"
+#include "wavetable.hpp"
+
+// How to pick a victim when every voice in the pool is busy
+enum class VoiceStealPolicy {
+    Oldest,   // The voice that started first
+    Quietest, // The voice with the lowest current level
+    SameNote  // The oldest voice playing the same note, falling back to Oldest
+};
+
+// Oscillator and envelope state of one note, rendered a block at a time.
+// The phase is a 32-bit fixed-point accumulator (2^32 is one cycle), so it
+// wraps for free and never drifts however long the note sounds. A sampled note
+// reads its SampleData in place instead, and ends when it runs out of frames.
+struct Note {
+    const float* table; // Wavetable level picked for this pitch
+    Interpolation interpolation;
+    Uint32 phase;
+    Uint32 phaseIncrement;
+    const SampleData* sample; // Played instead of the wavetable, nullptr = oscillator
+    Uint64 samplePosition;    // Fixed point, SAMPLE_FRACTION_BITS below the frame
+    Uint32 sampleIncrement;   // Sample frames per output frame, same format
+    Envelope envelope;
+    float gain;
+    int startDelay;     // Frames of silence before the note begins, for sample-accurate note-ons
+    float panGains[MAX_OUTPUT_CHANNELS];   // Gain per output channel the last block ended on
+    float panTargets[MAX_OUTPUT_CHANNELS]; // and the one the next block ramps to
+    
+    // releaseAt is the sample the release starts at (Envelope::NEVER = until noteOff).
+    // The note begins startDelay frames into the next rendered block. With a sample, it is
+    // played at playbackRate sample frames per output frame and the wavetable is unused
+    void start(const WavetableSet& wavetable, const SampleData* sample, double playbackRate,
+               Interpolation interpolation, double frequency, float gain, const EnvelopeParams& envelopeParams,
+               int releaseAt, int startDelay = 0);
+    
+    // Start the release `delay` frames into the next rendered block
+    void noteOff(int delay = 0);
+    
+    // Gains of every output channel; the next block ramps to them, or with `immediate` starts there
+    void setPan(const float* gains, int channels, bool immediate);
+    
+    // Add the next frames (at most MIX_BLOCK_FRAMES) to a planar bus of `channels` channels,
+    // MIX_BLOCK_FRAMES apart
+    void render(const DspKernels& kernels, float* out, int channels, int frames);
+    
+    // Advance exactly as render would for `channels` channels, without synthesizing anything
+    void skip(int channels, int frames);
+    
+    // Frames of the next n a sampled note still has data for
+    int sampleFramesLeft(int n) const;
+    
+    bool isFinished() const { return envelope.isFinished(); }
+};
+
+// One pooled voice. Voices are reused in place, never reallocated
+struct Voice {
+    Note note;          // The note being played
+    int soundId;        // Sound template that started it
+    double frequency;   // Note identity for same-note stealing
+    float azimuth;      // Position in degrees, 0 = ahead, positive to the right
+    Uint64 serial;      // Allocation order, used for oldest-first stealing
+    
+    // Note this slot was stolen from, faded out over a few ms to avoid a click
+    Note tail;
+    bool tailActive;
+    
+    // Current level of the main note (0 when finished)
+    float getLevel() const { return note.isFinished() ? 0.0f : note.gain * note.envelope.getLevel(); }
+    
+    // Current level of the fading tail (0 when there is none)
+    float getTailLevel() const { return tailActive ? tail.gain * tail.envelope.getLevel() : 0.0f; }
+    
+    // Whether stealing the slot now would cut its fading tail short (a playing note would take its place)
+    bool isTailBusy() const { return tailActive && !note.isFinished(); }
+};
+
+// Fixed-capacity voice storage with O(1) allocate/free.
+// All slots are created up front; the note-on path never touches the heap.
+// Not thread safe: only the audio thread touches it, the UI talks to it through commands.
+class VoicePool {
+private:
+    std::vector<Voice> voices;      // Fixed storage, sized once
+    std::vector<int> freeList;      // Stack of free slot indices
+    std::vector<int> activeList;    // Dense list of busy slots for iteration
+    std::vector<int> activePos;     // Slot -> index in activeList
+    std::vector<int> finishedSlots; // Slots freed by the last mix
+    std::vector<float> batchBus;    // Partial bus of one batch, when batches are mixed on this thread alone
+    VoiceStealPolicy stealPolicy;
+    Uint64 nextSerial;
+    int stealFadeSamples;           // Length of the anti-click fade for stolen voices
+    Interpolation interpolation;    // Oscillator quality for new notes
+    const DspKernels& kernels;      // DSP loops for this CPU
+    const SpeakerLayout& layout;    // Channels voices are panned into
+    std::atomic<int> playingCount;  // Mirrors activeList.size() for lock-free readers
+    MixWorkers* workers = nullptr;  // Threads sharing large mixes, nullptr = this thread alone
+    
+    // Pick the slot to reuse when the pool is full. Slots whose stolen tail is still fading
+    // are passed over unless every slot is busy that way
+    int findVictim(double frequency) const;
+    
+    // Return a slot to the free list
+    void freeSlot(int slot);
+    
+    // Render (or with out == nullptr, skip) every active voice into a planar bus and free the finished ones
+    void advance(float* out, int frames);
+    
+    // Add one voice (note and stolen tail) to a planar bus
+    void renderVoice(Voice& voice, float* out, int frames);
+    
+    // MixWorkers::BatchFn: add the voices of batch `batch` of activeList to bus
+    static void renderBatch(void* pool, int batch, float* bus, int frames);
+    
+public:
+    VoicePool(int capacity, const SpeakerLayout& layout, VoiceStealPolicy policy = VoiceStealPolicy::SameNote,
+              int stealFadeMs = 5);
+    
+    // Exact copy of every voice and of the slot order, so a copy mixes the same samples.
+    // The copy mixes on its own thread only
+    VoicePool(const VoicePool& other);
+    
+    // Start a note at azimuth `startDelay` frames into the next mixed block and return its slot:
+    // the wavetable at frequency, or with a sample, the sample at playbackRate.
+    // Steals a voice according to the policy when the pool is full
+    int allocate(const WavetableSet& wavetable, const SampleData* sample, double playbackRate, double frequency,
+                 float gain, float azimuth, const EnvelopeParams& envelopeParams, int releaseAt, int soundId,
+                 int startDelay = 0);
+    
+    // Move every voice of a sound; the gains glide there over the next block
+    void setPosition(int soundId, float azimuth);
+    
+    // Start the release of every held (not timed) voice of a sound, `delay` frames into the next block
+    void noteOff(int soundId, int delay = 0);
+    
+    // Start the release of every held voice, `delay` frames into the next block
+    void noteOffAll(int delay = 0);
+    
+    // Render the next block of all active voices into a planar bus of getChannels() channels,
+    // MIX_BLOCK_FRAMES apart, and free the ones that finished
+    void mix(float* out, int frames) { advance(out, frames); }
+    
+    // Move every voice forward as mix would, without rendering; the state afterwards is identical
+    void skip(int frames) { advance(nullptr, frames); }
+    
+    // Slots the last mix() freed
+    const std::vector<int>& getFinishedSlots() const { return finishedSlots; }
+    
+    // Drop every voice immediately
+    void clear();
+    
+    // Number of busy voices (safe to read from any thread)
+    int getPlayingCount() const { return playingCount.load(std::memory_order_relaxed); }
+    int getCapacity() const { return static_cast<int>(voices.size()); }
+    int getChannels() const { return layout.channels; }
+    const SpeakerLayout& getLayout() const { return layout; }
+    
+    void setStealPolicy(VoiceStealPolicy policy) { stealPolicy = policy; }
+    VoiceStealPolicy getStealPolicy() const { return stealPolicy; }
+    
+    // Share mixes of MIX_PARALLEL_MIN_VOICES or more voices with these threads (nullptr = none).
+    // They must outlive the pool or be detached first
+    void setWorkers(MixWorkers* pool) { workers = pool; }
+    
+    void setInterpolation(Interpolation mode) { interpolation = mode; }
+    Interpolation getInterpolation() const { return interpolation; }
+    
+    // Visit every busy voice
+    template <typename Fn>
+    void forEachActive(Fn&& fn) const {
+        for (int slot : activeList) {
+            fn(voices[slot]);
+        }
+    }
+};
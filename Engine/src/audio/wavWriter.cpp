@@ -0,0 +1,119 @@
+#include "wavWriter.hpp"
+#include "recording.hpp"
+#include <cmath>
+
+#define WAV_FORMAT_PCM 1
+#define WAV_FORMAT_IEEE_FLOAT 3
+#define WAV_FORMAT_EXTENSIBLE 0xFFFE
+#define WAV_MAX_DATA_BYTES 0xFFFFFF00ull // RIFF sizes are 32-bit; leave room for the header
+
+bool WavWriter::open(const std::string& filename, WavFormat wavFormat, int channelCount, int rate) {
+    close();
+    
+    format = wavFormat;
+    channels = channelCount;
+    sampleRate = rate;
+    dataBytes = 0;
+    
+    file.open(filename, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        return false;
+    }
+    
+    writeHeader();
+    return file.good();
+}
+
+void WavWriter::writeHeader() {
+    const bool isFloat = format == WavFormat::Float32;
+    const int bytesPerSample = isFloat ? 4 : 2;
+    
+    // Float files carry the extended fmt chunk and a fact chunk, as the spec asks for non-PCM data.
+    // More than two channels need the extensible fmt chunk to say which speaker each one is
+    const bool extensible = channels > 2;
+    std::vector<Uint8> header;
+    const Uint64 fmtSize = extensible ? 40 : isFloat ? 18 : 16;
+    const Uint64 factSize = isFloat ? 12 : 0;
+    header.insert(header.end(), {'R', 'I', 'F', 'F'});
+    writeLE(header, 4 + (8 + fmtSize) + factSize + 8 + dataBytes, 4);
+    header.insert(header.end(), {'W', 'A', 'V', 'E'});
+    
+    header.insert(header.end(), {'f', 'm', 't', ' '});
+    writeLE(header, fmtSize, 4);
+    const int formatCode = isFloat ? WAV_FORMAT_IEEE_FLOAT : WAV_FORMAT_PCM;
+    writeLE(header, extensible ? WAV_FORMAT_EXTENSIBLE : formatCode, 2);
+    writeLE(header, channels, 2);
+    writeLE(header, sampleRate, 4);
+    writeLE(header, static_cast<Uint64>(sampleRate) * channels * bytesPerSample, 4);
+    writeLE(header, channels * bytesPerSample, 2);
+    writeLE(header, bytesPerSample * 8, 2);
+    if (extensible) {
+        // Speakers in SDL's channel order: FL FR BL BR (quad) or FL FR FC LFE BL BR (5.1)
+        writeLE(header, 22, 2);
+        writeLE(header, bytesPerSample * 8, 2);
+        writeLE(header, channels == 4 ? 0x33 : channels == 6 ? 0x3F : 0, 4);
+        writeLE(header, formatCode, 2);
+        header.insert(header.end(), {0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71});
+    } else if (isFloat) {
+        writeLE(header, 0, 2);
+    }
+    if (isFloat) {
+        header.insert(header.end(), {'f', 'a', 'c', 't'});
+        writeLE(header, 4, 4);
+        writeLE(header, getFramesWritten(), 4);
+    }
+    
+    header.insert(header.end(), {'d', 'a', 't', 'a'});
+    writeLE(header, dataBytes, 4);
+    
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(header.data()), header.size());
+}
+
+bool WavWriter::write(const float* samples, int frames) {
+    if (!file.is_open()) {
+        return false;
+    }
+    
+    const int count = frames * channels;
+    const bool isFloat = format == WavFormat::Float32;
+    const size_t bytes = static_cast<size_t>(count) * (isFloat ? 4 : 2);
+    if (dataBytes + bytes > WAV_MAX_DATA_BYTES) {
+        SDL_Log("WAV file is full (4 GB RIFF limit), stopped writing");
+        return false;
+    }
+    
+    buffer.resize(bytes);
+    Uint8* out = buffer.data();
+    for (int i = 0; i < count; i++) {
+        if (isFloat) {
+            Uint32 bits;
+            SDL_memcpy(&bits, &samples[i], 4);
+            bits = SDL_Swap32LE(bits);
+            SDL_memcpy(out + i * 4, &bits, 4);
+        } else {
+            float sample = samples[i] < -1.0f ? -1.0f : (samples[i] > 1.0f ? 1.0f : samples[i]);
+            Uint16 value = SDL_Swap16LE(static_cast<Uint16>(static_cast<Sint16>(std::lrint(sample * 32767.0f))));
+            SDL_memcpy(out + i * 2, &value, 2);
+        }
+    }
+    
+    file.write(reinterpret_cast<const char*>(out), bytes);
+    dataBytes += bytes;
+    return file.good();
+}
+
+bool WavWriter::close() {
+    if (!file.is_open()) {
+        return false;
+    }
+    
+    writeHeader();
+    const bool ok = file.good();
+    file.close();
+    return ok;
+}
+
+Uint64 WavWriter::getFramesWritten() const {
+    return dataBytes / (channels * (format == WavFormat::Float32 ? 4 : 2));
+}
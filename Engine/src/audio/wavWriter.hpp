@@ -0,0 +1,42 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <fstream>
+#include <string>
+#include <vector>
+
+// Sample format of a written WAV file
+enum class WavFormat {
+    Float32, // IEEE float, the mixer's own samples untouched
+    Pcm16    // 16-bit integer, clipped to [-1, 1]
+};
+
+// Streams interleaved float samples into a WAV file. The header is written with
+// placeholder sizes on open and patched on close, so any length can be written
+// without holding it in memory.
+class WavWriter {
+private:
+    std::ofstream file;
+    WavFormat format = WavFormat::Float32;
+    int channels = 1;
+    int sampleRate = 0;
+    Uint64 dataBytes = 0;
+    std::vector<Uint8> buffer; // One converted write, reused
+    
+    // Header with the current sizes at the start of the file
+    void writeHeader();
+
+public:
+    ~WavWriter() { close(); }
+    
+    // Create or truncate a file and write its header
+    bool open(const std::string& filename, WavFormat format, int channels, int sampleRate);
+    
+    // Append frames of interleaved samples; fails once the file would pass the 4 GB RIFF limit
+    bool write(const float* samples, int frames);
+    
+    // Patch the sizes into the header and close; returns false if anything failed to write
+    bool close();
+    
+    Uint64 getFramesWritten() const;
+};
@@ -0,0 +1,122 @@
+#include "wavetable.hpp"
+#include "config.hpp"
+#include <cmath>
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+WavetableSet::WavetableSet(const std::vector<double>& amplitudes) {
+    // Round the harmonic count up to a power of two so every level halves it
+    maxHarmonics = 1;
+    while (maxHarmonics < static_cast<int>(amplitudes.size()) && maxHarmonics < WAVETABLE_SIZE / 2) {
+        maxHarmonics *= 2;
+    }
+    
+    levelCount = 1;
+    while ((maxHarmonics >> levelCount) > 0) {
+        levelCount++;
+    }
+    
+    const int stride = WAVETABLE_SIZE + WAVETABLE_GUARD;
+    data.resize(static_cast<size_t>(levelCount) * stride);
+    
+    // sin(2*pi*h*i/N) is sine[(h*i) mod N], so the additive synthesis needs no trig calls
+    std::vector<double> sine(WAVETABLE_SIZE);
+    for (int i = 0; i < WAVETABLE_SIZE; i++) {
+        sine[i] = sin(2.0 * M_PI * i / WAVETABLE_SIZE);
+    }
+    
+    // Build from the top level (fewest harmonics) down, adding partials as we go
+    std::vector<double> cycle(WAVETABLE_SIZE, 0.0);
+    int harmonicsDone = 0;
+    
+    for (int level = levelCount - 1; level >= 0; level--) {
+        int harmonics = maxHarmonics >> level;
+        if (harmonics > static_cast<int>(amplitudes.size())) {
+            harmonics = static_cast<int>(amplitudes.size());
+        }
+        
+        for (int h = harmonicsDone + 1; h <= harmonics; h++) {
+            const double amplitude = amplitudes[h - 1];
+            if (amplitude == 0.0) continue;
+            for (int i = 0; i < WAVETABLE_SIZE; i++) {
+                cycle[i] += amplitude * sine[(static_cast<size_t>(h) * i) & (WAVETABLE_SIZE - 1)];
+            }
+        }
+        harmonicsDone = harmonics;
+        
+        float* table = data.data() + static_cast<size_t>(level) * stride;
+        table[0] = static_cast<float>(cycle[WAVETABLE_SIZE - 1]);
+        for (int i = 0; i < WAVETABLE_SIZE; i++) {
+            table[i + 1] = static_cast<float>(cycle[i]);
+        }
+        table[WAVETABLE_SIZE + 1] = static_cast<float>(cycle[0]);
+        table[WAVETABLE_SIZE + 2] = static_cast<float>(cycle[1]);
+    }
+    
+    // Normalize every level by the fullest one so the levels match in loudness
+    double peak = 0.0;
+    for (int i = 0; i < WAVETABLE_SIZE; i++) {
+        peak = fmax(peak, fabs(data[i + 1]));
+    }
+    if (peak > 0.0) {
+        const float scale = static_cast<float>(1.0 / peak);
+        for (float& sample : data) {
+            sample *= scale;
+        }
+    }
+}
+
+const float* WavetableSet::getTable(Uint32 phaseIncrement) const {
+    // Harmonics that fit below Nyquist: (2^32 / 2) / increment
+    Uint64 allowed = phaseIncrement ? (Uint64(1) << 31) / phaseIncrement : Uint64(maxHarmonics);
+    
+    int level = 0;
+    while (level < levelCount - 1 && static_cast<Uint64>(maxHarmonics >> level) > allowed) {
+        level++;
+    }
+    return data.data() + static_cast<size_t>(level) * (WAVETABLE_SIZE + WAVETABLE_GUARD);
+}
+
+const WavetableSet& WavetableSet::get(Waveform waveform) {
+    const int harmonics = WAVETABLE_SIZE / 2;
+    
+    switch (waveform) {
+        case Waveform::Saw: {
+            static const WavetableSet saw([&] {
+                std::vector<double> amplitudes(harmonics);
+                for (int h = 1; h <= harmonics; h++) {
+                    amplitudes[h - 1] = ((h & 1) ? 2.0 : -2.0) / (M_PI * h);
+                }
+                return amplitudes;
+            }());
+            return saw;
+        }
+        case Waveform::Square: {
+            static const WavetableSet square([&] {
+                std::vector<double> amplitudes(harmonics, 0.0);
+                for (int h = 1; h <= harmonics; h += 2) {
+                    amplitudes[h - 1] = 4.0 / (M_PI * h);
+                }
+                return amplitudes;
+            }());
+            return square;
+        }
+        case Waveform::Triangle: {
+            static const WavetableSet triangle([&] {
+                std::vector<double> amplitudes(harmonics, 0.0);
+                for (int h = 1; h <= harmonics; h += 2) {
+                    amplitudes[h - 1] = ((h & 2) ? -8.0 : 8.0) / (M_PI * M_PI * h * h);
+                }
+                return amplitudes;
+            }());
+            return triangle;
+        }
+        case Waveform::Sine:
+        default: {
+            static const WavetableSet sine(std::vector<double>{1.0});
+            return sine;
+        }
+    }
+}
@@ -0,0 +1,36 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <vector>
+
+// Waveforms the oscillator can play
+enum class Waveform {
+    Sine,
+    Saw,
+    Square,
+    Triangle
+};
+
+// Band-limited single-cycle tables for one waveform, one mip level per octave.
+// Level k holds at most (WAVETABLE_SIZE / 2) >> k harmonics, so picking the level
+// from the phase increment keeps every partial below Nyquist.
+// Each level is stored as [x[N-1], x[0] .. x[N-1], x[0], x[1]] so interpolation
+// never has to wrap: sample i uses table[i .. i + 3].
+class WavetableSet {
+private:
+    std::vector<float> data; // levelCount * (WAVETABLE_SIZE + WAVETABLE_GUARD) samples
+    int levelCount;
+    int maxHarmonics;        // Harmonics in level 0
+    
+public:
+    // amplitudes[h - 1] is the sine amplitude of harmonic h
+    explicit WavetableSet(const std::vector<double>& amplitudes);
+    
+    // Table for a note with the given 32-bit phase increment
+    const float* getTable(Uint32 phaseIncrement) const;
+    
+    int getLevelCount() const { return levelCount; }
+    
+    // Shared tables, built on first use
+    static const WavetableSet& get(Waveform waveform);
+};
@@ -9,8 +9,12 @@
 // Our modular audio system includes
 #include "audio/sound.hpp"
 #include "audio/soundManager.hpp"
+#include "audio/keySounds.hpp"
 #include "audio/visualizer.hpp"
 #include "audio/config.hpp"
+#include "settings/videoSettings.hpp"
+#include "app/framePacer.hpp"
+#include "profiling/frameProfiler.hpp"
 
 // Global delay variable that can be accessed by both main and SoundManager
 int currentDelay = DEFAULT_DELAY_MS;
@@ -23,12 +27,13 @@ std::string generateFilename() {
     oss << "c:\\Users\\nikit\\Desktop\\C++ Development\\GameEngine-SDL-SOUND_TEST\\recordings\\";
     oss << "music_recording_";
     oss << std::put_time(&tm, "%Y%m%d_%H%M%S");
-    oss << ".txt";
+    oss << RECORDING_EXTENSION;
     return oss.str();
 }
 
 // Helper function to handle note key events
-void handleNoteKeyEvent(SoundManager &soundManager, const std::vector<double> &frequencies, int key, bool isKeyDown) {
+void handleNoteKeyEvent(SoundManager &soundManager, const KeySounds &keySounds, const std::vector<double> &frequencies,
+                        int key, bool isKeyDown, Uint64 timestamp) {
     int noteIndex = 0;
     
     // Handle numeric keys 1-9
@@ -64,31 +69,29 @@ void handleNoteKeyEvent(SoundManager &soundManager, const std::vector<double> &f
     }
     
     // Ensure we don't access frequencies out of bounds
-    if (noteIndex >= frequencies.size()) {
-        SDL_Log("Note index %d out of bounds (max: %zu)", noteIndex, frequencies.size() - 1);
+    if (noteIndex >= keySounds.notes.size()) {
+        SDL_Log("Note index %d out of bounds (max: %zu)", noteIndex, keySounds.notes.size() - 1);
         return;
     }
     
-    std::string noteName = "note" + std::to_string(noteIndex);
+    SoundHandle note = keySounds.notes[noteIndex];
 
     if (isKeyDown) {
-        soundManager.recordKeyDown(noteName);
+        soundManager.recordKeyDown(note, timestamp);
         SDL_Log("Key down: note %d (%.2f Hz)", noteIndex + 1, frequencies[noteIndex]);
     } else {
-        soundManager.recordKeyUp(noteName);
+        soundManager.recordKeyUp(note, timestamp);
         SDL_Log("Key up: note %d", noteIndex + 1);
     }
 }
 
 // Helper function to handle chord key events
-void handleChordKeyEvent(SoundManager &soundManager, bool isKeyDown) {
-    const std::vector<std::string> chordNotes = {"chord1", "chord2", "chord3"};
-
-    for (const auto &note : chordNotes) {
+void handleChordKeyEvent(SoundManager &soundManager, const KeySounds &keySounds, bool isKeyDown, Uint64 timestamp) {
+    for (SoundHandle note : keySounds.chord) {
         if (isKeyDown) {
-            soundManager.recordKeyDown(note);
+            soundManager.recordKeyDown(note, timestamp);
         } else {
-            soundManager.recordKeyUp(note);
+            soundManager.recordKeyUp(note, timestamp);
         }
     }
 
@@ -96,33 +99,69 @@ void handleChordKeyEvent(SoundManager &soundManager, bool isKeyDown) {
 }
 
 // Helper function to handle drum key events
-void handleDrumKeyEvent(SoundManager &soundManager, int key, bool isKeyDown) {
-    std::string drumName;
+void handleDrumKeyEvent(SoundManager &soundManager, const KeySounds &keySounds, int key, bool isKeyDown,
+                        Uint64 timestamp) {
+    int drumIndex;
     
     // Map numeric keypad keys to different drum sounds
     switch (key) {
-        case SDLK_KP_2: drumName = "kick0"; break;       // Bass drum
-        case SDLK_KP_3: drumName = "kick1"; break;      // Snare drum
-        case SDLK_KP_4: drumName = "kick2"; break;      // Hi-hat
-        case SDLK_KP_5: drumName = "kick3"; break;       // High tom
-        case SDLK_KP_6: drumName = "kick4"; break;       // Mid tom
-        case SDLK_KP_7: drumName = "kick5"; break;      // Crash cymbal
-        case SDLK_KP_8: drumName = "kick6"; break;       // Ride cymbal
-        case SDLK_KP_9: drumName = "kick7"; break;       // Hand clap
+        case SDLK_KP_2: drumIndex = 0; break;       // Bass drum
+        case SDLK_KP_3: drumIndex = 1; break;      // Snare drum
+        case SDLK_KP_4: drumIndex = 2; break;      // Hi-hat
+        case SDLK_KP_5: drumIndex = 3; break;       // High tom
+        case SDLK_KP_6: drumIndex = 4; break;       // Mid tom
+        case SDLK_KP_7: drumIndex = 5; break;      // Crash cymbal
+        case SDLK_KP_8: drumIndex = 6; break;       // Ride cymbal
+        case SDLK_KP_9: drumIndex = 7; break;       // Hand clap
         default: return; // Unknown key, don't process
     }
     
+    SoundHandle drum = keySounds.drums[drumIndex];
+    
     // Process both key down and key up events for drums, just like chords
     if (isKeyDown) {
-        soundManager.recordKeyDown(drumName);
-        SDL_Log("Drum hit: %s", drumName.c_str());
+        soundManager.recordKeyDown(drum, timestamp);
+        SDL_Log("Drum hit: %s", soundManager.getSoundName(drum).c_str());
     } else {
-        soundManager.recordKeyUp(drumName);
-        SDL_Log("Drum released: %s", drumName.c_str());
+        soundManager.recordKeyUp(drum, timestamp);
+        SDL_Log("Drum released: %s", soundManager.getSoundName(drum).c_str());
+    }
+}
+
+// Headless mode: gameengine --render <recording> <output.wav> [--pcm16] [--threads N]
+// Mixes a recording into a WAV file as fast as possible, with no window and no audio device.
+// Every core is used unless --threads says otherwise; the file is the same either way
+int renderMain(int argc, char* argv[]) {
+    if (argc < 4) {
+        SDL_Log("Usage: %s --render <recording> <output.wav> [--pcm16] [--threads N]", argv[0]);
+        return -1;
+    }
+    
+    WavFormat format = WavFormat::Float32;
+    int threads = 0;
+    for (int i = 4; i < argc; i++) {
+        if (SDL_strcmp(argv[i], "--pcm16") == 0) {
+            format = WavFormat::Pcm16;
+        } else if (SDL_strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = SDL_atoi(argv[++i]);
+        }
     }
+    
+    SoundManager soundManager(0);
+    KeySounds keySounds;
+    addKeySounds(soundManager, getNoteFrequencies(), keySounds);
+    
+    if (!soundManager.loadRecordingFromFile(argv[2])) {
+        return -1;
+    }
+    return soundManager.renderRecording(argv[3], format, threads) ? 0 : -1;
 }
 
 int main(int argc, char* argv[]) {
+    if (argc > 1 && SDL_strcmp(argv[1], "--render") == 0) {
+        return renderMain(argc, argv);
+    }
+    
     // Initialize SDL with both video and audio
     if (!SDL_Init(SDL_INIT_VIDEO | SDL_INIT_AUDIO)) {
         SDL_LogError(SDL_LOG_CATEGORY_APPLICATION, "Couldn't initialize SDL: %s", SDL_GetError());
@@ -148,6 +187,21 @@ int main(int argc, char* argv[]) {
         return -1;
     }
     
+    // Frame pacing comes from the video settings, not from the musical delay
+    VideoSettings videoSettings;
+    loadVideoSettings(std::string(RESOURCES_PATH) + VIDEO_SETTINGS_FILE, videoSettings);
+    if (!SDL_SetRenderVSync(renderer, videoSettings.vsync ? 1 : 0)) {
+        SDL_Log("Failed to set vsync: %s", SDL_GetError());
+    }
+    
+    // Frames are paced to the display and drop to idleFPS while nothing changes
+    FramePacer pacer(videoSettings);
+    auto updateRefreshRate = [&]() {
+        const SDL_DisplayMode* mode = SDL_GetCurrentDisplayMode(SDL_GetDisplayForWindow(window));
+        pacer.setRefreshRate(mode ? mode->refresh_rate : 0.0f);
+    };
+    updateRefreshRate();
+    
     // Audio spec
     SDL_AudioSpec audioSpec;
     SDL_zero(audioSpec);
@@ -165,37 +219,8 @@ int main(int argc, char* argv[]) {
         return -1;
     }
     
-    // Define a sequence of frequencies for musical notes - expanded to include deeper notes
-    std::vector<double> frequencies = {
-        65.0,  // C2
-        70.0,  // C#2/Db2
-        75.0,  // D2
-        80.0,  // D#2/Eb2
-        85.0,  // E2
-        90.0,  // F2
-        95.0,  // F#2/Gb2
-        100.0,  // G2
-        105.0, // G#2/Ab2
-        110.0, // A2
-        115.0, // A#2/Bb2
-        120.0, // B2
-        125.0, // C3
-        130.0, // C#3/Db3
-        135.0, // D3
-        140.0, // D#3/Eb3
-        145.0, // E3
-        150.0, // F3
-        155.0, // F#3/Gb3
-        160.0, // G3
-        165.0, // G#3/Ab3
-        170.0, // A3
-        175.0, // A#3/Bb3
-        180.0, // B3
-        185.0, // C4
-        190.0, // C#4/Db4
-        195.0, // D4
-        200.0  // D#4/Eb4
-    };
+    // Frequencies of the note keys
+    std::vector<double> frequencies = getNoteFrequencies();
     
     // Base frequencies to be able to reset or modify the scale
     const std::vector<double> baseFrequencies = frequencies;
@@ -209,44 +234,33 @@ int main(int argc, char* argv[]) {
     // Create the sound manager
     SoundManager soundManager(audioDevice);
     
+    // Handles of the sounds the keys play
+    KeySounds keySounds;
+    
     // Function to update all sound frequencies
     auto updateAllSoundFrequencies = [&]() {
-        // Remove all existing note sounds
-        for (size_t i = 0; i < frequencies.size(); i++) {
-            std::string noteName = "note" + std::to_string(i);
-            soundManager.removeSound(noteName);
-        }
-        
-        // Add sounds with new frequencies
-        for (size_t i = 0; i < frequencies.size(); i++) {
-            std::string noteName = "note" + std::to_string(i);
-            soundManager.addSound(noteName, frequencies[i], 0.3f, 500, 100);
+        // Retune the note sounds in place, so held keys keep retriggering at the new pitch
+        for (size_t i = 0; i < keySounds.notes.size(); i++) {
+            soundManager.setFrequency(keySounds.notes[i], frequencies[i]);
         }
         
         SDL_Log("Frequency shift: %.1f Hz", currentFreqShift);
     };
     
-    // Add sounds for each note with 100ms fadeout
-    for (size_t i = 0; i < frequencies.size(); i++) {
-        std::string noteName = "note" + std::to_string(i);
-        soundManager.addSound(noteName, frequencies[i], 0.3f, 500, 100); // 500ms duration, 100ms fadeout
+    // The same sounds the render mode uses
+    addKeySounds(soundManager, frequencies, keySounds);
+
+    // Pick up a recording that was still in progress when the last session crashed
+    if (soundManager.recoverRecording()) {
+        SDL_Log("Press NumPad - to play the recovered recording or NumPad Enter to save it");
+    }
+
+    // A backing track long enough that it's streamed from disk instead of decoded
+    const std::string backingTrackPath = std::string(RESOURCES_PATH) + STREAM_BACKING_FILE;
+    AudioStream* backingTrack = nullptr;
+    if (SDL_GetPathInfo(backingTrackPath.c_str(), nullptr)) {
+        backingTrack = soundManager.openStream(backingTrackPath);
     }
-    
-    // Create a chord sound with 200ms fadeout for smoother chord endings
-    soundManager.addSound("chord1", 130.81, 0.2f, 5000, 200); // C3 for 3 seconds, 200ms fadeout
-    soundManager.addSound("chord2", 164.81, 0.2f, 5000, 200); // E3 for 3 seconds, 200ms fadeout 
-    soundManager.addSound("chord3", 195.99, 0.2f, 5000, 200); // G3 for 3 seconds, 200ms fadeout
-    
-    // Add drum sounds with appropriate characteristics
-    // Each drum has unique frequency, gain, duration and fadeout parameters to create different percussive sounds
-    soundManager.addSound("kick0", 50.00, 0.8f, 120, 80);     // Bass drum - deeper sound, strong attack, short decay
-    soundManager.addSound("kick1", 55.00, 0.8f, 120, 80);     // Bass drum - deeper sound, strong attack, short decay
-    soundManager.addSound("kick2", 60.00, 0.8f, 120, 80);     // Bass drum - deeper sound, strong attack, short decay
-    soundManager.addSound("kick3", 65.00, 0.8f, 120, 80);     // Bass drum - deeper sound, strong attack, short decay
-    soundManager.addSound("kick4", 70.00, 0.8f, 120, 80);     // Bass drum - deeper sound, strong attack, short decay
-    soundManager.addSound("kick5", 75.00, 0.8f, 120, 80);     // Bass drum - deeper sound, strong attack, short decay
-    soundManager.addSound("kick6", 80.00, 0.8f, 120, 80);     // Bass drum - deeper sound, strong attack, short decay
-    soundManager.addSound("kick7", 85.00, 0.8f, 120, 80);     // Bass drum - deeper sound, strong attack, short decay
 
     // Main loop flag
     bool quit = false;
@@ -275,16 +289,51 @@ int main(int argc, char* argv[]) {
     SDL_Log("Press N to decrease all frequencies by 200 Hz");
     SDL_Log("Press V to decrease delay by 10ms");
     SDL_Log("Press B to increase delay by 10ms");
+    SDL_Log("Press X to switch held keys between sustain and repeat");
+    if (backingTrack) {
+        SDL_Log("Press NumPad . to start/stop the backing track");
+    }
+#if !PRODUCTION_BUILD
+    SDL_Log("Press F3 to show/hide the frame time overlay");
+    
+    // Where frame time goes: events, sound update, visualizer, present and sleep
+    FrameProfiler profiler;
+#endif
+    
+    // Bars and status boxes, redrawn only when they change
+    SoundVisualizer visualizer;
+    bool redraw = true; // The window needs a frame even if the visualizer has nothing new
     
-    // While application is running
     // While application is running
     while (!quit) {
+        // Sleep until input arrives or the next frame is due, so idle costs nothing
+        // and key events are handled as soon as they come in
+        Uint64 nowNS = SDL_GetTicksNS();
+        bool hasEvent;
+        {
+            PROFILE_SCOPE(profiler, ProfileZone::Sleep);
+            hasEvent = SDL_WaitEventTimeout(&e, pacer.getTimeoutMs(nowNS));
+        }
+        
         // Handle events on queue
-        while (SDL_PollEvent(&e)) {
+        for (; hasEvent; hasEvent = SDL_PollEvent(&e)) {
+            PROFILE_SCOPE(profiler, ProfileZone::Events);
+            
+            // Anything the user does may change the screen
+            pacer.wake(e.common.timestamp);
+            
             // User requests quit
             if (e.type == SDL_EVENT_QUIT) {
                 quit = true;
             }
+            // The window's contents were lost or resized
+            else if (e.type == SDL_EVENT_WINDOW_EXPOSED || e.type == SDL_EVENT_WINDOW_PIXEL_SIZE_CHANGED) {
+                redraw = true;
+            }
+            // The window moved to a display with another refresh rate, or the rate changed
+            else if (e.type == SDL_EVENT_WINDOW_DISPLAY_CHANGED || e.type == SDL_EVENT_DISPLAY_CURRENT_MODE_CHANGED) {
+                updateRefreshRate();
+            }
             // User scrolls mouse wheel for volume control
             else if (e.type == SDL_EVENT_MOUSE_WHEEL) {
                 float volumeDelta = e.wheel.y * VOLUME_STEP;
@@ -338,21 +387,37 @@ int main(int argc, char* argv[]) {
                         }
                         break;
                         
+                    case SDLK_KP_PERIOD:
+                        // Start or stop the looping backing track
+                        if (backingTrack && backingTrack->isPlaying()) {
+                            soundManager.stopStream(backingTrack);
+                        } else if (backingTrack) {
+                            soundManager.playStream(backingTrack, STREAM_BACKING_GAIN, 0.0f, true);
+                        }
+                        break;
+                        
                     case SDLK_1: case SDLK_2: case SDLK_3: case SDLK_4:
                     case SDLK_5: case SDLK_6: case SDLK_7: case SDLK_8: case SDLK_9:
                     case SDLK_Q: case SDLK_W: case SDLK_E: case SDLK_R: case SDLK_T: 
                     case SDLK_Z: case SDLK_U: case SDLK_I: case SDLK_O: case SDLK_P:
                     case SDLK_A: case SDLK_S: case SDLK_D: case SDLK_F: case SDLK_G: 
                     case SDLK_H: case SDLK_J: case SDLK_K: case SDLK_L:
-                        handleNoteKeyEvent(soundManager, frequencies, e.key.key, true);
+                        // OS auto-repeat is ignored: a held key sustains or repeats on the audio clock
+                        if (!e.key.repeat) {
+                            handleNoteKeyEvent(soundManager, keySounds, frequencies, e.key.key, true, e.key.timestamp);
+                        }
                         break;
 
                     case SDLK_KP_1:
-                        handleChordKeyEvent(soundManager, true);
+                        if (!e.key.repeat) {
+                            handleChordKeyEvent(soundManager, keySounds, true, e.key.timestamp);
+                        }
                     case SDLK_KP_2: case SDLK_KP_3: case SDLK_KP_4:
                     case SDLK_KP_5: case SDLK_KP_6: case SDLK_KP_7:
                     case SDLK_KP_8: case SDLK_KP_9:
-                        handleDrumKeyEvent(soundManager, e.key.key, true);
+                        if (!e.key.repeat) {
+                            handleDrumKeyEvent(soundManager, keySounds, e.key.key, true, e.key.timestamp);
+                        }
 
                         break;
                         
@@ -381,6 +446,17 @@ int main(int argc, char* argv[]) {
                         }
                         break;
                         
+                    case SDLK_X:
+                        // Switch held keys between sustaining and retriggering
+                        if (soundManager.getArticulation() == Articulation::Sustain) {
+                            soundManager.setArticulation(Articulation::Repeat);
+                            SDL_Log("Held keys now repeat every %d ms", currentDelay);
+                        } else {
+                            soundManager.setArticulation(Articulation::Sustain);
+                            SDL_Log("Held keys now sustain until released");
+                        }
+                        break;
+                        
                     case SDLK_V:
                         // Decrease delay by 10ms
                         if (currentDelay > MIN_DELAY_MS) {
@@ -396,6 +472,12 @@ int main(int argc, char* argv[]) {
                             soundManager.setDelay(currentDelay); // Use the setDelay method
                         }
                         break;
+                        
+#if !PRODUCTION_BUILD
+                    case SDLK_F3:
+                        profiler.toggleOverlay();
+                        break;
+#endif
                 }
             }
             // User releases a key
@@ -407,41 +489,82 @@ int main(int argc, char* argv[]) {
                     case SDLK_Z: case SDLK_U: case SDLK_I: case SDLK_O: case SDLK_P:
                     case SDLK_A: case SDLK_S: case SDLK_D: case SDLK_F: case SDLK_G: 
                     case SDLK_H: case SDLK_J: case SDLK_K: case SDLK_L:
-                        handleNoteKeyEvent(soundManager, frequencies, e.key.key, false);
+                        handleNoteKeyEvent(soundManager, keySounds, frequencies, e.key.key, false, e.key.timestamp);
                         break;
 
                     case SDLK_KP_1:
-                        handleChordKeyEvent(soundManager, false);
+                        handleChordKeyEvent(soundManager, keySounds, false, e.key.timestamp);
                         break;
                         
                     case SDLK_KP_2: case SDLK_KP_3: case SDLK_KP_4:
                     case SDLK_KP_5: case SDLK_KP_6: case SDLK_KP_7:
                     case SDLK_KP_8: case SDLK_KP_9:
-                        handleDrumKeyEvent(soundManager, e.key.key, false);
+                        handleDrumKeyEvent(soundManager, keySounds, e.key.key, false, e.key.timestamp);
                         break;
                 }
             }
         }
         
+        // Woken by input only: keep the frame rate at the cap
+        nowNS = SDL_GetTicksNS();
+        if (!pacer.beginFrame(nowNS)) {
+            continue;
+        }
+        
         // Update sound states
-        soundManager.update();
+        {
+            PROFILE_SCOPE(profiler, ProfileZone::SoundUpdate);
+            soundManager.update();
+        }
         
-        // Clear screen
-        SDL_SetRenderDrawColor(renderer, 30, 30, 30, 255);
-        SDL_RenderClear(renderer);
+        // Lay out the visualization; an unchanged frame is not drawn again
+        {
+            PROFILE_SCOPE(profiler, ProfileZone::Visualizer);
+            redraw = visualizer.Update(soundManager) || redraw;
+        }
         
-        // Render the visualization
-        SoundVisualizer::RenderPlayingSounds(renderer, soundManager);
+#if !PRODUCTION_BUILD
+        // The overlay's figures change every frame
+        redraw = redraw || profiler.isOverlayVisible();
+#endif
+        pacer.endFrame(nowNS, redraw, soundManager.isIdle());
         
-        // Update screen
-        SDL_RenderPresent(renderer);
+        if (redraw) {
+            const Uint64 renderStartNS = SDL_GetTicksNS();
+            
+            // Clear screen
+            SDL_SetRenderDrawColor(renderer, 30, 30, 30, 255);
+            SDL_RenderClear(renderer);
+            
+            // Render the visualization
+            {
+                PROFILE_SCOPE(profiler, ProfileZone::Visualizer);
+                visualizer.RenderPlayingSounds(renderer);
+            }
+            
+#if !PRODUCTION_BUILD
+            profiler.drawOverlay(renderer);
+#endif
+            
+            // Update screen
+            {
+                PROFILE_SCOPE(profiler, ProfileZone::Present);
+                SDL_RenderPresent(renderer);
+            }
+            redraw = false;
+            pacer.countPresent(SDL_GetTicksNS() - renderStartNS);
+        }
         
-        // Small delay to reduce CPU usage
-        SDL_Delay(currentDelay);
+#if !PRODUCTION_BUILD
+        profiler.endFrame();
+#endif
     }
     
+    pacer.logSummary();
+    
     // Clean up
     SDL_CloseAudioDevice(audioDevice);
+    soundManager.stopThreads();
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
     SDL_Quit();
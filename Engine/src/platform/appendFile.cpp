@@ -0,0 +1,93 @@
+#include "appendFile.hpp"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+bool AppendFile::open(const std::string& filename) {
+    close();
+    
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS,
+                              FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    fileHandle = file;
+    return true;
+}
+
+void AppendFile::close() {
+    if (fileHandle) CloseHandle(static_cast<HANDLE>(fileHandle));
+    fileHandle = nullptr;
+}
+
+bool AppendFile::isOpen() const {
+    return fileHandle != nullptr;
+}
+
+bool AppendFile::write(const void* data, size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        DWORD chunk = size > 0x40000000 ? 0x40000000 : static_cast<DWORD>(size);
+        DWORD written = 0;
+        if (!WriteFile(static_cast<HANDLE>(fileHandle), bytes, chunk, &written, nullptr)) {
+            return false;
+        }
+        bytes += written;
+        size -= written;
+    }
+    return true;
+}
+
+bool AppendFile::sync() {
+    return FlushFileBuffers(static_cast<HANDLE>(fileHandle)) != 0;
+}
+
+#else
+
+bool AppendFile::open(const std::string& filename) {
+    close();
+    
+    fd = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    return fd >= 0;
+}
+
+void AppendFile::close() {
+    if (fd >= 0) ::close(fd);
+    fd = -1;
+}
+
+bool AppendFile::isOpen() const {
+    return fd >= 0;
+}
+
+bool AppendFile::write(const void* data, size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t written = ::write(fd, bytes, size);
+        if (written < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+        bytes += written;
+        size -= static_cast<size_t>(written);
+    }
+    return true;
+}
+
+bool AppendFile::sync() {
+#if defined(__APPLE__)
+    return fsync(fd) == 0; // No fdatasync on macOS
+#else
+    return fdatasync(fd) == 0;
+#endif
+}
+
+#endif
@@ -0,0 +1,33 @@
+#pragma once
+
+#include <SDL3/SDL_stdinc.h>
+#include <string>
+
+// Write-only file for journals: unbuffered appends plus an explicit flush to
+// stable storage, so what sync() returned for survives a crash or power loss.
+class AppendFile {
+private:
+#ifdef _WIN32
+    void* fileHandle = nullptr; // HANDLE of the file
+#else
+    int fd = -1;
+#endif
+    
+public:
+    AppendFile() = default;
+    ~AppendFile() { close(); }
+    
+    AppendFile(const AppendFile&) = delete;
+    AppendFile& operator=(const AppendFile&) = delete;
+    
+    // Create or truncate a file for writing
+    bool open(const std::string& filename);
+    void close();
+    bool isOpen() const;
+    
+    // Append all of data, retrying short writes
+    bool write(const void* data, size_t size);
+    
+    // Flush written data (not necessarily metadata) to the disk
+    bool sync();
+};
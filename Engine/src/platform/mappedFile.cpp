@@ -0,0 +1,189 @@
+#include "mappedFile.hpp"
+#include <SDL3/SDL.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& filename) {
+    close();
+    
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    fileHandle = file;
+    
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        close();
+        return false;
+    }
+    size = static_cast<size_t>(fileSize.QuadPart);
+    
+    // Windows can't map an empty file
+    if (size == 0) {
+        return true;
+    }
+    
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        close();
+        return false;
+    }
+    mappingHandle = mapping;
+    
+    data = static_cast<const Uint8*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+    if (!data) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedFile::close() {
+    if (data) UnmapViewOfFile(data);
+    if (mappingHandle) CloseHandle(static_cast<HANDLE>(mappingHandle));
+    if (fileHandle) CloseHandle(static_cast<HANDLE>(fileHandle));
+    data = nullptr;
+    size = 0;
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+}
+
+bool MappedFile::isOpen() const {
+    return fileHandle != nullptr;
+}
+
+void MappedFile::prefetch(size_t offset, size_t length) const {
+    if (!data || offset >= size) {
+        return;
+    }
+    length = SDL_min(length, size - offset);
+    
+    // Touching one byte per page faults the range in on this thread
+    const size_t page = getPageSize();
+    volatile Uint8 sink = 0;
+    for (size_t at = offset / page * page; at < offset + length; at += page) {
+        sink = data[at];
+    }
+    (void)sink;
+}
+
+void MappedFile::release(size_t offset, size_t length) const {
+    if (!data || offset >= size) {
+        return;
+    }
+    length = SDL_min(length, size - offset);
+    
+    // Only whole pages, so nothing either side of the range is dropped. VirtualUnlock on
+    // pages that were never locked takes them out of the working set (it then reports
+    // ERROR_NOT_LOCKED, which is expected); clean file pages are simply re-read if touched again
+    const size_t page = getPageSize();
+    const size_t start = (offset + page - 1) / page * page;
+    const size_t end = (offset + length) / page * page;
+    if (end > start) {
+        VirtualUnlock(const_cast<Uint8*>(data) + start, end - start);
+    }
+}
+
+size_t MappedFile::getPageSize() {
+    SYSTEM_INFO system;
+    GetSystemInfo(&system);
+    return system.dwPageSize;
+}
+
+#else
+
+bool MappedFile::open(const std::string& filename) {
+    close();
+    
+    fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        close();
+        return false;
+    }
+    size = static_cast<size_t>(info.st_size);
+    
+    // mmap rejects a zero length
+    if (size == 0) {
+        return true;
+    }
+    
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (mapped == MAP_FAILED) {
+        close();
+        return false;
+    }
+    data = static_cast<const Uint8*>(mapped);
+    
+    // Files are read front to back
+    madvise(mapped, size, MADV_SEQUENTIAL);
+    return true;
+}
+
+void MappedFile::close() {
+    if (data) munmap(const_cast<Uint8*>(data), size);
+    if (fd >= 0) ::close(fd);
+    data = nullptr;
+    size = 0;
+    fd = -1;
+}
+
+bool MappedFile::isOpen() const {
+    return fd >= 0;
+}
+
+void MappedFile::prefetch(size_t offset, size_t length) const {
+    if (!data || offset >= size) {
+        return;
+    }
+    length = SDL_min(length, size - offset);
+    
+    const size_t page = getPageSize();
+    const size_t start = offset / page * page;
+    Uint8* base = const_cast<Uint8*>(data);
+    
+    // Start read-ahead of the whole range, then touch each page to wait for it
+    madvise(base + start, offset + length - start, MADV_WILLNEED);
+    volatile Uint8 sink = 0;
+    for (size_t at = start; at < offset + length; at += page) {
+        sink = data[at];
+    }
+    (void)sink;
+}
+
+void MappedFile::release(size_t offset, size_t length) const {
+    if (!data || offset >= size) {
+        return;
+    }
+    length = SDL_min(length, size - offset);
+    
+    // Only whole pages, so nothing either side of the range is dropped
+    const size_t page = getPageSize();
+    const size_t start = (offset + page - 1) / page * page;
+    const size_t end = (offset + length) / page * page;
+    if (end > start) {
+        madvise(const_cast<Uint8*>(data) + start, end - start, MADV_DONTNEED);
+    }
+}
+
+size_t MappedFile::getPageSize() {
+    return static_cast<size_t>(sysconf(_SC_PAGESIZE));
+}
+
+#endif
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <SDL3/SDL_stdinc.h>
+#include <string>
+
+// Read-only memory mapping of a whole file. The OS pages it in on demand,
+// so opening is O(1) and reading costs no copies or allocations.
+class MappedFile {
+private:
+    const Uint8* data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;    // HANDLE of the file
+    void* mappingHandle = nullptr; // HANDLE of the mapping object
+#else
+    int fd = -1;
+#endif
+    
+public:
+    MappedFile() = default;
+    ~MappedFile() { close(); }
+    
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    
+    // Map a file, closing whatever was mapped before. Empty files open with size 0
+    bool open(const std::string& filename);
+    void close();
+    
+    bool isOpen() const;
+    const Uint8* getData() const { return data; }
+    size_t getSize() const { return size; }
+    
+    // Page a byte range in now, blocking until it's resident, so later reads of it don't fault
+    void prefetch(size_t offset, size_t length) const;
+    
+    // Let the OS drop the pages wholly inside a byte range; they fault back in if read again
+    void release(size_t offset, size_t length) const;
+    
+    // Granularity of prefetch and release
+    static size_t getPageSize();
+};
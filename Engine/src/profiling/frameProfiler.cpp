@@ -0,0 +1,95 @@
+#include "frameProfiler.hpp"
+#include <algorithm>
+#include <cstdio>
+
+static const char* const ZONE_NAMES[] = {"Events", "Sound update", "Visualizer", "Present", "Sleep"};
+
+FrameProfiler::FrameProfiler() {
+    frameTimer.start();
+}
+
+void FrameProfiler::begin(ProfileZone zone) {
+    zones[static_cast<int>(zone)].timer.start();
+}
+
+void FrameProfiler::end(ProfileZone zone) {
+    ZoneHistory& history = zones[static_cast<int>(zone)];
+    history.frameMs += history.timer.end().timeSeconds * 1000.0f;
+}
+
+void FrameProfiler::endFrame() {
+    for (ZoneHistory& history : zones) {
+        history.samples[cursor] = history.frameMs;
+        history.frameMs = 0.0f;
+    }
+    frameSamples[cursor] = frameTimer.end().timeSeconds * 1000.0f;
+    frameTimer.start();
+    
+    cursor = (cursor + 1) % FRAME_PROFILER_WINDOW;
+    if (filled < FRAME_PROFILER_WINDOW) filled++;
+}
+
+ProfileStats FrameProfiler::computeStats(const float* samples) const {
+    ProfileStats stats = {0.0f, 0.0f, 0.0f};
+    if (filled == 0) {
+        return stats;
+    }
+    
+    // The ring is full or filled from slot 0, so the first `filled` slots are the samples
+    float sorted[FRAME_PROFILER_WINDOW];
+    std::copy(samples, samples + filled, sorted);
+    
+    float sum = 0.0f;
+    stats.minMs = sorted[0];
+    for (int i = 0; i < filled; i++) {
+        sum += sorted[i];
+        stats.minMs = std::min(stats.minMs, sorted[i]);
+    }
+    stats.avgMs = sum / filled;
+    
+    const int p99 = (filled * 99) / 100;
+    std::nth_element(sorted, sorted + p99, sorted + filled);
+    stats.p99Ms = sorted[p99];
+    return stats;
+}
+
+ProfileStats FrameProfiler::getStats(ProfileZone zone) const {
+    return computeStats(zones[static_cast<int>(zone)].samples);
+}
+
+ProfileStats FrameProfiler::getFrameStats() const {
+    return computeStats(frameSamples);
+}
+
+void FrameProfiler::drawOverlay(SDL_Renderer* renderer) const {
+    if (!overlayVisible) {
+        return;
+    }
+    
+    const float lineHeight = SDL_DEBUG_TEXT_FONT_CHARACTER_SIZE + 4.0f;
+    const float width = 40.0f * SDL_DEBUG_TEXT_FONT_CHARACTER_SIZE;
+    const int lines = static_cast<int>(ProfileZone::Count) + 2;
+    const float x = WINDOW_WIDTH - width - 10.0f;
+    float y = 10.0f;
+    
+    SDL_FRect background = {x - 6.0f, y - 6.0f, width + 12.0f, lines * lineHeight + 8.0f};
+    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 200);
+    SDL_RenderFillRect(renderer, &background);
+    
+    char line[64];
+    SDL_SetRenderDrawColor(renderer, 200, 200, 200, 255);
+    SDL_RenderDebugText(renderer, x, y, "zone (ms)          min    avg    p99");
+    y += lineHeight;
+    
+    for (int zone = 0; zone < static_cast<int>(ProfileZone::Count); zone++) {
+        const ProfileStats stats = getStats(static_cast<ProfileZone>(zone));
+        snprintf(line, sizeof(line), "%-16s %6.2f %6.2f %6.2f", ZONE_NAMES[zone], stats.minMs, stats.avgMs, stats.p99Ms);
+        SDL_RenderDebugText(renderer, x, y, line);
+        y += lineHeight;
+    }
+    
+    const ProfileStats frame = getFrameStats();
+    snprintf(line, sizeof(line), "%-16s %6.2f %6.2f %6.2f", "Frame", frame.minMs, frame.avgMs, frame.p99Ms);
+    SDL_SetRenderDrawColor(renderer, 255, 220, 120, 255);
+    SDL_RenderDebugText(renderer, x, y, line);
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <SDL3/SDL.h>
+#include <profilerLib.h>
+#include "../audio/config.hpp"
+
+// Parts of a frame timed by the profiler
+enum class ProfileZone {
+    Events,      // Handling input events
+    SoundUpdate, // SoundManager::update
+    Visualizer,  // SoundVisualizer::RenderPlayingSounds
+    Present,     // SDL_RenderPresent (waits for vsync when it is on)
+    Sleep,       // Waiting for input or the next frame
+    Count
+};
+
+// Rolling statistics of one zone over the last FRAME_PROFILER_WINDOW frames, in ms
+struct ProfileStats {
+    float minMs;
+    float avgMs;
+    float p99Ms;
+};
+
+// Per-frame timing of the main loop. Zones can run several times a frame (the loop
+// wakes up for every input burst); their times add up into the frame's sample.
+// Development builds only: PROFILE_SCOPE compiles to nothing with PRODUCTION_BUILD.
+class FrameProfiler {
+private:
+    struct ZoneHistory {
+        PL::Profiler timer;
+        float frameMs = 0.0f;                       // Time so far in the current frame
+        float samples[FRAME_PROFILER_WINDOW] = {};  // Ring of finished frames
+    };
+    
+    ZoneHistory zones[static_cast<int>(ProfileZone::Count)];
+    PL::Profiler frameTimer;
+    float frameSamples[FRAME_PROFILER_WINDOW] = {};
+    int cursor = 0;   // Next ring slot
+    int filled = 0;   // Valid samples in the rings
+    bool overlayVisible = false;
+    
+    ProfileStats computeStats(const float* samples) const;
+
+public:
+    FrameProfiler();
+    
+    void begin(ProfileZone zone);
+    void end(ProfileZone zone);
+    
+    // Close the current frame and start the next one
+    void endFrame();
+    
+    ProfileStats getStats(ProfileZone zone) const;
+    ProfileStats getFrameStats() const; // Whole frame, start to start
+    
+    void toggleOverlay() { overlayVisible = !overlayVisible; }
+    bool isOverlayVisible() const { return overlayVisible; }
+    
+    // Draw the min/avg/p99 breakdown in the top-right corner if the overlay is on
+    void drawOverlay(SDL_Renderer* renderer) const;
+};
+
+// Times the rest of the enclosing scope as one run of a zone
+class ProfileScope {
+private:
+    FrameProfiler& profiler;
+    ProfileZone zone;
+
+public:
+    ProfileScope(FrameProfiler& frameProfiler, ProfileZone profileZone) : profiler(frameProfiler), zone(profileZone) {
+        profiler.begin(zone);
+    }
+    ~ProfileScope() { profiler.end(zone); }
+    
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_INNER(a, b)
+
+#if PRODUCTION_BUILD
+#define PROFILE_SCOPE(profiler, zone)
+#else
+#define PROFILE_SCOPE(profiler, zone) ProfileScope PROFILE_CONCAT(profileScope, __LINE__)(profiler, zone)
+#endif
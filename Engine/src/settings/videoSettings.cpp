@@ -0,0 +1,47 @@
+#include "videoSettings.hpp"
+#include <SDL3/SDL.h>
+#include <fstream>
+
+bool loadVideoSettings(const std::string& filename, VideoSettings& settings) {
+    std::ifstream file(filename);
+    if (!file.is_open()) {
+        SDL_Log("No video settings at %s, using defaults", filename.c_str());
+        return false;
+    }
+    
+    std::string line;
+    while (std::getline(file, line)) {
+        // Skip comments and lines without a value
+        if (line.empty() || line[0] == '#') continue;
+        size_t eq = line.find('=');
+        if (eq == std::string::npos) continue;
+        
+        std::string key = line.substr(0, eq);
+        std::string value = line.substr(eq + 1);
+        if (!value.empty() && value.back() == '\r') value.pop_back();
+        
+        if (key == "vsync") {
+            settings.vsync = (value == "true" || value == "1");
+        } else if (key == "maxFPS") {
+            try {
+                int fps = std::stoi(value);
+                settings.maxFPS = fps > 0 ? fps : 0;
+            }
+            catch(...) {
+                SDL_Log("Invalid maxFPS value: %s", value.c_str());
+            }
+        } else if (key == "idleFPS") {
+            try {
+                int fps = std::stoi(value);
+                settings.idleFPS = fps > 0 ? fps : 0;
+            }
+            catch(...) {
+                SDL_Log("Invalid idleFPS value: %s", value.c_str());
+            }
+        }
+    }
+    
+    SDL_Log("Video settings: vsync %s, max %d FPS, idle %d FPS", settings.vsync ? "on" : "off", settings.maxFPS,
+            settings.idleFPS);
+    return true;
+}
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <string>
+
+// Frame pacing settings loaded from resources/video_settings.txt
+struct VideoSettings {
+    bool vsync = true;  // Present in step with the display
+    int maxFPS = 60;    // Frame cap, 0 = uncapped (the display's refresh rate still applies)
+    int idleFPS = 4;    // Frame rate while nothing on screen changes, 0 = same as maxFPS
+};
+
+// Read key=value lines from a settings file. Missing files and unknown keys keep the defaults
+bool loadVideoSettings(const std::string& filename, VideoSettings& settings);
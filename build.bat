@@ -1,8 +1,8 @@
 @echo off
 echo Building Engine project...
 
-REM Parse command line arguments for AVX options
-set USE_AVX512=OFF
+REM Parse command line arguments (DSP kernel override and clean build)
+set DSP_ISA=
 set CLEAN_BUILD=OFF
 
 REM Set the path to CMake executable
@@ -10,18 +10,19 @@ set CMAKE_PATH="C:\Program Files\Microsoft Visual Studio\2022\Community\Common7\
 
 :parse_args
 if "%1"=="" goto done_args
-if /i "%1"=="--avx512" set USE_AVX512=ON
-if /i "%1"=="--avx2" set USE_AVX512=OFF
+if /i "%1"=="--avx512" set DSP_ISA=avx512
+if /i "%1"=="--avx2" set DSP_ISA=avx2
+if /i "%1"=="--scalar" set DSP_ISA=scalar
 if /i "%1"=="--clean" set CLEAN_BUILD=ON
 shift
 goto parse_args
 :done_args
 
-echo [BUILD INFO] Using instruction set: %USE_AVX512%
-if "%USE_AVX512%"=="ON" (
-    echo [BUILD INFO] AVX-512 instructions will be enabled
+REM All DSP kernel variants are always built; the instruction set is picked at runtime
+if not "%DSP_ISA%"=="" (
+    echo [BUILD INFO] Forcing %DSP_ISA% DSP kernels for this run
 ) else (
-    echo [BUILD INFO] AVX-2 instructions will be used (default)
+    echo [BUILD INFO] DSP kernels will be selected from the CPU at runtime
 )
 
 REM Create build directory if it doesn't exist
@@ -39,7 +40,7 @@ cd build
 
 REM Configure with CMake
 echo Configuring with CMake...
-%CMAKE_PATH% -DCMAKE_EXPORT_COMPILE_COMMANDS:BOOL=TRUE -DUSE_AVX512=%USE_AVX512% -G "Visual Studio 17 2022" -T host=x86 -A x64 ..\Engine
+%CMAKE_PATH% -DCMAKE_EXPORT_COMPILE_COMMANDS:BOOL=TRUE -G "Visual Studio 17 2022" -T host=x86 -A x64 ..\Engine
 
 REM Build the project
 echo Building project...
@@ -55,12 +56,14 @@ echo Build successful!
 cd ..
 REM Run the executable
 echo Running the application...
+if not "%DSP_ISA%"=="" set GAMEENGINE_DSP_ISA=%DSP_ISA%
 build\Release\gameengine.exe
 
 echo Done!
 
 
-REM build.bat --avx2       # Build with AVX2 (default)
-REM build.bat --avx512     # Build with AVX512
-REM build.bat --clean      # Clean build with default AVX2
-REM build.bat --clean --avx512  # Clean build with AVX512
\ No newline at end of file
+REM build.bat              # Build and run with the best DSP kernels for this CPU (default)
+REM build.bat --avx512     # Build and run forcing the AVX-512 kernels
+REM build.bat --avx2       # Build and run forcing the AVX2 kernels
+REM build.bat --scalar     # Build and run forcing the scalar kernels
+REM build.bat --clean      # Clean build
\ No newline at end of file
@@ -3,7 +3,7 @@
 echo "Building Engine project..."
 
 # Default settings
-USE_AVX512=OFF
+DSP_ISA=""
 CLEAN_BUILD=OFF
 
 # Check if CMake is installed
@@ -20,11 +20,15 @@ fi
 while [[ $# -gt 0 ]]; do
     case "$1" in
         --avx512)
-            USE_AVX512=ON
+            DSP_ISA=avx512
             shift
             ;;
         --avx2)
-            USE_AVX512=OFF
+            DSP_ISA=avx2
+            shift
+            ;;
+        --scalar)
+            DSP_ISA=scalar
             shift
             ;;
         --clean)
@@ -33,18 +37,18 @@ while [[ $# -gt 0 ]]; do
             ;;
         *)
             echo "Unknown option: $1"
-            echo "Usage: ./build.sh [--avx512] [--avx2] [--clean]"
+            echo "Usage: ./build.sh [--avx512] [--avx2] [--scalar] [--clean]"
             exit 1
             ;;
     esac
 done
 
 # Display build info
-echo "[BUILD INFO] Using instruction set: $USE_AVX512"
-if [ "$USE_AVX512" = "ON" ]; then
-    echo "[BUILD INFO] AVX-512 instructions will be enabled"
+# All DSP kernel variants are always built; the instruction set is picked at runtime
+if [ -n "$DSP_ISA" ]; then
+    echo "[BUILD INFO] Forcing $DSP_ISA DSP kernels for this run"
 else
-    echo "[BUILD INFO] AVX-2 instructions will be used (default)"
+    echo "[BUILD INFO] DSP kernels will be selected from the CPU at runtime"
 fi
 
 # Create build directory if it doesn't exist
@@ -62,7 +66,7 @@ cd build
 
 # Configure with CMake (using Ninja for faster builds in MSYS2)
 echo "Configuring with CMake..."
-cmake -DCMAKE_EXPORT_COMPILE_COMMANDS=TRUE -DUSE_AVX512=$USE_AVX512 -G "Ninja" ../Engine
+cmake -DCMAKE_EXPORT_COMPILE_COMMANDS=TRUE -G "Ninja" ../Engine
 
 # Build the project
 echo "Building project..."
@@ -80,12 +84,17 @@ cd ..
 
 # Run the executable (adjust the path as needed for MSYS2/UCRT64)
 echo "Running the application..."
-./build/gameengine
+if [ -n "$DSP_ISA" ]; then
+    GAMEENGINE_DSP_ISA=$DSP_ISA ./build/gameengine
+else
+    ./build/gameengine
+fi
 
 echo "Done!"
 
 # Usage instructions:
-# ./build.sh           # Build with AVX2 (default)
-# ./build.sh --avx512  # Build with AVX512
-# ./build.sh --clean   # Clean build with default AVX2
-# ./build.sh --clean --avx512  # Clean build with AVX512
\ No newline at end of file
+# ./build.sh           # Build and run with the best DSP kernels for this CPU (default)
+# ./build.sh --avx512  # Build and run forcing the AVX-512 kernels
+# ./build.sh --avx2    # Build and run forcing the AVX2 kernels
+# ./build.sh --scalar  # Build and run forcing the scalar kernels
+# ./build.sh --clean   # Clean build
\ No newline at end of file